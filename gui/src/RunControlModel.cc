@@ -1,10 +1,11 @@
 #include "RunControlModel.hh"
+#include "eudaq/Metrics.hh"
 
 #include <vector>
 #include <string>
 #include "qmetatype.h"
 
-std::vector<QString> RunControlModel::m_str_header={"type", "name", "state", "connection", "message", "information"};
+std::vector<QString> RunControlModel::m_str_header={"type", "name", "state", "connection", "message", "information", "performance"};
 
 RunControlModel::RunControlModel(QObject *parent)
   : QAbstractListModel(parent){
@@ -73,12 +74,29 @@ QVariant RunControlModel::data(const QModelIndex &index, int role) const {
       if(sta){
 	auto tags = sta->GetTags();
 	for(auto &tag: tags){
+	  if(!tag.first.compare(0, eudaq::MetricsPublisher::TAG_PREFIX.size(),
+				eudaq::MetricsPublisher::TAG_PREFIX))
+	    continue;
 	  info += ("<"+tag.first+"> ");
 	  info += (tag.second+"  ");
 	}
       }
       return QString::fromStdString(info);
     }
+    case 6:{
+      std::string perf;
+      if(sta){
+	auto &prefix = eudaq::MetricsPublisher::TAG_PREFIX;
+	auto tags = sta->GetTags();
+	for(auto &tag: tags){
+	  if(tag.first.compare(0, prefix.size(), prefix))
+	    continue;
+	  perf += ("<"+tag.first.substr(prefix.size())+"> ");
+	  perf += (tag.second+"  ");
+	}
+      }
+      return QString::fromStdString(perf);
+    }
     default:
       return QString("");
     }
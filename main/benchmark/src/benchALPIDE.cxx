@@ -0,0 +1,100 @@
+#include "benchCommon.hh"
+
+#include "ALPIDEDecoder.hh"
+#include "eudaq/FileReader.hh"
+
+#include <benchmark/benchmark.h>
+
+// Throughput of the ALPIDE decoder of user/ITS3. Recorded data are used when
+// EUDAQ_BENCH_ALPIDE_FILE names a native raw file, all ALPIDE_plane_N sub
+// events of it are decoded. Otherwise synthetic events are generated with the
+// given number of hits per event, half of them in DATA LONG clusters.
+
+using namespace eudaq;
+
+namespace{
+  std::vector<uint8_t> MakeALPIDEEvent(uint32_t n_hit, uint32_t n){
+    std::vector<uint8_t> ev(4, 0xAA);
+    for(int j = 0; j < 4; ++j) ev.push_back(n >> (j * 8) & 0xFF);
+    for(int j = 0; j < 8; ++j) ev.push_back(uint64_t(n) * 100 >> (j * 8) & 0xFF);
+    if(n_hit == 0){
+      ev.insert(ev.end(), {0xE0, 0x00, 0x00, 0x00}); // chip empty frame
+    }else{
+      ev.insert(ev.end(), {0xA0, 0x00}); // chip header
+      uint32_t i = 0;
+      for(uint32_t reg = 0; reg < 32 && i < n_hit; ++reg){
+	ev.push_back(0xC0 | reg); // region header
+	for(uint32_t a = (n * 7) % 64; a < 0x3F00 && i < n_hit; a += 0x211){
+	  if(i % 2){
+	    ev.insert(ev.end(), {uint8_t(0x40 | a >> 8), uint8_t(a & 0xFF)}); // data short
+	    i += 1;
+	  }else{
+	    ev.insert(ev.end(), {uint8_t(a >> 8), uint8_t(a & 0xFF), 0x2D}); // data long, 4 more hits
+	    i += 5;
+	  }
+	}
+      }
+      ev.push_back(0xB0); // chip trailer
+      while(ev.size() % 4) ev.push_back(0xFF);
+    }
+    ev.insert(ev.end(), 4, 0xBB);
+    return ev;
+  }
+
+  std::vector<std::vector<uint8_t>> LoadALPIDEEvents(){
+    std::vector<std::vector<uint8_t>> evs;
+    const char *path = std::getenv("EUDAQ_BENCH_ALPIDE_FILE");
+    if(!path)
+      return evs;
+    auto reader = FileReader::Make("native", path);
+    while(auto ev = reader->GetNextEvent()){
+      for(auto &subev: ev->GetSubEvents())
+	if(subev->GetDescription().find("ALPIDE_plane_") == 0 && subev->GetNumBlock())
+	  evs.push_back(subev->GetBlock(0));
+    }
+    return evs;
+  }
+}
+
+static void BM_ALPIDEDecoder(benchmark::State& state){
+  std::vector<std::vector<uint8_t>> evs = LoadALPIDEEvents();
+  if(evs.empty())
+    for(uint32_t n = 0; n < 100; n++)
+      evs.push_back(MakeALPIDEEvent(state.range(0), n));
+  ALPIDEDecoder decoder;
+  size_t bytes = 0;
+  size_t hits = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &ev = evs[i++ % evs.size()];
+    if(!decoder.Decode(ev.data(), ev.size()))
+      state.SkipWithError(decoder.Error().c_str());
+    bytes += ev.size();
+    hits += decoder.NumHits();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+  state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ALPIDEDecoder)->Arg(0)->Arg(10)->Arg(100)->Arg(1000);
+
+// decoding and filling the StandardPlane as the converter does
+static void BM_ALPIDEDecoderPlane(benchmark::State& state){
+  std::vector<std::vector<uint8_t>> evs;
+  for(uint32_t n = 0; n < 100; n++)
+    evs.push_back(MakeALPIDEEvent(state.range(0), n));
+  ALPIDEDecoder decoder;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &ev = evs[i++ % evs.size()];
+    decoder.Decode(ev.data(), ev.size());
+    size_t nhit = decoder.NumHits();
+    StandardPlane plane(0, "ITS3DAQ", "ALPIDE");
+    plane.SetSizeZS(ALPIDEDecoder::X_SIZE, ALPIDEDecoder::Y_SIZE, nhit, 1);
+    for(size_t ihit = 0; ihit < nhit; ++ihit)
+      plane.SetPixel(ihit, decoder.X()[ihit], decoder.Y()[ihit], 1, decoder.Time());
+    benchmark::DoNotOptimize(plane);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ALPIDEDecoderPlane)->Arg(10)->Arg(100)->Arg(1000);
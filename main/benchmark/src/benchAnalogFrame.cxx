@@ -0,0 +1,63 @@
+#include "benchCommon.hh"
+
+#include "AnalogFrameCube.hh"
+
+#include <benchmark/benchmark.h>
+
+// Signal extraction of the ITS3 analogue converters (user/ITS3), without the
+// ROOT dependency of the converters themselves: a CE65 event of 64x32 pixels
+// with one block per frame.
+
+using namespace eudaq;
+
+namespace{
+  const int CE65_N_PIXEL = 64 * 32;
+
+  EventSP MakeCE65Event(int n_frame){
+    auto ev = Event::MakeShared("CE65Raw");
+    for(int i = 0; i < n_frame; i++){
+      std::vector<uint8_t> block(CE65_N_PIXEL * 2);
+      for(size_t b = 0; b < block.size(); b++)
+	block[b] = static_cast<uint8_t>(b * 7 + i * 13);
+      ev->AddBlock(i, block);
+    }
+    return ev;
+  }
+}
+
+// former decoding: all frames copied and read for every single pixel
+static void BM_CE65PerPixel(benchmark::State& state){
+  auto ev = MakeCE65Event(state.range(0));
+  std::vector<float> charge(CE65_N_PIXEL);
+  std::vector<short> frdata(state.range(0));
+  for(auto _ : state){
+    for(int iPixel = 0; iPixel < CE65_N_PIXEL; iPixel++){
+      for(size_t i = 0; i < ev->GetNumBlock(); i++){
+	std::vector<uint8_t> data = ev->GetBlock(i);
+	frdata[i] = short((data[iPixel * 2 + 1] << 8) + data[iPixel * 2]);
+      }
+      charge[iPixel] = short(frdata.back() - frdata[0]);
+    }
+    benchmark::DoNotOptimize(charge.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CE65PerPixel)->Arg(8)->Arg(32);
+
+static void BM_CE65FrameCube(benchmark::State& state){
+  auto ev = MakeCE65Event(state.range(0));
+  std::vector<int16_t> raw(CE65_N_PIXEL);
+  std::vector<float> charge(CE65_N_PIXEL);
+  std::vector<float> pedestal(CE65_N_PIXEL, 3);
+  std::vector<float> polarity(CE65_N_PIXEL, -1);
+  AnalogFrameCube<int16_t> cube;
+  for(auto _ : state){
+    cube.DecodeBlocks(*ev, CE65_N_PIXEL);
+    cube.Difference(cube.NumFrames() - 1, 0, raw.data());
+    for(int i = 0; i < CE65_N_PIXEL; i++)
+      charge[i] = (raw[i] - pedestal[i]) * polarity[i];
+    benchmark::DoNotOptimize(charge.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CE65FrameCube)->Arg(8)->Arg(32);
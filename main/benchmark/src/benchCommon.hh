@@ -0,0 +1,55 @@
+#ifndef EUDAQ_INCLUDED_benchCommon
+#define EUDAQ_INCLUDED_benchCommon
+
+#include "eudaq/Event.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/StandardPlane.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Synthetic data shared by the benchmarks. Files are written to the
+// directory given by EUDAQ_BENCH_DIR, the current directory by default.
+namespace eudaq {
+  namespace bench {
+
+    inline std::string WorkDir(){
+      const char *dir = std::getenv("EUDAQ_BENCH_DIR");
+      std::string d = dir ? dir : ".";
+      if(!d.empty() && d.back() != '/')
+	d += '/';
+      return d;
+    }
+
+    // RawEvent with one data block of the given size
+    inline EventSP MakeRawEvent(const std::string &dspt, size_t bytes, uint32_t n = 0){
+      EventSP ev = Event::MakeShared(dspt);
+      std::vector<uint8_t> block(bytes);
+      for(size_t i = 0; i < bytes; i++)
+	block[i] = static_cast<uint8_t>(i * 31 + n);
+      ev->AddBlock(0, block);
+      ev->SetEventN(n);
+      ev->SetTriggerN(n);
+      return ev;
+    }
+
+    // StandardEvent of a telescope-like setup, zero suppressed planes
+    inline StdEventSP MakeStdEvent(uint32_t planes, uint32_t hits, uint32_t n = 0){
+      auto ev = StandardEvent::MakeShared();
+      for(uint32_t p = 0; p < planes; p++){
+	StandardPlane plane(p, "Bench", "Bench");
+	plane.SetSizeZS(1152, 576, 0);
+	for(uint32_t h = 0; h < hits; h++)
+	  plane.PushPixel((h * 37 + n) % 1152, (h * 11 + p) % 576, 1);
+	ev->AddPlane(plane);
+      }
+      ev->SetEventN(n);
+      return ev;
+    }
+
+  }
+}
+
+#endif // EUDAQ_INCLUDED_benchCommon
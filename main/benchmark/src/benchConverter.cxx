@@ -0,0 +1,61 @@
+#include "benchCommon.hh"
+
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/RawEvent.hh"
+
+#include <benchmark/benchmark.h>
+
+using namespace eudaq;
+
+// Decodes a block into one plane of hits, each hit being an x/y byte pair.
+class BenchRawEvent2StdEventConverter: public StdEventConverter{
+public:
+  bool Converting(EventSPC d1, StdEventSP d2, ConfigSPC conf) const override;
+  static const uint32_t m_id_factory = cstr2hash("BenchRaw");
+};
+
+namespace{
+  auto dummy0 = Factory<StdEventConverter>::
+    Register<BenchRawEvent2StdEventConverter>(BenchRawEvent2StdEventConverter::m_id_factory);
+}
+
+bool BenchRawEvent2StdEventConverter::Converting(EventSPC d1, StdEventSP d2, ConfigSPC /*conf*/) const{
+  auto &block = d1->GetBlock(0);
+  StandardPlane plane(0, "Bench", "Bench");
+  plane.SetSizeZS(256, 256, 0);
+  for(size_t i = 0; i + 1 < block.size(); i += 2)
+    plane.PushPixel(block[i], block[i + 1], 1);
+  d2->AddPlane(plane);
+  return true;
+}
+
+// RawEvent -> extend word lookup -> converter, for a single event
+static void BM_StdEventConvert(benchmark::State& state){
+  EventSPC ev = bench::MakeRawEvent("BenchRaw", state.range(0) * 2);
+  for(auto _ : state){
+    auto stdev = StandardEvent::MakeShared();
+    if(!StdEventConverter::Convert(ev, stdev, nullptr))
+      state.SkipWithError("conversion failed");
+    benchmark::DoNotOptimize(stdev);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+}
+BENCHMARK(BM_StdEventConvert)->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// built event as written by the DataCollector, holding one sub event per device
+static void BM_StdEventConvertPacket(benchmark::State& state){
+  auto ev = Event::MakeShared("BenchPacket");
+  ev->SetFlagPacket();
+  for(int64_t i = 0; i < state.range(0); i++)
+    ev->AddSubEvent(bench::MakeRawEvent("BenchRaw", 200));
+  for(auto _ : state){
+    auto stdev = StandardEvent::MakeShared();
+    if(!StdEventConverter::Convert(ev, stdev, nullptr))
+      state.SkipWithError("conversion failed");
+    benchmark::DoNotOptimize(stdev);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0) * 200);
+}
+BENCHMARK(BM_StdEventConvertPacket)->Arg(1)->Arg(6)->Arg(12);
@@ -0,0 +1,215 @@
+#include "benchCommon.hh"
+
+#include "FEI4RecordDecoder.hh"
+#include "eudaq/FileReader.hh"
+
+#include <benchmark/benchmark.h>
+
+// Throughput of the FE-I4 record decoding kernel of user/stcontrol. Recorded
+// data are used when EUDAQ_BENCH_USBPIX_FILE names a native raw file, all
+// blocks of its USBPIXI4 and USBPIXI4B (sub) events are decoded. Otherwise
+// synthetic blocks of 16 data headers are generated with the given number of
+// data records per header. Before timing, the planes filled from the kernel
+// are compared with those of the previous per-hit decoding of
+// UsbpixI4RawEvent2StdEventConverter, which is kept here as the reference.
+
+using namespace eudaq;
+
+namespace{
+  const uint32_t CONSECUTIVE_LVL1 = 16;
+  typedef FEI4RecordDecoder<0x00007F00, 0x000000FF, false> Decoder;
+  typedef FEI4RecordDecoder<0x00007F00, 0x000000FF, true> DecoderSwapped;
+
+  void PutLittle32(std::vector<uint8_t> &v, uint32_t x){
+    for(int j = 0; j < 4; ++j) v.push_back(x >> (j * 8) & 0xFF);
+  }
+
+  std::vector<uint8_t> MakeBlock(uint32_t n_rec, uint32_t trigger){
+    std::vector<uint8_t> v;
+    for(uint32_t l = 0; l < CONSECUTIVE_LVL1; ++l){
+      PutLittle32(v, 0x00E90000 | ((trigger + l) & 0x7FFF));
+      for(uint32_t r = 0; r < n_rec; ++r){
+	uint32_t k = r * 131 + l * 17 + trigger;
+	uint32_t col = k % 80 + 1;
+	uint32_t row = (k * 7) % 335 + 1;
+	// ToT codes 14 and 15 (no hit) included
+	uint32_t tot1 = k % 15;
+	uint32_t tot2 = (k / 3) % 16;
+	PutLittle32(v, col << 17 | row << 8 | tot1 << 4 | tot2);
+      }
+      // a service record
+      PutLittle32(v, 0x00EF0000 | l);
+    }
+    PutLittle32(v, 0x00F80000 | trigger >> 24);
+    PutLittle32(v, trigger & 0xFFFFFF);
+    return v;
+  }
+
+  std::vector<std::vector<uint8_t>> LoadBlocks(){
+    std::vector<std::vector<uint8_t>> blocks;
+    const char *path = std::getenv("EUDAQ_BENCH_USBPIX_FILE");
+    if(!path)
+      return blocks;
+    auto reader = FileReader::Make("native", path);
+    while(auto ev = reader->GetNextEvent()){
+      std::vector<EventSPC> subs = ev->GetSubEvents();
+      subs.push_back(ev);
+      for(auto &e: subs){
+	std::string dspt = e->GetDescription();
+	if(dspt == "USBPIXI4" || dspt == "USBPIXI4B")
+	  for(auto bn: e->GetBlockNumList())
+	    blocks.push_back(e->GetBlock(bn));
+      }
+    }
+    return blocks;
+  }
+
+  std::vector<std::vector<uint8_t>> GetBlocks(uint32_t n_rec){
+    std::vector<std::vector<uint8_t>> blocks = LoadBlocks();
+    if(blocks.empty())
+      for(uint32_t n = 0; n < 100; n++)
+	blocks.push_back(MakeBlock(n_rec, n));
+    return blocks;
+  }
+
+  // the previous decoding of UsbpixI4RawEvent2StdEventConverter, two
+  // getHitData calls and one PushPixel per hit
+  uint32_t GetWord(const std::vector<uint8_t> &data, size_t index){
+    return (((uint32_t)data[index + 3]) << 24) | (((uint32_t)data[index + 2]) << 16)
+      | (((uint32_t)data[index + 1]) << 8) | (uint32_t)data[index];
+  }
+
+  bool GetHitData(const Decoder::Interpreter &intp, uint32_t Word, bool second_hit,
+		  uint32_t &Col, uint32_t &Row, uint32_t &ToT){
+    if(!intp.is_dr(Word))
+      return false;
+    uint32_t t_ToT = second_hit ? intp.get_dr_tot2(Word) : intp.get_dr_tot1(Word);
+    uint32_t t_Col = second_hit ? intp.get_dr_col2(Word) : intp.get_dr_col1(Word);
+    uint32_t t_Row = second_hit ? intp.get_dr_row2(Word) : intp.get_dr_row1(Word);
+    if(t_ToT == 14 || t_ToT == 15)
+      return false;
+    ToT = t_ToT + 1;
+    if(t_Row > 336 || t_Row < 1 || t_Col > 80 || t_Col < 1)
+      return false;
+    Col = t_Col - 1;
+    Row = t_Row - 1;
+    return true;
+  }
+
+  StandardPlane ReferencePlane(const std::vector<uint8_t> &data, bool swap_xy){
+    Decoder::Interpreter intp;
+    StandardPlane plane(10, "USBPIXI4", "USBPIXI4");
+    plane.SetSizeZS(swap_xy ? 336 : 80, swap_xy ? 80 : 336, 0, CONSECUTIVE_LVL1,
+		    StandardPlane::FLAG_DIFFCOORDS | StandardPlane::FLAG_ACCUMULATE);
+    uint32_t dh_found = 0;
+    for(size_t i = 0; i < data.size() - 8; i += 4)
+      if(intp.is_dh(GetWord(data, i)))
+	dh_found++;
+    if(dh_found != CONSECUTIVE_LVL1)
+      return plane;
+    uint32_t Col, Row, ToT;
+    for(size_t i = 0; i < data.size() - 8; i += 4){
+      uint32_t Word = GetWord(data, i);
+      if(intp.is_dh(Word))
+	continue;
+      for(bool second: {false, true})
+	if(GetHitData(intp, Word, second, Col, Row, ToT)){
+	  if(swap_xy)
+	    plane.PushPixel(Row, Col, ToT);
+	  else
+	    plane.PushPixel(Col, Row, ToT);
+	}
+    }
+    return plane;
+  }
+
+  // the plane as the converter fills it from the kernel
+  template <class D>
+  StandardPlane DecoderPlane(D &decoder, const std::vector<uint8_t> &data){
+    StandardPlane plane(10, "USBPIXI4", "USBPIXI4");
+    plane.SetSizeZS(decoder.WIDTH, decoder.HEIGHT, 0, CONSECUTIVE_LVL1,
+		    StandardPlane::FLAG_DIFFCOORDS | StandardPlane::FLAG_ACCUMULATE);
+    if(decoder.Decode(data.data(), data.size()) == CONSECUTIVE_LVL1){
+      const FEI4Hits &hits = decoder.Hits();
+      plane.PushPixels(hits.n, hits.x.data(), hits.y.data(), hits.tot.data());
+    }
+    return plane;
+  }
+
+  bool SamePlane(const StandardPlane &a, const StandardPlane &b){
+    return a.XSize() == b.XSize() && a.YSize() == b.YSize() &&
+      a.XVector(0) == b.XVector(0) && a.YVector(0) == b.YVector(0) &&
+      a.PixVector(0) == b.PixVector(0);
+  }
+
+  // empty if the kernel agrees with the reference on all blocks
+  std::string Validate(const std::vector<std::vector<uint8_t>> &blocks){
+    Decoder decoder;
+    DecoderSwapped swapped;
+    for(size_t i = 0; i < blocks.size(); ++i){
+      if(blocks[i].size() < 8)
+	continue;
+      if(!SamePlane(DecoderPlane(decoder, blocks[i]), ReferencePlane(blocks[i], false)) ||
+	 !SamePlane(DecoderPlane(swapped, blocks[i]), ReferencePlane(blocks[i], true)))
+	return "FEI4RecordDecoder differs from the reference in block " + std::to_string(i);
+    }
+    return "";
+  }
+}
+
+static void BM_FEI4Reference(benchmark::State& state){
+  std::vector<std::vector<uint8_t>> blocks = GetBlocks(state.range(0));
+  size_t bytes = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &block = blocks[i++ % blocks.size()];
+    if(block.size() >= 8){
+      auto plane = ReferencePlane(block, false);
+      benchmark::DoNotOptimize(plane);
+    }
+    bytes += block.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_FEI4Reference)->Arg(1)->Arg(10)->Arg(100);
+
+static void BM_FEI4Decoder(benchmark::State& state){
+  std::vector<std::vector<uint8_t>> blocks = GetBlocks(state.range(0));
+  std::string err = Validate(blocks);
+  if(!err.empty()){
+    state.SkipWithError(err.c_str());
+    return;
+  }
+  Decoder decoder;
+  size_t bytes = 0;
+  size_t hits = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &block = blocks[i++ % blocks.size()];
+    decoder.Decode(block.data(), block.size());
+    hits += decoder.Hits().n;
+    bytes += block.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+  state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_FEI4Decoder)->Arg(1)->Arg(10)->Arg(100);
+
+// decoding and filling the StandardPlane as the converter does
+static void BM_FEI4DecoderPlane(benchmark::State& state){
+  std::vector<std::vector<uint8_t>> blocks = GetBlocks(state.range(0));
+  Decoder decoder;
+  size_t bytes = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &block = blocks[i++ % blocks.size()];
+    auto plane = DecoderPlane(decoder, block);
+    benchmark::DoNotOptimize(plane);
+    bytes += block.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_FEI4DecoderPlane)->Arg(1)->Arg(10)->Arg(100);
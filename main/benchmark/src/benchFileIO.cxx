@@ -0,0 +1,71 @@
+#include "benchCommon.hh"
+
+#include "eudaq/FileWriter.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FileNamer.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+using namespace eudaq;
+
+namespace{
+  const uint32_t BENCH_RUN_N = 1;
+
+  std::string NativePattern(){
+    return bench::WorkDir() + "eudaq_bench_native_run$6R$X";
+  }
+
+  std::string NativeFile(){
+    return FileNamer(NativePattern()).Set('X', ".raw").Set('R', BENCH_RUN_N);
+  }
+}
+
+static void BM_NativeFileWriter(benchmark::State& state){
+  auto ev = bench::MakeRawEvent("BenchRaw", state.range(0));
+  ev->SetRunN(BENCH_RUN_N);
+  uint64_t bytes = 0;
+  {
+    auto writer = FileWriter::Make("native", NativePattern());
+    for(auto _ : state)
+      writer->WriteEvent(ev);
+    bytes = writer->FileBytes();
+  }
+  std::remove(NativeFile().c_str());
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_NativeFileWriter)->RangeMultiplier(16)->Range(64, 1<<20);
+
+static void BM_NativeFileReader(benchmark::State& state){
+  const size_t n_ev = 1000;
+  uint64_t file_bytes = 0;
+  {
+    auto writer = FileWriter::Make("native", NativePattern());
+    for(size_t i = 0; i < n_ev; i++){
+      auto ev = bench::MakeRawEvent("BenchRaw", state.range(0), i);
+      ev->SetRunN(BENCH_RUN_N);
+      writer->WriteEvent(ev);
+    }
+    file_bytes = writer->FileBytes();
+  }
+  size_t n = 0;
+  FileReaderSP reader;
+  for(auto _ : state){
+    EventSPC ev = reader ? reader->GetNextEvent() : nullptr;
+    if(!ev){
+      state.PauseTiming();
+      reader = FileReader::Make("native", NativeFile());
+      state.ResumeTiming();
+      ev = reader->GetNextEvent();
+    }
+    benchmark::DoNotOptimize(ev);
+    n++;
+  }
+  reader.reset();
+  std::remove(NativeFile().c_str());
+  state.SetItemsProcessed(n);
+  state.SetBytesProcessed(n * (file_bytes / n_ev));
+}
+BENCHMARK(BM_NativeFileReader)->RangeMultiplier(16)->Range(64, 1<<20);
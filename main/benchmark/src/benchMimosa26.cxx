@@ -0,0 +1,238 @@
+#include "benchCommon.hh"
+
+#include "Mimosa26Decoder.hh"
+#include "eudaq/FileReader.hh"
+
+#include <benchmark/benchmark.h>
+
+// Throughput of the Mimosa26 decoder of user/eudet. Recorded data are used
+// when EUDAQ_BENCH_NI_FILE names a native raw file, all NiRawDataEvent (sub)
+// events of it are decoded. Otherwise synthetic six-plane events are
+// generated with at least the given number of hits per plane and frame. Before
+// timing, the planes built from the decoder are compared with those of the
+// previous per-pixel decoding, which is kept here as the reference.
+
+using namespace eudaq;
+
+namespace{
+  struct NiEvent{
+    std::vector<uint8_t> data0;
+    std::vector<uint8_t> data1;
+  };
+
+  void PutLittle(std::vector<uint8_t> &v, uint32_t x, int bytes){
+    for(int j = 0; j < bytes; ++j) v.push_back(x >> (j * 8) & 0xFF);
+  }
+
+  std::vector<uint8_t> MakeFrame(uint32_t n_hit, uint16_t pivot, uint32_t n){
+    std::vector<uint8_t> v;
+    PutLittle(v, 0x55555555, 4);
+    PutLittle(v, pivot, 2);
+    PutLittle(v, n & 0x7FFF, 2);
+    for(uint32_t p = 0; p < 6; ++p){
+      // row words with three state words of one to four pixels each
+      std::vector<uint8_t> words;
+      for(uint32_t r = 0, hits = 0; hits < n_hit; ++r){
+	uint32_t row = (r * 37 + n * 11 + p) % 576;
+	PutLittle(words, row << 4 | 3, 2);
+	for(uint32_t s = 0; s < 3; ++s){
+	  PutLittle(words, ((r * 101 + s * 307 + n) % 1148) << 2 | (s + r) % 4, 2);
+	  hits += (s + r) % 4 + 1;
+	}
+      }
+      PutLittle(v, n, 4);
+      PutLittle(v, words.size() / 4, 2);
+      PutLittle(v, words.size() / 4, 2);
+      v.insert(v.end(), words.begin(), words.end());
+      PutLittle(v, 0xAAAAAAAA, 4);
+      PutLittle(v, 0x55555555, 4);
+    }
+    return v;
+  }
+
+  std::vector<NiEvent> LoadNiEvents(){
+    std::vector<NiEvent> evs;
+    const char *path = std::getenv("EUDAQ_BENCH_NI_FILE");
+    if(!path)
+      return evs;
+    auto reader = FileReader::Make("native", path);
+    while(auto ev = reader->GetNextEvent()){
+      std::vector<EventSPC> subs = ev->GetSubEvents();
+      subs.push_back(ev);
+      for(auto &e: subs)
+	if(e->GetDescription() == "NiRawDataEvent" && e->GetNumBlock() >= 2)
+	  evs.push_back(NiEvent{e->GetBlock(0), e->GetBlock(1)});
+    }
+    return evs;
+  }
+
+  std::vector<NiEvent> GetNiEvents(uint32_t n_hit){
+    std::vector<NiEvent> evs = LoadNiEvents();
+    if(evs.empty())
+      for(uint32_t n = 0; n < 100; n++){
+	uint16_t pivot = (n * 997) % 9216;
+	evs.push_back(NiEvent{MakeFrame(n_hit, pivot, n), MakeFrame(n_hit, pivot, n + 7)});
+      }
+    return evs;
+  }
+
+  // the previous decoding of NiRawEvent2StdEventConverter, one PushPixel per hit
+  void ReferenceFrame(StandardPlane &plane, uint32_t fm_n, const uint8_t *d, size_t l32,
+		      bool fix_pivot){
+    std::vector<uint16_t> vec;
+    for(size_t i = 0; i < l32; ++i){
+      vec.push_back(getlittleendian<uint16_t>(d + i * 4));
+      vec.push_back(getlittleendian<uint16_t>(d + i * 4 + 2));
+    }
+    size_t lvec = vec.size();
+    for(size_t i = 0; i + 1 < lvec; ++i){
+      uint16_t numstates = vec[i] & 0x000f;
+      uint16_t row = vec[i] >> 4 & 0x7ff;
+      if(i + 1 + numstates > lvec)
+	break;
+      bool pivot = (fix_pivot ? 1 - fm_n : (row >= (plane.PivotPixel() / 16)));
+      for(uint16_t s = 0; s < numstates; ++s){
+	uint16_t v = vec.at(++i);
+	uint16_t column = v >> 2 & 0x7ff;
+	uint16_t num = v & 3;
+	for(uint16_t j = 0; j < num + 1; ++j)
+	  plane.PushPixel(column + j, row, 1, 0, pivot, fm_n);
+      }
+    }
+  }
+
+  std::vector<StandardPlane> ReferencePlanes(const NiEvent &ev, bool use_all_hits){
+    std::vector<StandardPlane> planes;
+    const std::vector<uint8_t> &data0 = ev.data0;
+    const std::vector<uint8_t> &data1 = ev.data1;
+    if(data0.size() < 20 || data1.size() < 20)
+      return planes;
+    uint16_t pivot = getlittleendian<uint16_t>(&data0[4]);
+    size_t it0 = 8;
+    size_t it1 = 8;
+    while(it0 + 8 <= data0.size() && it1 + 8 <= data1.size()){
+      size_t len0 = std::max(getlittleendian<uint16_t>(&data0[it0 + 4]), getlittleendian<uint16_t>(&data0[it0 + 6]));
+      size_t len1 = std::max(getlittleendian<uint16_t>(&data1[it1 + 4]), getlittleendian<uint16_t>(&data1[it1 + 6]));
+      if(len0 * 4 + 12 > data0.size() - it0 || len1 * 4 + 12 > data1.size() - it1)
+	break;
+      StandardPlane plane(planes.size(), "NI", "MIMOSA26");
+      plane.SetSizeZS(1152, 576, 0, 2, StandardPlane::FLAG_WITHPIVOT | StandardPlane::FLAG_DIFFCOORDS);
+      plane.SetPivotPixel((9216 + pivot + 64) % 9216);
+      ReferenceFrame(plane, 0, &data0[it0 + 8], len0, use_all_hits);
+      ReferenceFrame(plane, 1, &data1[it1 + 8], len1, use_all_hits);
+      planes.push_back(std::move(plane));
+      if(it0 + (len0 + 4) * 4 >= data0.size() || it1 + (len1 + 4) * 4 >= data1.size())
+	break;
+      it0 += (len0 + 4) * 4;
+      it1 += (len1 + 4) * 4;
+    }
+    return planes;
+  }
+
+  // the planes as the converter builds them from the decoder
+  void DecoderPlanes(Mimosa26Decoder &decoder, std::vector<StandardPlane> &planes){
+    planes.clear();
+    for(size_t board = 0; board < decoder.NumBoards(); ++board){
+      StandardPlane plane(board, "NI", "MIMOSA26");
+      plane.SetSizeZS(Mimosa26Decoder::X_SIZE, Mimosa26Decoder::Y_SIZE, 0, 2,
+		      StandardPlane::FLAG_WITHPIVOT | StandardPlane::FLAG_DIFFCOORDS);
+      plane.SetPivotPixel(decoder.PivotPixel());
+      for(uint32_t fm = 0; fm < 2; ++fm){
+	const Mimosa26Decoder::Frame &f = decoder.GetFrame(board, fm);
+	plane.PushPixels(f.n, f.x.data(), f.y.data(), decoder.Ones(), nullptr, fm, f.pivot.data());
+      }
+      planes.push_back(std::move(plane));
+    }
+  }
+
+  bool SamePlanes(const std::vector<StandardPlane> &a, const std::vector<StandardPlane> &b){
+    if(a.size() != b.size())
+      return false;
+    for(size_t p = 0; p < a.size(); ++p){
+      if(a[p].PivotPixel() != b[p].PivotPixel())
+	return false;
+      for(uint32_t fm = 0; fm < 2; ++fm){
+	if(a[p].XVector(fm) != b[p].XVector(fm) || a[p].YVector(fm) != b[p].YVector(fm) ||
+	   a[p].PixVector(fm) != b[p].PixVector(fm))
+	  return false;
+	for(uint32_t i = 0; i < a[p].HitPixels(fm); ++i)
+	  if(a[p].GetPivot(i, fm) != b[p].GetPivot(i, fm))
+	    return false;
+      }
+    }
+    return true;
+  }
+
+  // empty if the decoder agrees with the reference on all events
+  std::string Validate(const std::vector<NiEvent> &evs){
+    Mimosa26Decoder decoder;
+    std::vector<StandardPlane> planes;
+    for(size_t i = 0; i < evs.size(); ++i)
+      for(bool all: {false, true}){
+	decoder.Decode(evs[i].data0.data(), evs[i].data0.size(),
+		       evs[i].data1.data(), evs[i].data1.size(), all);
+	DecoderPlanes(decoder, planes);
+	if(!SamePlanes(planes, ReferencePlanes(evs[i], all)))
+	  return "Mimosa26Decoder differs from the reference in event " + std::to_string(i);
+      }
+    return "";
+  }
+}
+
+static void BM_Mimosa26Reference(benchmark::State& state){
+  std::vector<NiEvent> evs = GetNiEvents(state.range(0));
+  size_t bytes = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &ev = evs[i++ % evs.size()];
+    auto planes = ReferencePlanes(ev, false);
+    benchmark::DoNotOptimize(planes);
+    bytes += ev.data0.size() + ev.data1.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Mimosa26Reference)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_Mimosa26Decoder(benchmark::State& state){
+  std::vector<NiEvent> evs = GetNiEvents(state.range(0));
+  std::string err = Validate(evs);
+  if(!err.empty()){
+    state.SkipWithError(err.c_str());
+    return;
+  }
+  Mimosa26Decoder decoder;
+  size_t bytes = 0;
+  size_t hits = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &ev = evs[i++ % evs.size()];
+    decoder.Decode(ev.data0.data(), ev.data0.size(), ev.data1.data(), ev.data1.size());
+    for(size_t b = 0; b < decoder.NumBoards(); ++b)
+      hits += decoder.GetFrame(b, 0).n + decoder.GetFrame(b, 1).n;
+    bytes += ev.data0.size() + ev.data1.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+  state.counters["hits"] = benchmark::Counter(hits, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Mimosa26Decoder)->Arg(10)->Arg(100)->Arg(1000);
+
+// decoding and filling the StandardPlanes as the converter does
+static void BM_Mimosa26DecoderPlanes(benchmark::State& state){
+  std::vector<NiEvent> evs = GetNiEvents(state.range(0));
+  Mimosa26Decoder decoder;
+  std::vector<StandardPlane> planes;
+  size_t bytes = 0;
+  size_t i = 0;
+  for(auto _ : state){
+    auto &ev = evs[i++ % evs.size()];
+    decoder.Decode(ev.data0.data(), ev.data0.size(), ev.data1.data(), ev.data1.size());
+    DecoderPlanes(decoder, planes);
+    benchmark::DoNotOptimize(planes);
+    bytes += ev.data0.size() + ev.data1.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Mimosa26DecoderPlanes)->Arg(10)->Arg(100)->Arg(1000);
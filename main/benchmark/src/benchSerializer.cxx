@@ -0,0 +1,124 @@
+#include "benchCommon.hh"
+
+#include "eudaq/BufferSerializer.hh"
+#include "eudaq/FileSerializer.hh"
+#include "eudaq/FileDeserializer.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+using namespace eudaq;
+
+static void BM_EventRoundTrip(benchmark::State& state){
+  auto ev = bench::MakeRawEvent("BenchRaw", state.range(0));
+  size_t bytes = 0;
+  for(auto _ : state){
+    BufferSerializer ser;
+    ev->Serialize(ser);
+    uint32_t id;
+    ser.PreRead(id);
+    auto ev_des = Factory<Event>::MakeUnique<Deserializer&>(id, ser);
+    benchmark::DoNotOptimize(ev_des);
+    bytes += ser.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_EventRoundTrip)->RangeMultiplier(16)->Range(64, 1<<20);
+
+static void BM_StdEventRoundTrip(benchmark::State& state){
+  auto ev = bench::MakeStdEvent(6, state.range(0));
+  size_t bytes = 0;
+  for(auto _ : state){
+    BufferSerializer ser;
+    ev->Serialize(ser);
+    uint32_t id;
+    ser.PreRead(id);
+    auto ev_des = Factory<Event>::MakeUnique<Deserializer&>(id, ser);
+    benchmark::DoNotOptimize(ev_des);
+    bytes += ser.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_StdEventRoundTrip)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_BufferSerializerWrite(benchmark::State& state){
+  std::vector<uint8_t> data(state.range(0), 0xa5);
+  for(auto _ : state){
+    BufferSerializer ser;
+    ser.write(data);
+    benchmark::DoNotOptimize(ser.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_BufferSerializerWrite)->RangeMultiplier(16)->Range(64, 1<<20);
+
+static void BM_BufferSerializerRead(benchmark::State& state){
+  std::vector<uint8_t> data(state.range(0), 0xa5);
+  BufferSerializer src;
+  src.write(data);
+  std::vector<unsigned char> raw(&src[0], &src[0] + src.size());
+  std::vector<uint8_t> out;
+  // includes filling a fresh buffer, which is what the DataReceiver does
+  for(auto _ : state){
+    BufferSerializer ser(raw.begin(), raw.end());
+    ser.read(out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_BufferSerializerRead)->RangeMultiplier(16)->Range(64, 1<<20);
+
+static void BM_FileSerializer(benchmark::State& state){
+  std::string path = bench::WorkDir() + "eudaq_bench_fileserializer.raw";
+  auto ev = bench::MakeRawEvent("BenchRaw", state.range(0));
+  uint64_t bytes = 0;
+  {
+    FileSerializer ser(path, true);
+    for(auto _ : state){
+      ser.write(*ev);
+      ser.Flush();
+    }
+    bytes = ser.FileBytes();
+  }
+  std::remove(path.c_str());
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_FileSerializer)->RangeMultiplier(16)->Range(64, 1<<20);
+
+static void BM_FileDeserializer(benchmark::State& state){
+  std::string path = bench::WorkDir() + "eudaq_bench_filedeserializer.raw";
+  const size_t n_ev = 1000;
+  uint64_t file_bytes = 0;
+  {
+    FileSerializer ser(path, true);
+    for(size_t i = 0; i < n_ev; i++)
+      ser.write(*bench::MakeRawEvent("BenchRaw", state.range(0), i));
+    ser.Flush();
+    file_bytes = ser.FileBytes();
+  }
+  size_t n = 0;
+  std::unique_ptr<FileDeserializer> des;
+  for(auto _ : state){
+    if(!des || !des->HasData()){
+      state.PauseTiming();
+      des.reset(new FileDeserializer(path));
+      state.ResumeTiming();
+    }
+    uint32_t id;
+    des->PreRead(id);
+    auto ev = Factory<Event>::MakeUnique<Deserializer&>(id, *des);
+    benchmark::DoNotOptimize(ev);
+    n++;
+  }
+  des.reset();
+  std::remove(path.c_str());
+  state.SetItemsProcessed(n);
+  state.SetBytesProcessed(n * (file_bytes / n_ev));
+}
+BENCHMARK(BM_FileDeserializer)->RangeMultiplier(16)->Range(64, 1<<20);
@@ -0,0 +1,147 @@
+#include "benchCommon.hh"
+
+#include "eudaq/RunControl.hh"
+#include "eudaq/DataCollector.hh"
+#include "eudaq/Producer.hh"
+#include "eudaq/Metrics.hh"
+#include "eudaq/FileNamer.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+// The sync collectors are user modules (EventIDSyncDataCollector in
+// user/eudet, TimestampSyncDataCollector in user/experimental). They are
+// driven through a RunControl on localhost, with synthetic producers feeding
+// the collector over tcp. Point EUDAQ_MODULE_DIR to the module libraries when
+// running from the build tree; the RunControl port can be changed with
+// EUDAQ_BENCH_RC_PORT (44991 by default).
+
+using namespace eudaq;
+
+namespace{
+  const uint32_t N_PRODUCERS = 3;
+  const uint32_t BATCH = 1000;
+
+  std::string RunControlPort(){
+    const char *port = std::getenv("EUDAQ_BENCH_RC_PORT");
+    return port ? port : "44991";
+  }
+
+  bool WaitState(RunControl &rc, size_t n, int state){
+    auto tp_start = std::chrono::steady_clock::now();
+    while(std::chrono::steady_clock::now() - tp_start < std::chrono::seconds(20)){
+      size_t n_st = 0;
+      for(auto &conn_st: rc.GetActiveConnectionStatusMap())
+	if(conn_st.second && conn_st.second->GetState() == state)
+	  n_st++;
+      if(n_st == n)
+	return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+  }
+
+  std::string DataPattern(const std::string &dc_name){
+    return bench::WorkDir() + "eudaq_bench_" + dc_name + "_run$6R$X";
+  }
+
+  void WriteFiles(const std::string &ini, const std::string &conf, const std::string &dc_name){
+    std::ofstream fini(ini);
+    fini << "[RunControl]\n[DataCollector.bench_dc]\n";
+    std::ofstream fconf(conf);
+    fconf << "[RunControl]\n"
+	  << "[DataCollector.bench_dc]\n"
+	  << "EUDAQ_FW = native\n"
+	  << "EUDAQ_FW_PATTERN = " << DataPattern(dc_name) << "\n";
+    for(uint32_t i = 0; i < N_PRODUCERS; i++){
+      fini << "[Producer.bench_p" << i << "]\n";
+      fconf << "[Producer.bench_p" << i << "]\n" << "EUDAQ_DC = bench_dc\n";
+    }
+  }
+}
+
+static void BM_SyncDataCollector(benchmark::State& state, const std::string &dc_name){
+  ModuleManager::Instance()->LoadModuleFor(str2hash(dc_name));
+  if(!Factory<DataCollector>::Instance<const std::string&, const std::string&>().count(str2hash(dc_name))){
+    state.SkipWithError((dc_name + " is not loaded, set EUDAQ_MODULE_DIR").c_str());
+    for(auto _ : state){}
+    return;
+  }
+  std::string rc_addr = "tcp://127.0.0.1:" + RunControlPort();
+  std::string ini = bench::WorkDir() + "eudaq_bench_sync.ini";
+  std::string conf = bench::WorkDir() + "eudaq_bench_sync.conf";
+  WriteFiles(ini, conf, dc_name);
+
+  auto rc = std::make_shared<RunControl>("tcp://" + RunControlPort());
+  rc->StartRunControl();
+  auto dc = DataCollector::Make(dc_name, "bench_dc", rc_addr);
+  dc->Connect();
+  std::vector<std::shared_ptr<Producer>> pds;
+  for(uint32_t i = 0; i < N_PRODUCERS; i++){
+    pds.push_back(std::make_shared<Producer>("bench_p" + std::to_string(i), rc_addr));
+    pds.back()->Connect();
+  }
+  const size_t n_conn = N_PRODUCERS + 1;
+  bool ok = WaitState(*rc, n_conn, Status::STATE_UNINIT);
+  rc->ReadInitilizeFile(ini);
+  rc->Initialise();
+  ok = ok && WaitState(*rc, n_conn, Status::STATE_UNCONF);
+  rc->ReadConfigureFile(conf);
+  rc->Configure();
+  ok = ok && WaitState(*rc, n_conn, Status::STATE_CONF);
+  uint32_t run_n = rc->GetRunN();
+  rc->StartRun();
+  ok = ok && WaitState(*rc, n_conn, Status::STATE_RUNNING);
+  if(!ok)
+    state.SkipWithError("the run could not be started");
+
+  MetricStage &st_write = Metrics::Instance().Stage("write");
+  MetricGauge &g_bytes = Metrics::Instance().Gauge("file_bytes");
+  uint64_t written = st_write.Events().Get();
+  uint64_t bytes_begin = g_bytes.Get();
+  uint64_t n_ev = 0;
+  for(auto _ : state){
+    if(!ok)
+      break;
+    for(uint32_t i = 0; i < BATCH; i++, n_ev++){
+      for(auto &pd: pds){
+	auto ev = bench::MakeRawEvent("BenchRaw", 256, n_ev);
+	ev->SetTimestamp(n_ev * 100, n_ev * 100 + 50);
+	pd->SendEvent(ev);
+      }
+    }
+    written += BATCH;
+    auto tp_start = std::chrono::steady_clock::now();
+    while(st_write.Events().Get() < written){
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      if(std::chrono::steady_clock::now() - tp_start > std::chrono::seconds(20)){
+	state.SkipWithError("timeout waiting for the built events");
+	ok = false;
+	break;
+      }
+    }
+  }
+  uint64_t bytes = g_bytes.Get() - bytes_begin;
+
+  rc->StopRun();
+  WaitState(*rc, n_conn, Status::STATE_STOPPED);
+  rc->Terminate();
+  pds.clear();
+  dc.reset();
+  rc.reset();
+  std::remove(ini.c_str());
+  std::remove(conf.c_str());
+  std::string data = FileNamer(DataPattern(dc_name)).Set('X', ".raw").Set('R', run_n);
+  std::remove(data.c_str());
+
+  state.SetItemsProcessed(state.iterations() * BATCH);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK_CAPTURE(BM_SyncDataCollector, EventIDSync, std::string("EventIDSyncDataCollector"))
+->Iterations(10)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_SyncDataCollector, TimestampSync, std::string("TimestampSyncDataCollector"))
+->Iterations(10)->Unit(benchmark::kMillisecond)->UseRealTime();
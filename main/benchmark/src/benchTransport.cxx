@@ -0,0 +1,61 @@
+#include "eudaq/TransportServer.hh"
+#include "eudaq/TransportClient.hh"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace eudaq;
+
+namespace{
+  struct PacketCounter {
+    std::atomic<uint64_t> packets{0};
+    void Handler(TransportEvent &ev){
+      if(ev.etype == TransportEvent::RECEIVE)
+	packets++;
+    }
+  };
+}
+
+// Packets of the given size sent over tcp loopback, the server processes
+// them on its own thread like the DataReceiver does.
+static void BM_TransportTCPLoopback(benchmark::State& state){
+  const uint64_t batch = 100;
+  PacketCounter counter;
+  std::unique_ptr<TransportServer> server(TransportServer::CreateServer("tcp://0"));
+  server->SetCallback(TransportCallback(&counter, &PacketCounter::Handler));
+  std::string port = server->ConnectionString();
+  port = port.substr(port.find_last_not_of("0123456789") + 1);
+
+  std::atomic<bool> stop(false);
+  std::thread thd([&](){
+      while(!stop)
+	server->Process(100000);
+    });
+  std::unique_ptr<TransportClient> client(TransportClient::CreateClient("tcp://127.0.0.1:" + port));
+
+  std::string packet(state.range(0), 'x');
+  uint64_t expected = 0;
+  for(auto _ : state){
+    for(uint64_t i = 0; i < batch; i++)
+      client->SendPacket(packet);
+    expected += batch;
+    auto tp_start = std::chrono::steady_clock::now();
+    while(counter.packets < expected){
+      std::this_thread::yield();
+      if(std::chrono::steady_clock::now() - tp_start > std::chrono::seconds(10)){
+	state.SkipWithError("timeout waiting for the loopback packets");
+	break;
+      }
+    }
+  }
+  client.reset();
+  stop = true;
+  thd.join();
+  state.SetItemsProcessed(state.iterations() * batch);
+  state.SetBytesProcessed(state.iterations() * batch * packet.size());
+}
+BENCHMARK(BM_TransportTCPLoopback)->RangeMultiplier(16)->Range(64, 1<<20)->UseRealTime();
@@ -11,6 +11,8 @@ int main(int /*argc*/, const char **argv) {
   eudaq::Option<std::string> file_output(op, "o", "output", "", "string",
 					 "output file");
   eudaq::OptionFlag iprint(op, "ip", "iprint", "enable print of input Event");
+  eudaq::Option<uint32_t> threads(op, "j", "threads", 0, "uint32_t",
+				  "number of converter threads of the file writer, 0 to convert in the reading thread (writers which support it, e.g. slcio)");
 
   try{
     op.Parse(argv);
@@ -46,6 +48,11 @@ int main(int /*argc*/, const char **argv) {
   reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
   if(!type_out.empty())
     writer = eudaq::Factory<eudaq::FileWriter>::MakeUnique(eudaq::str2hash(type_out), outfile_path);
+  if(writer){
+    auto conf = std::make_shared<eudaq::Configuration>();
+    conf->Set("EUDAQ_FW_THREADS", threads.Value());
+    writer->SetConfiguration(conf);
+  }
   while(1){
     auto ev = reader->GetNextEvent();
     if(!ev)
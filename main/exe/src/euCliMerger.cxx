@@ -0,0 +1,82 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/EventMerger.hh"
+#include "eudaq/FileWriter.hh"
+#include <algorithm>
+#include <iostream>
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line DataMerger", "2.0",
+			 "Offline event building of the files of parallel data streams. "
+			 "The first input is the reference, one merged event is built per reference event.");
+  eudaq::Option<std::vector<std::string>> file_input(op, "i", "input", "file1,file2,...", ",",
+						     "input files, the first one is the reference (e.g. tlu)");
+  eudaq::Option<std::string> file_output(op, "o", "output", "", "string",
+					 "output file");
+  eudaq::Option<std::string> key(op, "k", "key", "trigger", "trigger|event|timestamp",
+				 "event building by trigger ID, event ID or begin timestamp");
+  eudaq::Option<uint64_t> window(op, "w", "window", 0, "uint64_t",
+				 "accepted difference of the keys, e.g. the timestamp window");
+  eudaq::Option<std::vector<uint32_t>> dup(op, "d", "duplicate", "n1,n2,...", ",",
+					   "inputs (0-based) whose last event is duplicated to each reference event, e.g. Mimosa in mixed mode");
+  eudaq::Option<std::vector<uint32_t>> col(op, "c", "collect", "n1,n2,...", ",",
+					   "inputs whose events up to the next reference event are all attached");
+  eudaq::Option<std::vector<uint32_t>> flat(op, "f", "flatten", "n1,n2,...", ",",
+					    "inputs whose sub-events are attached instead of the events themselves");
+  eudaq::Option<std::string> type(op, "t", "type", "MimosaTlu", "string",
+				  "event type of the merged events");
+  eudaq::Option<uint32_t> depth(op, "p", "prefetch", 256, "uint32_t",
+				"number of events read ahead per input");
+  eudaq::Option<uint64_t> max_events(op, "n", "events", UINT64_MAX, "uint64_t",
+				     "maximum number of merged events");
+
+  try{
+    op.Parse(argv);
+  }
+  catch (...) {
+    return op.HandleMainException();
+  }
+
+  auto &infiles = file_input.Value();
+  if(infiles.size() < 2){
+    std::cout<<"option --help to get help"<<std::endl;
+    return 1;
+  }
+
+  eudaq::EventMerger::Key mkey = eudaq::EventMerger::Key::TRIGGER_N;
+  if(key.Value() == "event")
+    mkey = eudaq::EventMerger::Key::EVENT_N;
+  else if(key.Value() == "timestamp")
+    mkey = eudaq::EventMerger::Key::TIMESTAMP;
+  else if(key.Value() != "trigger"){
+    std::cout<<"unknown key "<<key.Value()<<", option --help to get help"<<std::endl;
+    return 1;
+  }
+
+  auto listed = [](const eudaq::Option<std::vector<uint32_t>> &opt, uint32_t i){
+    return std::find(opt.Value().begin(), opt.Value().end(), i) != opt.Value().end();
+  };
+
+  try{
+    eudaq::EventMerger merger(mkey, window.Value());
+    merger.SetEventType(type.Value());
+    merger.SetPrefetchDepth(depth.Value());
+    for(uint32_t i = 0; i < infiles.size(); i++){
+      auto policy = eudaq::EventMerger::Policy::MATCH;
+      if(listed(dup, i))
+	policy = eudaq::EventMerger::Policy::DUPLICATE;
+      else if(listed(col, i))
+	policy = eudaq::EventMerger::Policy::COLLECT;
+      merger.AddInput(infiles[i], policy, listed(flat, i));
+    }
+    std::string outfile_path = file_output.Value();
+    if(!outfile_path.empty())
+      merger.SetWriter(eudaq::FileWriter::Make(eudaq::EventMerger::FileType(outfile_path), outfile_path));
+    merger.Run(max_events.Value());
+    merger.Print(std::cout);
+  }
+  catch(const std::exception &e){
+    std::cerr<<e.what()<<std::endl;
+    return 1;
+  }
+  return 0;
+}
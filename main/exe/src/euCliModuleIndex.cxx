@@ -0,0 +1,24 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/ModuleManager.hh"
+#include <iostream>
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ Command Line Module Indexer", "2.0",
+			 "Write the index of the factory IDs registered by a module,"
+			 " used to load the module only on demand", 1);
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    return op.HandleMainException();
+  }
+  int ret = 0;
+  for(size_t i = 0; i < op.NumArgs(); i++){
+    std::string file = op.GetArg(i);
+    if(!eudaq::ModuleManager::Instance()->WriteModuleIndex(file)){
+      std::cerr<<"Fail to index module "<<file<<std::endl;
+      ret = 1;
+    }
+  }
+  return ret;
+}
@@ -1,39 +1,33 @@
 #include "eudaq/OptionParser.hh"
-#include "eudaq/FileReader.hh"
-#include "eudaq/StdEventConverter.hh"
+#include "eudaq/FileScanner.hh"
 
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 int main(int /*argc*/, const char **argv) {
-  eudaq::OptionParser op("EUDAQ Command Line FileReader modified for TLU", "2.1", "EUDAQ FileReader (TLU)");
+  eudaq::OptionParser op("EUDAQ Command Line FileReader modified for TLU", "2.2", "EUDAQ FileReader (TLU)");
   eudaq::Option<std::string> file_input(op, "i", "input", "", "string", "input file");
   eudaq::Option<std::string> file_conf(op, "c", "config", "", "string", "configuration file");
-  eudaq::Option<uint32_t> eventl(op, "e", "event", 0, "uint32_t", "event number low");
-  eudaq::Option<uint32_t> eventh(op, "E", "eventhigh", 0, "uint32_t", "event number high");
-  eudaq::Option<uint32_t> triggerl(op, "tg", "trigger", 0, "uint32_t", "trigger number low");
-  eudaq::Option<uint32_t> triggerh(op, "TG", "triggerhigh", 0, "uint32_t", "trigger number high");
-  eudaq::Option<uint32_t> timestampl(op, "ts", "timestamp", 0, "uint32_t", "timestamp low");
-  eudaq::Option<uint32_t> timestamph(op, "TS", "timestamphigh", 0, "uint32_t", "timestamp high");
+  eudaq::Option<uint64_t> eventl(op, "e", "event", 0, "uint64_t", "event number low");
+  eudaq::Option<uint64_t> eventh(op, "E", "eventhigh", 0, "uint64_t", "event number high");
+  eudaq::Option<uint64_t> triggerl(op, "tg", "trigger", 0, "uint64_t", "trigger number low");
+  eudaq::Option<uint64_t> triggerh(op, "TG", "triggerhigh", 0, "uint64_t", "trigger number high");
+  eudaq::Option<uint64_t> timestampl(op, "ts", "timestamp", 0, "uint64_t", "timestamp low");
+  eudaq::Option<uint64_t> timestamph(op, "TS", "timestamphigh", 0, "uint64_t", "timestamp high");
+  eudaq::Option<uint32_t> threads(op, "j", "threads", std::thread::hardware_concurrency(), "uint32_t",
+				  "number of threads scanning a native file");
+  eudaq::Option<uint32_t> chunk_mb(op, "m", "chunk", 64, "uint32_t", "maximum size of a chunk of a native file in MiB");
   eudaq::OptionFlag stat(op, "s", "statistics", "enable print of statistics");
   eudaq::OptionFlag stdev(op, "std", "stdevent", "enable converter of StdEvent");
 
   op.Parse(argv);
   std::string infile_path = file_input.Value();
-  std::string type_in = infile_path.substr(infile_path.find_last_of(".")+1);
-  if(type_in=="raw")
-    type_in = "native";
-
-  bool stdev_v = stdev.Value();
-
-
-  uint32_t eventl_v = eventl.Value();
-  uint32_t eventh_v = eventh.Value();
-  uint32_t triggerl_v = triggerl.Value();
-  uint32_t triggerh_v = triggerh.Value();
-  uint32_t timestampl_v = timestampl.Value();
-  uint32_t timestamph_v = timestamph.Value();
-  bool not_all_zero = eventl_v||eventh_v||triggerl_v||triggerh_v||timestampl_v||timestamph_v;
 
+  eudaq::ScanRange range_ev{eventl.Value(), eventh.Value()};
+  eudaq::ScanRange range_tg{triggerl.Value(), triggerh.Value()};
+  eudaq::ScanRange range_ts{timestampl.Value(), timestamph.Value()};
+  bool not_all_zero = range_ev.IsSet() || range_tg.IsSet() || range_ts.IsSet();
 
   // load configuration
     // empty configuration object, prevents crash if no config file given
@@ -52,64 +46,19 @@ int main(int /*argc*/, const char **argv) {
   const eudaq::Configuration const_eu_cfg = eu_cfg;
   eudaq::ConfigurationSPC config_spc = std::make_shared<const eudaq::Configuration>(const_eu_cfg);
 
-
-  eudaq::FileReaderUP reader;
-  reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type_in), infile_path);
-  uint32_t event_count = 0;
-
-  while(1){
-    auto ev = reader->GetNextEvent();
-    if(!ev)
-      break;
-    bool in_range_evn = false;
-    if(eventl_v!=0 || eventh_v!=0){
-      uint32_t ev_n = ev->GetEventN();
-      if(ev_n >= eventl_v && ev_n < eventh_v){
-        in_range_evn = true;
-      }
-    }
-    else
-      in_range_evn = true;
-
-    bool in_range_tgn = false;
-    if(triggerl_v!=0 || triggerh_v!=0){
-      uint32_t tg_n = ev->GetTriggerN();
-      if(tg_n >= triggerl_v && tg_n < triggerh_v){
-        in_range_tgn = true;
-      }
-    }
-    else
-      in_range_tgn = true;
-
-    bool in_range_tsn = false;
-    if(timestampl_v!=0 || timestamph_v!=0){
-      uint32_t ts_beg = ev->GetTimestampBegin();
-      uint32_t ts_end = ev->GetTimestampEnd();
-      if(ts_beg >= timestampl_v && ts_end <= timestamph_v){
-        in_range_tsn = true;
-      }
-    }
-    else
-      in_range_tsn = true;
-
-
-    if((in_range_evn && in_range_tgn && in_range_tsn) && not_all_zero){
-      ev->Print(std::cout);
-      if(stdev_v){
-        auto evstd = eudaq::StandardEvent::MakeShared();
-        eudaq::StdEventConverter::Convert(ev, evstd, config_spc);
-        std::cout<< ">>>>>"<< evstd->NumPlanes() <<"<<<<"<<std::endl;
-// FIXME ---> CHANGE!
-/*        for(unsigned int k = 0 ; k < ev->GetNumSubEvent(); ++k) {
-            auto evstd = eudaq::StandardEvent::MakeShared();
-            eudaq::StdEventConverter::Convert(ev->GetSubEvent(k), evstd, config_spc);
-            std::cout<< ">>>>> Sub-Event-"<< k << " Num. Planes:" << evstd->NumPlanes() <<"<<<<"<<std::endl;
-        }*/
-      }
-    }
-
-    event_count ++;
-  }
-  std::cout<< "There are "<< event_count << " Events"<<std::endl;
+  eudaq::FileScanner scanner(infile_path);
+  scanner.SetThreads(threads.Value());
+  scanner.SetChunkSize(uint64_t(chunk_mb.Value()) << 20);
+  // without a range the conversion is only needed for the hit counts
+  scanner.SetConvert(stdev.Value() && (not_all_zero || stat.Value()), config_spc);
+  scanner.SetEventRange(range_ev);
+  scanner.SetTriggerRange(range_tg);
+  scanner.SetTimestampRange(range_ts);
+  scanner.SetPrint(&std::cout);
+  eudaq::ScanStatistics st = scanner.Run();
+
+  if(stat.Value())
+    st.Print(std::cout);
+  std::cout<< "There are "<< st.n_event << " Events"<<std::endl;
   return 0;
 }
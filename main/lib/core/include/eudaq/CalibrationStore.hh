@@ -0,0 +1,57 @@
+#ifndef EUDAQ_INCLUDED_CalibrationStore
+#define EUDAQ_INCLUDED_CalibrationStore
+
+#include "eudaq/Platform.hh"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eudaq {
+
+  // Read-only rows x columns table of floats, either owned or mapped from a
+  // calibration cache file. Copies share the storage.
+  class DLLEXPORT CalibrationTable {
+  public:
+    CalibrationTable();
+    // data holds the rows one after the other
+    CalibrationTable(uint32_t columns, std::vector<float> &&data);
+    CalibrationTable(uint32_t rows, uint32_t columns,
+		     std::shared_ptr<const void> hold, const float *data);
+    bool Empty() const {return m_rows == 0;};
+    uint32_t Rows() const {return m_rows;};
+    uint32_t Columns() const {return m_columns;};
+    const float *Data() const {return m_data;};
+    const float *Row(uint32_t r) const {return m_data + size_t(r) * m_columns;};
+    float At(uint32_t r, uint32_t c) const {return m_data[size_t(r) * m_columns + c];};
+  private:
+    std::shared_ptr<const void> m_hold;
+    const float *m_data;
+    uint32_t m_rows;
+    uint32_t m_columns;
+  };
+
+  // Parses calibration files once and keeps the result in a binary cache,
+  // keyed by the path of the source file, a kind chosen by the caller and
+  // the version of its parser, and checked against the modification time
+  // and size of the source. Valid caches are memory mapped read only, so
+  // all processes using the same calibration share one copy in the page
+  // cache.
+  //
+  // The cache directory is $EUDAQ_CALIBRATION_CACHE, else
+  // $XDG_CACHE_HOME/eudaq or $HOME/.cache/eudaq. EUDAQ_CALIBRATION_CACHE=none
+  // disables the cache and every Load calls the parser.
+  class DLLEXPORT CalibrationStore {
+  public:
+    using Parser = std::function<CalibrationTable(const std::string &path)>;
+    // Bump version when the parser or the layout of its table changes.
+    // Exceptions of the parser are passed on, nothing is cached then.
+    static CalibrationTable Load(const std::string &path, const std::string &kind,
+				 uint32_t version, const Parser &parse);
+    static std::string CacheDirectory();
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_CalibrationStore
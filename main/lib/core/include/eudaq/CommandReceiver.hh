@@ -5,6 +5,8 @@
 #include "eudaq/Platform.hh"
 #include "eudaq/Configuration.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/Metrics.hh"
+#include "eudaq/MetricsServer.hh"
 
 #include <thread>
 #include <memory>
@@ -59,6 +61,7 @@ namespace eudaq {
     bool AsyncForwarding();
     bool AsyncReceiving();
     bool RunLooping();
+    void DumpTrace(const std::string &prefix, bool on_signal);
 
   private:
     std::unique_ptr<TransportClient> m_cmdclient;
@@ -82,6 +85,8 @@ namespace eudaq {
     std::string m_type;
     std::string m_name;
     uint32_t m_run_number;
+    MetricsPublisher m_metrics;
+    MetricsServer m_metrics_http;
   };
 }
 
@@ -7,9 +7,12 @@
 #include <functional>
 #include <string>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace eudaq {
   class Configuration;
+  class ConfigurationSection;
   
   using ConfigurationUP = std::unique_ptr<Configuration, std::function<void(Configuration*)> >;
   using ConfigurationSP = std::shared_ptr<Configuration>;
@@ -20,6 +23,65 @@ namespace eudaq {
   using ConfigSP = ConfigurationSP;
   using ConfigWP = ConfigurationWP;
   using ConfigSPC = ConfigurationSPC;
+
+  using ConfigurationSectionSPC = std::shared_ptr<const ConfigurationSection>;
+
+  /**
+   * @brief Immutable snapshot of one section of a Configuration
+   *
+   * Keys are looked up by their hash and numbers are parsed once when the
+   * snapshot is made, so a section can be read per event and shared between
+   * threads. The Get overloads return the same values as those of
+   * Configuration. A key used in a hot loop can be hashed at compile time:
+   *   static constexpr ConfigurationSection::Key KEY("delta_t0");
+   * A Key made from a std::string refers to it and must not outlive it.
+   */
+  class DLLEXPORT ConfigurationSection {
+  public:
+    struct Key {
+      constexpr Key(const char *k) : name(k), hash(cstr2hash(k)) {}
+      Key(const std::string &k) : name(k.c_str()), hash(str2hash(k)) {}
+      const char *name;
+      uint32_t hash;
+    };
+
+    const std::string &Name() const {return m_name;}
+    bool Has(const Key &key) const {return Find(key) != nullptr;}
+    std::vector<std::string> Keylist() const;
+    std::string Get(const Key &key, const std::string &def) const;
+    std::string Get(const Key &key, const char *def) const {
+      return Get(key, std::string(def));
+    }
+    float Get(const Key &key, float def) const;
+    double Get(const Key &key, double def) const;
+    int64_t Get(const Key &key, int64_t def) const;
+    uint64_t Get(const Key &key, uint64_t def) const;
+    int Get(const Key &key, int def) const;
+    template <typename T> T Get(const Key &key, T def) const {
+      const Entry *e = Find(key);
+      return e ? from_string(e->value, def) : def;
+    }
+
+  private:
+    friend class Configuration;
+    ConfigurationSection(const std::string &name,
+                         const std::map<std::string, std::string> &section);
+    struct Entry {
+      uint32_t hash;
+      std::string key;
+      std::string value;
+      int64_t i64;
+      uint64_t u64;
+      long l;
+      double d;
+      float f;
+      bool d_ok;
+      bool f_ok;
+    };
+    const Entry *Find(const Key &key) const;
+    std::string m_name;
+    std::vector<Entry> m_entries; // sorted by hash
+  };
   
   class DLLEXPORT Configuration {
   public:
@@ -57,6 +119,15 @@ namespace eudaq {
     bool SetSection(const std::string &section) const;
     bool SetSection(const std::string &section);
     std::string GetCurrentSectionName() const {return m_section;};
+    /**
+     * @brief Snapshot of the current section, made once and shared until
+     * the configuration or its current section changes
+     */
+    ConfigurationSectionSPC Section() const;
+    /**
+     * @brief Snapshot of a section, without changing the current one
+     */
+    ConfigurationSectionSPC Section(const std::string &section) const;
     std::string operator[](const std::string &key) const {
       std::string retval;
       if(GetString(key,retval)) return retval;
@@ -100,6 +171,8 @@ namespace eudaq {
     map_t m_config;
     mutable std::string m_section;
     mutable section_t *m_cur;
+    // read and replaced with std::atomic_load/atomic_store
+    mutable ConfigurationSectionSPC m_snapshot;
   };
 
   inline std::ostream &operator<<(std::ostream &os, const Configuration &c) {
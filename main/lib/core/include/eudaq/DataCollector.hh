@@ -9,6 +9,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/RunStatistics.hh"
 
 #include <string>
 #include <vector>
@@ -59,6 +60,7 @@ namespace eudaq {
     void OnConnect(ConnectionSPC id) override final;
     void OnDisconnect(ConnectionSPC id) override final;
     void OnReceive(ConnectionSPC id, EventSP ev) override final;
+    void WriteRunStatistics();
   private:
     std::string m_data_addr;
     FileWriterSP m_writer;
@@ -69,7 +71,12 @@ namespace eudaq {
     uint32_t m_dct_n;
     uint32_t m_evt_c;
     uint32_t m_fraction;
+    bool m_stat_enabled;
+    RunStatistics m_stat;
     ConfigurationSPC m_conf;
+    MetricStage &m_st_build;
+    MetricStage &m_st_write;
+    MetricGauge &m_g_file_bytes;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
@@ -10,6 +10,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 #include "eudaq/Factory.hh"
+#include "eudaq/Metrics.hh"
 
 #include <string>
 #include <vector>
@@ -56,7 +57,10 @@ namespace eudaq {
     std::mutex m_mx_qu_ev;
     std::mutex m_mx_deamon;
     std::queue<std::pair<EventSP, ConnectionSPC>> m_qu_ev;
+    std::queue<std::chrono::steady_clock::time_point> m_qu_tp;
     std::condition_variable m_cv_not_empty;
+    MetricStage &m_st_rcv;
+    MetricStage &m_st_des;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
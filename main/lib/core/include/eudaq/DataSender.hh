@@ -4,6 +4,7 @@
 
 #include "eudaq/Platform.hh"
 #include "eudaq/Event.hh"
+#include "eudaq/Metrics.hh"
 #include <string>
 #include <future>
 #include <thread>
@@ -31,6 +32,7 @@ class TransportClient;
       std::mutex m_mx_qu_ev; 
       std::queue<EventSPC> m_qu_ev;
       std::condition_variable m_cv_not_empty;
+      MetricStage &m_st_send;
   };
 
 }
@@ -115,7 +115,7 @@ namespace eudaq {
     uint32_t GetRunNumber()const;
 
     //from RawdataEvent
-    std::vector<uint8_t> GetBlock(uint32_t i) const;
+    const std::vector<uint8_t>& GetBlock(uint32_t i) const;
     size_t GetNumBlock() const;
     size_t NumBlocks() const;
     std::vector<uint32_t> GetBlockNumList() const;
@@ -127,6 +127,12 @@ namespace eudaq {
       return m_blocks.size();
     }
 
+    /// Add a data block by taking over a byte vector, without copying
+    size_t AddBlock(uint32_t id, std::vector<uint8_t> &&data){
+      m_blocks[id]=std::move(data);
+      return m_blocks.size();
+    }
+
     /// Add a data block as array with given size
     template <typename T>
     size_t AddBlock(uint32_t id, const T *data, size_t bytes){
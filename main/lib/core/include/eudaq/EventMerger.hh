@@ -0,0 +1,112 @@
+#ifndef EUDAQ_INCLUDED_EventMerger
+#define EUDAQ_INCLUDED_EventMerger
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/FileWriter.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eudaq {
+
+  // Reads a file on its own thread, staying up to depth events ahead of the
+  // consumer. Exceptions of the reader are rethrown by Next().
+  class DLLEXPORT PrefetchReader {
+  public:
+    PrefetchReader(FileReaderSP reader, size_t depth);
+    ~PrefetchReader();
+    // nullptr at the end of the file
+    EventSPC Next();
+  private:
+    void Reading();
+    FileReaderSP m_reader;
+    size_t m_depth;
+    std::deque<EventSPC> m_queue;
+    std::deque<EventSPC> m_local;
+    bool m_eof;
+    bool m_stop;
+    std::exception_ptr m_error;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thd;
+  };
+
+  // Offline event building from any number of files of the same run. The
+  // first input is the reference stream: one merged event per reference
+  // event, holding the reference event followed by the events of the other
+  // inputs in the order they were added. Each input is aligned to the
+  // reference by key (trigger ID, event ID or begin timestamp within a
+  // window) according to its policy:
+  //   MATCH     the event with the same key, the merged event is dropped if
+  //             there is none
+  //   DUPLICATE the last event with a key not above the reference key, e.g.
+  //             a Mimosa frame shared by several triggers
+  //   COLLECT   all events with a key from the reference key up to the next
+  //             reference key, may be none
+  // Merging stops when a MATCH input or the reference runs out, or when a
+  // DUPLICATE input has no event at all; its last event is kept for all
+  // further reference keys.
+  class DLLEXPORT EventMerger {
+  public:
+    enum class Key {TRIGGER_N, EVENT_N, TIMESTAMP};
+    enum class Policy {MATCH, DUPLICATE, COLLECT};
+
+    EventMerger(Key key = Key::TRIGGER_N, uint64_t window = 0);
+    ~EventMerger();
+    // flatten: add the sub-events of the input events instead of the events
+    void AddInput(const std::string &path, Policy policy = Policy::MATCH, bool flatten = false);
+    void AddInput(FileReaderSP reader, const std::string &name,
+		  Policy policy = Policy::MATCH, bool flatten = false);
+    void SetWriter(FileWriterSP writer);
+    // type of the merged events, selects the converter of the merged data
+    void SetEventType(const std::string &type);
+    void SetPrefetchDepth(size_t depth);
+    // returns the number of merged events written
+    uint64_t Run(uint64_t max_events = UINT64_MAX);
+
+    uint64_t NumMerged() const {return m_n_merged;};
+    uint64_t NumIncomplete() const {return m_n_incomplete;};
+    void Print(std::ostream &os) const;
+
+    // file reader/writer type from the file extension
+    static std::string FileType(const std::string &path);
+  private:
+    struct Input {
+      std::string name;
+      FileReaderSP file;
+      std::unique_ptr<PrefetchReader> reader;
+      Policy policy;
+      bool flatten;
+      EventSPC cur;
+      EventSPC next;
+      bool used;
+      uint64_t n_used;
+      uint64_t n_dropped;
+      uint64_t n_pending;
+    };
+    uint64_t KeyOf(const EventSPC &ev) const;
+    void Add(Event &sync, Input &in, const EventSPC &ev);
+    bool Advance(Input &in);
+
+    Key m_key;
+    uint64_t m_window;
+    std::string m_type;
+    size_t m_depth;
+    FileWriterSP m_writer;
+    std::vector<Input> m_in;
+    uint64_t m_n_merged;
+    uint64_t m_n_incomplete;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_EventMerger
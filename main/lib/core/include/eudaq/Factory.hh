@@ -6,6 +6,9 @@
 #include <utility>
 #include <functional>
 #include <cstdint>
+#include <mutex>
+
+#include "ModuleManager.hh"
 
 namespace eudaq{
 
@@ -54,13 +57,22 @@ namespace eudaq{
   typename Factory<BASE>::UP_BASE
   Factory<BASE>::MakeUnique(std::uint32_t id, ARGS&& ...args){
     auto &ins = Instance<ARGS&&...>();
-    auto it = ins.find(id);
-    if (it == ins.end()){
+    UP_BASE (*maker)(ARGS&&...) = nullptr;
+    {
+      std::lock_guard<std::recursive_mutex> lk(ModuleManager::FactoryMutex());
+      auto it = ins.find(id);
+      // load the module which provides a missing ID, then look again
+      if(it == ins.end() && ModuleManager::Instance()->LoadModuleFor(id))
+	it = ins.find(id);
+      if(it != ins.end())
+	maker = it->second;
+    }
+    if (!maker){
       std::cerr<<"Factory<"<<static_cast<const void *>(&ins)<<">: "
 	       <<" Unknown class ID: <"<<id<<">\n";
       return nullptr;
     }
-    return (it->second)(std::forward<ARGS>(args)...);
+    return maker(std::forward<ARGS>(args)...);
   }
 
   template <typename BASE>
@@ -97,6 +109,8 @@ namespace eudaq{
   std::uint64_t
   Factory<BASE>::Register(std::uint32_t id){
     auto &ins = Instance<ARGS&&...>();
+    std::lock_guard<std::recursive_mutex> lk(ModuleManager::FactoryMutex());
+    ModuleManager::Registered(id);
     // std::cout<<"Register ID "<<id <<"  to Factory<"
     // 	     <<static_cast<const void *>(&ins)<<">    ";
     ins[id] = &MakerFun<DERIVED, ARGS&&...>;
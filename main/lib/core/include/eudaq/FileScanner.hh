@@ -0,0 +1,97 @@
+#ifndef EUDAQ_INCLUDED_FileScanner
+#define EUDAQ_INCLUDED_FileScanner
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+#include "eudaq/Configuration.hh"
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace eudaq {
+
+  // Summary of a scanned file, or of a consecutive part of it
+  class DLLEXPORT ScanStatistics {
+  public:
+    ScanStatistics();
+    void Add(const Event &ev);
+    // hits of one plane of the StandardEvent of an event
+    void AddHits(uint32_t plane, uint64_t hits);
+    // append the statistics of the part of the file that follows this one
+    void Merge(const ScanStatistics &next);
+    void Print(std::ostream &os) const;
+
+    uint64_t n_event;
+    // events and sub-events per description and stream number
+    std::map<std::pair<std::string, uint32_t>, uint64_t> n_type;
+    bool has_trigger;
+    uint64_t trigger_first;
+    uint64_t trigger_last;
+    // steps of the trigger number other than +1 and the triggers skipped by them
+    uint64_t n_trigger_gap;
+    uint64_t n_trigger_missing;
+    bool has_timestamp;
+    uint64_t ts_min;
+    uint64_t ts_max;
+    std::map<uint32_t, uint64_t> n_hit;
+    std::map<uint32_t, uint64_t> n_plane_event;
+  };
+
+  // Inclusive-low, exclusive-high range of a 64-bit quantity, unset when
+  // both limits are 0
+  struct ScanRange {
+    uint64_t low = 0;
+    uint64_t high = 0;
+    bool IsSet() const {return low || high;}
+  };
+
+  // Parallel reader of a file for statistics and range queries. A native
+  // file is cut into chunks at event boundaries by a walk over the event
+  // headers that skips the data blocks; the chunks are deserialised and
+  // summarised on all threads and the per-chunk results are merged in file
+  // order. The conversion to StandardEvent, and the printing that goes with
+  // it, runs on the calling thread in file order, as the converters are not
+  // thread safe and depend on the events before. Other file types, and
+  // native files holding events other than RawEvent at the top level, are
+  // read on one thread through their FileReader.
+  class DLLEXPORT FileScanner {
+  public:
+    FileScanner(const std::string &path);
+    void SetThreads(uint32_t n);
+    void SetChunkSize(uint64_t bytes);
+    // convert to StandardEvent, required for the hit counts
+    void SetConvert(bool convert, ConfigurationSPC conf = nullptr);
+    void SetEventRange(const ScanRange &r) {m_range_ev = r;};
+    void SetTriggerRange(const ScanRange &r) {m_range_tg = r;};
+    // events with begin >= low and end <= high
+    void SetTimestampRange(const ScanRange &r) {m_range_ts = r;};
+    // events passing the ranges are printed here in file order, if any
+    // range is set
+    void SetPrint(std::ostream *os) {m_os = os;};
+    ScanStatistics Run();
+    uint64_t NumChunks() const {return m_n_chunk;};
+
+    static std::string FileType(const std::string &path);
+  private:
+    struct Chunk;
+    void Process(const EventSPC &ev, ScanStatistics &st, std::ostream *os) const;
+    void ProcessChunk(Chunk &ck) const;
+    ScanStatistics RunSequential();
+
+    std::string m_path;
+    uint32_t m_threads;
+    uint64_t m_chunk_size;
+    bool m_convert;
+    ConfigurationSPC m_conf;
+    ScanRange m_range_ev;
+    ScanRange m_range_tg;
+    ScanRange m_range_ts;
+    std::ostream *m_os;
+    uint64_t m_n_chunk;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_FileScanner
@@ -5,12 +5,50 @@
 #include "eudaq/Serializer.hh"
 #include "eudaq/Status.hh"
 #include "Platform.hh"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace eudaq {
 
   class LogMessage;
 
+  // Token bucket of one EUDAQ_LOG call site. The rate and burst of all call
+  // sites are taken from $EUDAQ_LOG_RATE as "rate[:burst]" messages per
+  // second, 10:100 by default; EUDAQ_LOG_RATE=0 disables the limit. The
+  // number of dropped messages is noted on the next message passed, or in
+  // a summary of the LogSender about once per second.
+  class DLLEXPORT LogRateLimit {
+  public:
+    constexpr LogRateLimit(const char *file, unsigned line, int level)
+        : m_file(file), m_line(line), m_level(level), m_tat(0),
+          m_suppressed(0), m_pending(false) {}
+    // false if the message is to be dropped, otherwise suppressed is the
+    // number of messages dropped since the last one passed
+    bool Pass(uint64_t &suppressed);
+    // messages dropped since the last call, for the summary
+    uint64_t TakeSuppressed();
+    const char *File() const { return m_file; }
+    unsigned Line() const { return m_line; }
+    int Level() const { return m_level; }
+
+  private:
+    const char *m_file;
+    unsigned m_line;
+    int m_level;
+    std::atomic<int64_t> m_tat;
+    std::atomic<uint64_t> m_suppressed;
+    std::atomic<bool> m_pending;
+  };
+
+  // Messages of EUDAQ_LOG are put on a lock-free queue and printed and sent
+  // to the LogCollector by a background thread; the caller only waits for
+  // messages of level ERROR and above, which are out when SendLogMessage
+  // returns. The variant with explicit streams is synchronous.
   class DLLEXPORT LogSender {
   public:
     LogSender();
@@ -19,8 +57,14 @@ namespace eudaq {
                  const std::string &server);
     void Disconnect();
     void SendLogMessage(const LogMessage &);
+    // suppressed messages of the same call site are noted in the text
+    void SendLogMessage(const LogMessage &, uint64_t suppressed);
     void SendLogMessage(const LogMessage &msg, std::ostream &out,
                         std::ostream &error_out);
+    // wait until all messages queued so far are out
+    void Flush();
+    // call site with dropped messages to be summarised
+    void AddSuppressed(LogRateLimit *site);
     void SetLevel(int level) { m_level = level; }
     void SetLevel(const std::string &level) {
       SetLevel(Status::String2Level(level));
@@ -30,17 +74,46 @@ namespace eudaq {
       SetErrLevel(Status::String2Level(level));
     }
     bool IsLogged(const std::string &level) {
-      return Status::String2Level(level) >= m_level;
+      return IsLogged(Status::String2Level(level));
     }
+    bool IsLogged(int level) { return level >= m_level; }
+    // a message of this level would be printed or sent to the LogCollector
+    bool IsActive(int level) { return level >= m_level || m_has_client; }
 
   private:
+    struct Node;
+    void Enqueue(Node *node);
+    void Push(Node *node);
+    Node *Dequeue();
+    void SenderThread();
+    void SendSummaries();
+    void Print(const LogMessage &msg, std::ostream &out,
+               std::ostream &error_out);
+    void Send(const LogMessage &msg, std::ostream &error_out);
+
     std::string m_name;
     TransportClient *m_logclient;
-    int m_level;
-    int m_errlevel;
+    std::atomic<int> m_level;
+    std::atomic<int> m_errlevel;
     bool m_shownotconnected;
     bool isConnected = false;
+    std::atomic<bool> m_has_client;
     std::recursive_mutex m_mutex;
+
+    // intrusive MPSC queue: producers exchange the head, the sender thread
+    // follows the links from the tail
+    std::atomic<Node *> m_head;
+    Node *m_tail;
+    Node *m_stub;
+    std::atomic<uint64_t> m_n_queued;
+    std::atomic<uint64_t> m_n_done;
+    std::atomic<bool> m_exit;
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_queue;
+    std::condition_variable m_wait_done;
+    std::thread m_thread;
+    std::mutex m_suppressed_mutex;
+    std::vector<LogRateLimit *> m_suppressed;
   };
 }
 
@@ -15,10 +15,21 @@ namespace eudaq {
 #define EUDAQ_LOG_CONNECT(type, name, server)                                  \
   ::eudaq::GetLogger().Connect(type, name, server)
 
+// The message is only formatted if its level is printed or a LogCollector
+// is connected, and if the rate limit of the call site lets it pass.
 #define EUDAQ_LOG(level, msg)                                                  \
-  ::eudaq::GetLogger().SendLogMessage(                                         \
-      ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)               \
-          .SetLocation(__FILE__, __LINE__, EUDAQ_FUNC))
+  (::eudaq::GetLogger().IsActive(::eudaq::LogMessage::LVL_##level)             \
+       ? [&](const char *eudaq_log_func) {                                     \
+           static ::eudaq::LogRateLimit eudaq_log_site(                        \
+               __FILE__, __LINE__, ::eudaq::LogMessage::LVL_##level);          \
+           uint64_t eudaq_log_suppressed;                                      \
+           if (eudaq_log_site.Pass(eudaq_log_suppressed))                      \
+             ::eudaq::GetLogger().SendLogMessage(                              \
+                 ::eudaq::LogMessage(msg, ::eudaq::LogMessage::LVL_##level)    \
+                     .SetLocation(__FILE__, __LINE__, eudaq_log_func),         \
+                 eudaq_log_suppressed);                                        \
+         }(EUDAQ_FUNC)                                                         \
+       : (void)0)
 #define EUDAQ_DEBUG(msg) EUDAQ_LOG(DEBUG, msg)
 #define EUDAQ_EXTRA(msg) EUDAQ_LOG(EXTRA, msg)
 #define EUDAQ_INFO(msg) EUDAQ_LOG(INFO, msg)
@@ -0,0 +1,159 @@
+#ifndef EUDAQ_INCLUDED_Metrics
+#define EUDAQ_INCLUDED_Metrics
+
+#include "eudaq/Platform.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace eudaq {
+
+  // Counter split into cache-line sized shards, each thread increments its own
+  // shard so the data path never contends on a single atomic.
+  class DLLEXPORT MetricCounter {
+  public:
+    MetricCounter();
+    void Add(uint64_t n = 1) {
+      m_shards[ShardIndex()].v.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t Get() const;
+    void Reset();
+  private:
+    static const size_t N_SHARDS = 16;
+    struct alignas(64) Shard {
+      std::atomic<uint64_t> v;
+    };
+    static size_t ShardIndex();
+    std::array<Shard, N_SHARDS> m_shards;
+  };
+
+  // Log-linear (HDR-style) histogram of durations in nanoseconds, 16 linear
+  // sub-buckets per power of two, i.e. a relative resolution of ~6%.
+  class DLLEXPORT MetricHistogram {
+  public:
+    MetricHistogram();
+    void Record(uint64_t ns) {
+      m_buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t Count() const;
+    uint64_t Percentile(double q) const;
+    void Snapshot(std::vector<uint64_t> &counts) const;
+    void Reset();
+    static uint64_t Percentile(const std::vector<uint64_t> &counts, double q);
+    static size_t BucketIndex(uint64_t v);
+    static uint64_t BucketValue(size_t i);
+  private:
+    static const size_t N_SUB = 16;
+    static const size_t N_BUCKETS = 64 * N_SUB;
+    std::array<std::atomic<uint64_t>, N_BUCKETS> m_buckets;
+  };
+
+  // Last value of a quantity that is not a rate, e.g. the size of the output
+  // file.
+  class DLLEXPORT MetricGauge {
+  public:
+    MetricGauge():m_v(0){}
+    void Set(int64_t v) {m_v.store(v, std::memory_order_relaxed);}
+    int64_t Get() const {return m_v.load(std::memory_order_relaxed);}
+  private:
+    std::atomic<int64_t> m_v;
+  };
+
+  // One step of the data path (send, receive, deserialize, convert, build,
+  // write, ...): processed events and bytes, per-event latency and the depth
+  // of the queue feeding it.
+  class DLLEXPORT MetricStage {
+  public:
+    MetricStage(const std::string &name);
+    std::string Name() const {return m_name;}
+    void Add(uint64_t bytes, uint64_t ns) {
+      m_events.Add(1);
+      if(bytes)
+	m_bytes.Add(bytes);
+      m_latency.Record(ns);
+    }
+    void SetQueue(int64_t n) {m_queue.store(n, std::memory_order_relaxed);}
+    int64_t Queue() const {return m_queue.load(std::memory_order_relaxed);}
+    MetricCounter &Events() {return m_events;}
+    MetricCounter &Bytes() {return m_bytes;}
+    MetricHistogram &Latency() {return m_latency;}
+    const MetricCounter &Events() const {return m_events;}
+    const MetricCounter &Bytes() const {return m_bytes;}
+    const MetricHistogram &Latency() const {return m_latency;}
+    void Reset();
+  private:
+    std::string m_name;
+    MetricCounter m_events;
+    MetricCounter m_bytes;
+    MetricHistogram m_latency;
+    std::atomic<int64_t> m_queue;
+  };
+
+  // Process-wide registry. Stages and gauges are created once and never removed, so the
+  // returned references can be cached by the components.
+  class DLLEXPORT Metrics {
+  public:
+    static Metrics &Instance();
+    MetricStage &Stage(const std::string &name);
+    std::vector<MetricStage*> Stages();
+    MetricGauge &Gauge(const std::string &name);
+    std::map<std::string, const MetricGauge*> Gauges();
+    void Reset();
+  private:
+    Metrics() = default;
+    std::mutex m_mtx;
+    std::map<std::string, std::unique_ptr<MetricStage>> m_stages;
+    std::map<std::string, std::unique_ptr<MetricGauge>> m_gauges;
+  };
+
+  // Measures the time between construction and destruction (or Stop()).
+  class DLLEXPORT MetricTimer {
+  public:
+    MetricTimer(MetricStage &st, uint64_t bytes = 0)
+      :m_st(&st), m_bytes(bytes), m_tp(std::chrono::steady_clock::now()){}
+    ~MetricTimer(){Stop();}
+    void SetBytes(uint64_t bytes) {m_bytes = bytes;}
+    void Stop(){
+      if(!m_st)
+	return;
+      auto dt = std::chrono::steady_clock::now() - m_tp;
+      m_st->Add(m_bytes, std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+      m_st = nullptr;
+    }
+  private:
+    MetricStage *m_st;
+    uint64_t m_bytes;
+    std::chrono::steady_clock::time_point m_tp;
+  };
+
+  // Turns the registry into rates since the last call. Each stage is reported
+  // as one Status tag "_PERF_<stage>" with the value
+  // "evt/s=<x> MB/s=<y> queue=<n> p99_us=<z>".
+  class DLLEXPORT MetricsPublisher {
+  public:
+    MetricsPublisher();
+    void SetInterval(uint32_t ms) {m_interval = std::chrono::milliseconds(ms);}
+    bool IsDue() const;
+    void Publish(const std::function<void(const std::string&, const std::string&)> &tag);
+    static const std::string TAG_PREFIX;
+  private:
+    struct Last {
+      uint64_t events;
+      uint64_t bytes;
+      std::vector<uint64_t> latency;
+    };
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_tp_last;
+    std::map<std::string, Last> m_last;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_Metrics
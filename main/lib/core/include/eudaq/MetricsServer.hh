@@ -0,0 +1,41 @@
+#ifndef EUDAQ_INCLUDED_MetricsServer
+#define EUDAQ_INCLUDED_MetricsServer
+
+#include "eudaq/Platform.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace eudaq {
+
+  // Minimal HTTP endpoint serving the Metrics registry in OpenMetrics text
+  // format on GET /metrics. Runs on its own thread and only reads the
+  // registry atomics, so the data path is never blocked by a scrape.
+  class DLLEXPORT MetricsServer {
+  public:
+    MetricsServer();
+    ~MetricsServer();
+    // addr is "port" or "host:port", the host defaults to 127.0.0.1
+    void Start(const std::string &addr, const std::string &process);
+    void Stop();
+    bool IsRunning() const {return m_thd.joinable();}
+    std::string Address() const {return m_addr;}
+    uint16_t Port() const {return m_port;}
+    static std::string Render(const std::string &process);
+    static const std::string CONTENT_TYPE;
+  private:
+    void Serve();
+    void Answer(int64_t sock);
+    std::string m_addr;
+    std::string m_process;
+    uint16_t m_port;
+    int64_t m_srvsock;
+    std::atomic<bool> m_stop;
+    std::thread m_thd;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_MetricsServer
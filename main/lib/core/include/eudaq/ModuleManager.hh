@@ -5,22 +5,42 @@
 #include <vector>
 #include <string>
 #include <map>
-
-class ModuleManager;
+#include <set>
+#include <mutex>
 
 namespace eudaq{
-  class ModuleManager{
+  // Modules (libeudaq_module_*) are searched in EUDAQ_MODULE_DIR and next to
+  // the core library when a Factory misses an ID for the first time. A module
+  // with an up to date index file (<module>.idx, written at build time by
+  // euCliModuleIndex) is only loaded when one of the IDs it registers is
+  // requested, modules without index are loaded at once. EUDAQ_MODULE_LOAD_ALL
+  // set to YES loads all modules regardless of their index.
+  class DLLEXPORT ModuleManager{
   public:
     static ModuleManager* Instance();
     static std::string GetModulePath();
+    static std::string GetIndexPath(const std::string& file);
+    // guards the maps of all Factory instances, also held while loading
+    static std::recursive_mutex& FactoryMutex();
+    // called by Factory::Register for every ID
+    static void Registered(uint32_t id);
     ModuleManager(const ModuleManager&) = delete;
     ModuleManager& operator=(const ModuleManager&) = delete;
     uint32_t LoadModuleDir(const std::string& dir);
     bool LoadModuleFile(const std::string& file);
+    bool LoadModuleFor(uint32_t id);
+    void LoadAllModules();
+    bool WriteModuleIndex(const std::string& file);
     void Print(std::ostream& os, size_t offset) const;
   private:
     ModuleManager();
+    void Scan();
+    bool ReadModuleIndex(const std::string& file);
+    std::vector<std::string> m_dirs;
+    bool m_scanned = false;
+    bool m_load_all = false;
     std::map<std::string, void*> m_modules;
+    std::multimap<uint32_t, std::string> m_index;
   };
 }
 
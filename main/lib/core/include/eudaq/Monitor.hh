@@ -55,6 +55,7 @@ namespace eudaq {
   private:
     std::string m_data_addr;
     uint32_t m_evt_c;
+    MetricStage &m_st_mon;
   };
   //----------DOC-MARK-----END*DEC-----DOC-MARK----------
 }
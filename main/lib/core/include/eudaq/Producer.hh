@@ -60,6 +60,7 @@ namespace eudaq {
     uint32_t m_pdc_n;
     std::mutex m_mtx_sender;
     std::map<std::string, std::shared_ptr<DataSender>> m_senders;
+    MetricStage &m_st_prod;
   };
   //----------DOC-MARK-----ENDDECLEAR-----DOC-MARK----------
 }
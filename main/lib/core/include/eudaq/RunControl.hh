@@ -46,6 +46,8 @@ namespace eudaq {
     virtual void ResetSingleConnection(ConnectionSPC id);  
     virtual void Terminate();
     virtual void TerminateSingleConnection(ConnectionSPC id);
+    //each component writes its trace buffers to <prefix><type>.<name>.json
+    void DumpTrace(const std::string &prefix = "");
     
     //run in m_thd_server thread
     virtual void DoConnect(ConnectionSPC con) {}
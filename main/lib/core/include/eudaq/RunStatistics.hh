@@ -0,0 +1,76 @@
+#ifndef EUDAQ_INCLUDED_RunStatistics
+#define EUDAQ_INCLUDED_RunStatistics
+
+#include "eudaq/Platform.hh"
+#include "eudaq/Event.hh"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace eudaq {
+
+  // Statistics of the events written by a DataCollector in one run, updated
+  // per event in constant memory. The sub-events of a built event (or the
+  // event itself if it is not a packet) are grouped into streams by their
+  // description and device number. Per stream: event rate, gaps and steps
+  // back of the trigger number, completeness (share of the written events
+  // holding the stream), mean and peak size, and the drift of its timestamps
+  // against those of the first stream with timestamps, from a streaming
+  // linear regression over the events holding both.
+  class DLLEXPORT RunStatistics {
+  public:
+    RunStatistics();
+    void Reset();
+    void Add(const Event &ev);
+    // One Status tag "_RUNSTAT_<stream>" per stream and "_RUNSTAT" for the
+    // written events, rates are since the last call.
+    void Publish(const std::function<void(const std::string&, const std::string&)> &tag);
+    // Totals of the run, one entry "RUNSTAT_<stream>" per stream and
+    // "RUNSTAT" for the written events.
+    std::map<std::string, std::string> Summary() const;
+    static const std::string TAG_PREFIX;
+  private:
+    struct Stream {
+      std::string name;
+      uint64_t events = 0;
+      uint64_t events_last = 0;
+      uint64_t bytes = 0;
+      uint64_t size_peak = 0;
+      bool has_trigger = false;
+      uint32_t trigger_last = 0;
+      uint64_t trigger_gaps = 0;
+      uint64_t trigger_missing = 0;
+      uint64_t trigger_back = 0;
+      // timestamps against the reference stream, relative to the first pair
+      uint64_t ts_n = 0;
+      uint64_t ts_x0 = 0;
+      uint64_t ts_y0 = 0;
+      double ts_mean_x = 0;
+      double ts_mean_y = 0;
+      double ts_m2_x = 0;
+      double ts_c_xy = 0;
+      int64_t ts_offset = 0;
+    };
+    static uint64_t Size(const Event &ev);
+    void AddStream(const Event &ev, Stream &st, uint64_t size);
+    void AddTimestamp(Stream &st, uint64_t ref, uint64_t ts);
+    std::string Format(const Stream &st, double rate) const;
+
+    mutable std::mutex m_mtx;
+    std::map<uint64_t, Stream> m_streams;
+    bool m_has_ref = false;
+    uint64_t m_ref = 0;
+    uint64_t m_events = 0;
+    uint64_t m_events_last = 0;
+    uint64_t m_bytes = 0;
+    uint64_t m_size_peak = 0;
+    std::chrono::steady_clock::time_point m_tp_first;
+    std::chrono::steady_clock::time_point m_tp_last;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_RunStatistics
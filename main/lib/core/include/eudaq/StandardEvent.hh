@@ -23,6 +23,8 @@ namespace eudaq {
     StandardEvent(Deserializer &);
 
     StandardPlane &AddPlane(const StandardPlane &);
+    // takes over the pixel vectors of a finished plane without copying
+    StandardPlane &AddPlane(StandardPlane &&);
     size_t NumPlanes() const;
     const StandardPlane &GetPlane(size_t i) const;
     StandardPlane &GetPlane(size_t i);
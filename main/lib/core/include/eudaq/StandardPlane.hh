@@ -7,6 +7,7 @@
 #include "eudaq/Utils.hh"
 #include "eudaq/Platform.hh"
 
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -60,10 +61,32 @@ namespace eudaq {
       PushPixelHelper(x, y, (double)pix, 0, false, frame);
     }
 
+    // Bulk construction for converters: Reserve the expected number of
+    // pixels once, then append them in spans with PushPixels (time_ps may
+    // be null for untimed pixels, pivot may be null for pivot false)
+    void Reserve(uint32_t npix, uint32_t frame = 0);
+    template <typename X, typename Y, typename P>
+      void PushPixels(size_t n, const X *x, const Y *y, const P *pix,
+		      const uint64_t *time_ps = nullptr, uint32_t frame = 0,
+		      const uint8_t *pivot = nullptr) {
+      PushPixelsHelper(n, frame);
+      m_x[frame].insert(m_x[frame].end(), x, x + n);
+      m_y[frame].insert(m_y[frame].end(), y, y + n);
+      m_pix[frame].insert(m_pix[frame].end(), pix, pix + n);
+      if (time_ps)
+	m_time[frame].insert(m_time[frame].end(), time_ps, time_ps + n);
+      else
+	m_time[frame].resize(m_time[frame].size() + n);
+      if (pivot && frame < m_pivot.size())
+	std::copy(pivot, pivot + n, m_pivot[frame].end() - n);
+    }
+
     void SetPixelHelper(uint32_t index, uint32_t x, uint32_t y, double pix, uint64_t time_ps,
                         bool pivot, uint32_t frame);
     void PushPixelHelper(uint32_t x, uint32_t y, double pix, uint64_t time_ps, bool pivot,
                          uint32_t frame);
+    // grows the per-pixel vectors other than x, y, pix and time by n
+    void PushPixelsHelper(size_t n, uint32_t frame);
     double GetPixel(uint32_t index, uint32_t frame) const;
     double GetPixel(uint32_t index) const;
     double GetX(uint32_t index, uint32_t frame) const;
@@ -79,6 +102,9 @@ namespace eudaq {
     bool HasPixelAuxInfo(uint32_t index) const;
 
     void SetWaveform(uint32_t index, std::vector<double> waveform, double x0, double dx, uint32_t frame = 0);
+    // The pixel shares the waveform of the pixel source (e.g. several pixels
+    // bonded to one digitizer channel), the samples are stored only once
+    void SetWaveformReference(uint32_t index, uint32_t source, uint32_t frame = 0);
     bool HasWaveform(uint32_t index, uint32_t frame) const;
     bool HasWaveform(uint32_t index) const;
     std::vector<double> GetWaveform(uint32_t index, uint32_t frame) const;
@@ -135,9 +161,24 @@ namespace eudaq {
     void Print(std::ostream &) const;
     void Print(std::ostream &os ,size_t offset) const;
   private:
+    // Pointer into the plane itself, reset rather than carried over when the
+    // plane is copied or moved
+    template <typename T> class ResultPtr {
+    public:
+      ResultPtr(T *p = nullptr) : m_p(p) {}
+      ResultPtr(const ResultPtr &) noexcept : m_p(nullptr) {}
+      ResultPtr &operator=(const ResultPtr &) noexcept { m_p = nullptr; return *this; }
+      ResultPtr &operator=(T *p) { m_p = p; return *this; }
+      operator T *() const { return m_p; }
+      T *operator->() const { return m_p; }
+    private:
+      T *m_p;
+    };
+
     const std::vector<pixel_t> &
       GetFrame(const std::vector<std::vector<pixel_t>> &v, uint32_t f) const;
     void SetupResult() const;
+    uint32_t WaveformIndex(uint32_t index, uint32_t frame) const;
 
     std::string m_type;
     std::string m_sensor;
@@ -153,19 +194,23 @@ namespace eudaq {
     std::vector<std::vector<std::vector<double>>> m_waveform;
     std::vector<std::vector<double>> m_waveform_x0;
     std::vector<std::vector<double>> m_waveform_dx;
+    // per frame, the pixel holding the waveform of each pixel; empty unless
+    // SetWaveformReference was used
+    std::vector<std::vector<uint32_t>> m_waveform_src;
     std::vector<std::vector<std::string> > m_auxinfo;
     std::vector<std::vector<coord_t>> m_x, m_y;
     std::vector<std::vector<uint64_t>> m_time;
     std::vector<std::vector<bool>> m_pivot;
     std::vector<uint32_t> m_mat;
 
-    mutable const std::vector<pixel_t> *m_result_pix;
-    mutable const std::vector<coord_t> *m_result_x, *m_result_y;
-    mutable const std::vector<uint64_t> *m_result_time;
-    mutable const std::vector<std::vector<double>> *m_result_waveform;
-    mutable const std::vector<double> *m_result_waveform_x0;
-    mutable const std::vector<double> *m_result_waveform_dx;
-    mutable const std::vector<std::string> * m_result_auxinfo;
+    mutable ResultPtr<const std::vector<pixel_t>> m_result_pix;
+    mutable ResultPtr<const std::vector<coord_t>> m_result_x, m_result_y;
+    mutable ResultPtr<const std::vector<uint64_t>> m_result_time;
+    mutable ResultPtr<const std::vector<std::vector<double>>> m_result_waveform;
+    mutable ResultPtr<const std::vector<uint32_t>> m_result_waveform_src;
+    mutable ResultPtr<const std::vector<double>> m_result_waveform_x0;
+    mutable ResultPtr<const std::vector<double>> m_result_waveform_dx;
+    mutable ResultPtr<const std::vector<std::string>> m_result_auxinfo;
 
     mutable std::vector<pixel_t> m_temp_pix;
     mutable std::vector<coord_t> m_temp_x, m_temp_y;
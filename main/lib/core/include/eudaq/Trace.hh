@@ -0,0 +1,119 @@
+#ifndef EUDAQ_INCLUDED_Trace
+#define EUDAQ_INCLUDED_Trace
+
+#include "eudaq/Platform.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped trace points of the data path. They are compiled in only when the
+// tree is configured with -DEUDAQ_TRACING=ON, otherwise all macros below are
+// empty. Every thread writes into its own ring buffer, the last records of
+// all threads are written as Chrome trace JSON (chrome://tracing, Perfetto)
+// by Trace::Dump(), on the TRACE command of the RunControl or on SIGUSR1.
+//
+//   EUDAQ_TRACE_SCOPE("DataCollector::WriteEvent");
+//   EUDAQ_TRACE_FLOW_STEP("write", eudaq::Trace::FlowId(dev, run, evn));
+#ifdef EUDAQ_TRACING
+#define EUDAQ_TRACE_CAT_(a, b) a##b
+#define EUDAQ_TRACE_CAT(a, b) EUDAQ_TRACE_CAT_(a, b)
+#define EUDAQ_TRACE_SCOPE(name) eudaq::TraceScope EUDAQ_TRACE_CAT(eudaq_trace_scope_, __LINE__)(name)
+#define EUDAQ_TRACE_FLOW_BEGIN(name, id) eudaq::Trace::Instance().Flow(name, 's', id)
+#define EUDAQ_TRACE_FLOW_STEP(name, id) eudaq::Trace::Instance().Flow(name, 't', id)
+#define EUDAQ_TRACE_FLOW_END(name, id) eudaq::Trace::Instance().Flow(name, 'f', id)
+#define EUDAQ_TRACE_THREAD(name) eudaq::Trace::Instance().SetThreadName(name)
+#else
+#define EUDAQ_TRACE_SCOPE(name) do{}while(0)
+#define EUDAQ_TRACE_FLOW_BEGIN(name, id) do{}while(0)
+#define EUDAQ_TRACE_FLOW_STEP(name, id) do{}while(0)
+#define EUDAQ_TRACE_FLOW_END(name, id) do{}while(0)
+#define EUDAQ_TRACE_THREAD(name) do{}while(0)
+#endif
+
+namespace eudaq {
+
+  // Names must be string literals (or outlive the process), only the
+  // pointer is stored.
+  struct TraceRecord {
+    const char *name;
+    uint64_t ts;
+    uint64_t dur;
+    uint64_t id;
+    char ph;
+  };
+
+  // Single writer ring buffer, owned by one thread.
+  class DLLEXPORT TraceRing {
+  public:
+    TraceRing(size_t capacity, uint32_t tid);
+    void Push(const TraceRecord &r){
+      uint64_t h = m_head.load(std::memory_order_relaxed);
+      m_rec[h % m_rec.size()] = r;
+      m_head.store(h + 1, std::memory_order_release);
+    }
+    // copies the records which are not being overwritten while reading
+    void Snapshot(std::vector<TraceRecord> &out) const;
+    uint32_t Tid() const {return m_tid;}
+    size_t Capacity() const {return m_rec.size();}
+    std::string Name() const;
+    void SetName(const std::string &name);
+  private:
+    std::vector<TraceRecord> m_rec;
+    std::atomic<uint64_t> m_head;
+    uint32_t m_tid;
+    mutable std::mutex m_mtx_name;
+    std::string m_name;
+  };
+
+  class DLLEXPORT Trace {
+  public:
+    static Trace &Instance();
+    // nanoseconds since the start of the process
+    static uint64_t Now();
+    // identifies one producer event along the whole data path
+    static uint64_t FlowId(uint32_t device, uint32_t run, uint32_t event);
+
+    void Complete(const char *name, uint64_t ts, uint64_t dur){
+      Ring().Push(TraceRecord{name, ts, dur, 0, 'X'});
+    }
+    void Flow(const char *name, char ph, uint64_t id){
+      Ring().Push(TraceRecord{name, Now(), 0, id, ph});
+    }
+    void SetThreadName(const std::string &name){Ring().SetName(name);}
+    // records per thread, applies to threads which did not trace yet
+    void SetCapacity(size_t n);
+    void Dump(const std::string &path);
+
+    // SIGUSR1 only raises a flag, DumpIfRequested() does the writing
+    static void InstallSignalHandler();
+    bool DumpIfRequested(const std::string &path);
+  private:
+    Trace();
+    TraceRing &Ring();
+    // the ring of an exited thread is reused by the next new thread, keeping
+    // its tid and its last records until they are overwritten
+    std::shared_ptr<TraceRing> Acquire();
+    void Release(std::shared_ptr<TraceRing> ring);
+    std::mutex m_mtx;
+    std::vector<std::shared_ptr<TraceRing>> m_rings;
+    std::vector<std::shared_ptr<TraceRing>> m_free;
+    size_t m_capacity;
+    uint32_t m_next_tid;
+  };
+
+  class DLLEXPORT TraceScope {
+  public:
+    explicit TraceScope(const char *name):m_name(name), m_ts(Trace::Now()){}
+    ~TraceScope(){Trace::Instance().Complete(m_name, m_ts, Trace::Now() - m_ts);}
+  private:
+    const char *m_name;
+    uint64_t m_ts;
+  };
+
+}
+
+#endif // EUDAQ_INCLUDED_Trace
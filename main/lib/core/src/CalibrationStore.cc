@@ -0,0 +1,260 @@
+#include "eudaq/CalibrationStore.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace eudaq {
+
+  namespace{
+    const char CACHE_MAGIC[8] = {'E', 'U', 'C', 'A', 'L', 'I', 'B', '\0'};
+    const uint32_t CACHE_FORMAT = 1;
+
+    // followed by the key padded to 8 bytes and the rows x columns floats
+    struct CacheHeader {
+      char magic[8];
+      uint32_t format;
+      uint32_t version;
+      int64_t mtime;
+      uint64_t size;
+      uint32_t rows;
+      uint32_t columns;
+      uint32_t key_length;
+      uint32_t reserved;
+    };
+
+    size_t DataOffset(size_t key_length){
+      return (sizeof(CacheHeader) + key_length + 7) / 8 * 8;
+    }
+
+    uint64_t Fnv1a(const std::string &s){
+      uint64_t h = 14695981039346656037ULL;
+      for(unsigned char c: s){
+	h ^= c;
+	h *= 1099511628211ULL;
+      }
+      return h;
+    }
+
+    // the same file reached through different relative paths shares a cache
+    std::string AbsolutePath(const std::string &path){
+#ifdef _WIN32
+      char *abs = _fullpath(nullptr, path.c_str(), 0);
+#else
+      char *abs = realpath(path.c_str(), nullptr);
+#endif
+      if(!abs)
+	return path;
+      std::string s(abs);
+      std::free(abs);
+      return s;
+    }
+
+    // nanoseconds where the platform has them, a rewrite within the same
+    // second would otherwise keep a stale cache
+    int64_t ModificationTime(const struct stat &st){
+#if defined(__APPLE__)
+      return int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+      return int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+      return int64_t(st.st_mtime) * 1000000000;
+#endif
+    }
+
+    bool MakeDirectory(const std::string &dir){
+      for(size_t p = dir.find_first_of("/\\", 1); ; p = dir.find_first_of("/\\", p + 1)){
+	std::string sub = dir.substr(0, p);
+#ifdef _WIN32
+	_mkdir(sub.c_str());
+#else
+	mkdir(sub.c_str(), 0755);
+#endif
+	if(p == std::string::npos)
+	  break;
+      }
+      struct stat st;
+      return stat(dir.c_str(), &st) == 0 && (st.st_mode & S_IFDIR);
+    }
+
+    bool CheckHeader(const CacheHeader &h, uint32_t version, const struct stat &src,
+		     const std::string &key, const char *key_stored, uint64_t file_size){
+      return std::memcmp(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+	&& h.format == CACHE_FORMAT && h.version == version
+	&& h.mtime == ModificationTime(src) && h.size == uint64_t(src.st_size)
+	&& h.key_length == key.size()
+	&& file_size == DataOffset(key.size()) + uint64_t(h.rows) * h.columns * sizeof(float)
+	&& std::memcmp(key_stored, key.data(), key.size()) == 0;
+    }
+
+#ifdef _WIN32
+    CalibrationTable MapCache(const std::string &cache, uint32_t version,
+			      const struct stat &src, const std::string &key){
+      std::ifstream f(cache, std::ios::binary | std::ios::ate);
+      if(!f)
+	return CalibrationTable();
+      auto buf = std::make_shared<std::vector<char>>(size_t(f.tellg()));
+      f.seekg(0);
+      if(buf->size() < DataOffset(key.size()) || !f.read(buf->data(), buf->size()))
+	return CalibrationTable();
+      CacheHeader h;
+      std::memcpy(&h, buf->data(), sizeof(h));
+      if(!CheckHeader(h, version, src, key, buf->data() + sizeof(h), buf->size()))
+	return CalibrationTable();
+      const float *data = reinterpret_cast<const float*>(buf->data() + DataOffset(key.size()));
+      return CalibrationTable(h.rows, h.columns, buf, data);
+    }
+#else
+    struct Mapping {
+      void *addr;
+      size_t length;
+      ~Mapping(){munmap(addr, length);}
+    };
+
+    CalibrationTable MapCache(const std::string &cache, uint32_t version,
+			      const struct stat &src, const std::string &key){
+      int fd = open(cache.c_str(), O_RDONLY);
+      if(fd < 0)
+	return CalibrationTable();
+      struct stat st;
+      if(fstat(fd, &st) != 0 || size_t(st.st_size) < DataOffset(key.size())){
+	close(fd);
+	return CalibrationTable();
+      }
+      void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if(addr == MAP_FAILED)
+	return CalibrationTable();
+      auto map = std::make_shared<Mapping>();
+      map->addr = addr;
+      map->length = st.st_size;
+      const char *base = static_cast<const char*>(addr);
+      CacheHeader h;
+      std::memcpy(&h, base, sizeof(h));
+      if(!CheckHeader(h, version, src, key, base + sizeof(h), st.st_size))
+	return CalibrationTable();
+      const float *data = reinterpret_cast<const float*>(base + DataOffset(key.size()));
+      return CalibrationTable(h.rows, h.columns, map, data);
+    }
+#endif
+
+    // written to a temporary file and renamed, so that concurrent jobs never
+    // map a partial cache
+    bool WriteCache(const std::string &cache, uint32_t version, const struct stat &src,
+		    const std::string &key, const CalibrationTable &table){
+      CacheHeader h = {};
+      std::memcpy(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+      h.format = CACHE_FORMAT;
+      h.version = version;
+      h.mtime = ModificationTime(src);
+      h.size = src.st_size;
+      h.rows = table.Rows();
+      h.columns = table.Columns();
+      h.key_length = key.size();
+      std::ostringstream tmp;
+      tmp << cache << "." << std::hash<std::thread::id>()(std::this_thread::get_id())
+	  << "." << std::chrono::steady_clock::now().time_since_epoch().count() << ".tmp";
+      {
+	std::ofstream f(tmp.str(), std::ios::binary);
+	if(!f)
+	  return false;
+	std::vector<char> pad(DataOffset(key.size()) - sizeof(h) - key.size(), 0);
+	f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	f.write(key.data(), key.size());
+	f.write(pad.data(), pad.size());
+	f.write(reinterpret_cast<const char*>(table.Data()),
+		sizeof(float) * size_t(table.Rows()) * table.Columns());
+	if(!f){
+	  f.close();
+	  std::remove(tmp.str().c_str());
+	  return false;
+	}
+      }
+#ifdef _WIN32
+      std::remove(cache.c_str());
+#endif
+      if(std::rename(tmp.str().c_str(), cache.c_str()) != 0){
+	std::remove(tmp.str().c_str());
+	return false;
+      }
+      return true;
+    }
+  }
+
+  CalibrationTable::CalibrationTable()
+    :m_data(nullptr), m_rows(0), m_columns(0){
+  }
+
+  CalibrationTable::CalibrationTable(uint32_t columns, std::vector<float> &&data)
+    :m_data(nullptr), m_rows(0), m_columns(columns){
+    if(columns && data.size() % columns)
+      EUDAQ_THROW("CalibrationTable: " + std::to_string(data.size()) +
+		  " values do not fill rows of " + std::to_string(columns));
+    auto vec = std::make_shared<std::vector<float>>(std::move(data));
+    m_rows = columns ? vec->size() / columns : 0;
+    m_data = vec->data();
+    m_hold = vec;
+  }
+
+  CalibrationTable::CalibrationTable(uint32_t rows, uint32_t columns,
+				     std::shared_ptr<const void> hold, const float *data)
+    :m_hold(hold), m_data(data), m_rows(rows), m_columns(columns){
+  }
+
+  std::string CalibrationStore::CacheDirectory(){
+    const char *env = std::getenv("EUDAQ_CALIBRATION_CACHE");
+    if(env)
+      return env;
+    env = std::getenv("XDG_CACHE_HOME");
+    if(env && *env)
+      return std::string(env) + "/eudaq";
+    env = std::getenv("HOME");
+    if(env && *env)
+      return std::string(env) + "/.cache/eudaq";
+    return "";
+  }
+
+  CalibrationTable CalibrationStore::Load(const std::string &path, const std::string &kind,
+					  uint32_t version, const Parser &parse){
+    std::string dir = CacheDirectory();
+    struct stat src;
+    // missing sources are left to the parser to report
+    if(dir.empty() || dir == "none" || stat(path.c_str(), &src) != 0)
+      return parse(path);
+
+    std::string key = AbsolutePath(path) + "\n" + kind;
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.ecal", (unsigned long long)Fnv1a(key));
+    std::string cache = dir + "/" + name;
+    CalibrationTable table = MapCache(cache, version, src, key);
+    if(!table.Empty())
+      return table;
+
+    table = parse(path);
+    if(table.Empty() || !MakeDirectory(dir) || !WriteCache(cache, version, src, key, table)){
+      if(!table.Empty())
+	EUDAQ_WARN("CalibrationStore: unable to write the cache of " + path + " to " + dir);
+      return table;
+    }
+    // the page cache copy is then shared with the next processes
+    CalibrationTable mapped = MapCache(cache, version, src, key);
+    return mapped.Empty() ? table : mapped;
+  }
+
+}
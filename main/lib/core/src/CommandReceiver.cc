@@ -5,6 +5,7 @@
 #include "eudaq/Logger.hh"
 #include "eudaq/Utils.hh"
 #include "eudaq/CommandReceiver.hh"
+#include "eudaq/Trace.hh"
 #include <iostream>
 #include <ostream>
 
@@ -21,6 +22,9 @@ namespace eudaq {
   CommandReceiver::CommandReceiver(const std::string & type, const std::string & name,
 				   const std::string & runcontrol)
     : m_type(type), m_name(name), m_is_destructing(false), m_is_connected(false), m_is_runlooping(false), m_addr_runctrl(runcontrol){
+#ifdef EUDAQ_TRACING
+    Trace::InstallSignalHandler();
+#endif
   }
 
   CommandReceiver::~CommandReceiver(){
@@ -169,6 +173,25 @@ namespace eudaq {
     return m_type+"."+m_name;
   }
 
+  void CommandReceiver::DumpTrace(const std::string &prefix, bool on_signal){
+#ifdef EUDAQ_TRACING
+    std::string path = (prefix.empty() ? "eudaq_trace_" : prefix) + GetFullName() + ".json";
+    try{
+      if(on_signal)
+	Trace::Instance().DumpIfRequested(path);
+      else
+	Trace::Instance().Dump(path);
+    }
+    catch(const Exception &e){
+      EUDAQ_WARN(std::string("Unable to write the trace: ") + e.what());
+    }
+#else
+    (void)prefix;
+    if(!on_signal)
+      EUDAQ_WARN("Trace requested, but EUDAQ was built without EUDAQ_TRACING");
+#endif
+  }
+
   std::string CommandReceiver::GetName() const {
     return m_name;
   }
@@ -264,6 +287,7 @@ namespace eudaq {
 	  if(!m_is_connected){
 	    return 0;
 	  }
+	  DumpTrace("", true);
 	}
       }
       auto cmd = m_qu_cmd.front().first;
@@ -275,6 +299,18 @@ namespace eudaq {
         if(m_name != "")
           section += "." + m_name;
 	m_conf_init = std::make_shared<Configuration>(param, section);
+	m_metrics.SetInterval(m_conf_init->Get("EUDAQ_METRICS_INTERVAL_MS", 1000));
+	std::string http = m_conf_init->Get("EUDAQ_METRICS_HTTP", "");
+	if(http.empty())
+	  m_metrics_http.Stop();
+	else{
+	  try{
+	    m_metrics_http.Start(http, GetFullName());
+	  }
+	  catch(const Exception &e){
+	    EUDAQ_WARN(std::string("Metrics endpoint not available: ") + e.what());
+	  }
+	}
 	std::stringstream ss;
 	m_conf_init->Print(ss, 4);
 	EUDAQ_INFO("Receive an INI section\n"+ ss.str());
@@ -300,6 +336,12 @@ namespace eudaq {
         OnReset();
       } else if (cmd == "STATUS") {
         OnStatus();
+	if(m_metrics.IsDue())
+	  m_metrics.Publish([this](const std::string &key, const std::string &val){
+	      SetStatusTag(key, val);});
+	DumpTrace("", true);
+      } else if (cmd == "TRACE") {
+	DumpTrace(param, false);
       } else if (cmd == "LOG") {
         OnLog(param);
       } else {
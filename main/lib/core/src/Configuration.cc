@@ -1,6 +1,8 @@
 #include "eudaq/Configuration.hh"
 #include "eudaq/Platform.hh"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <cstdlib>
@@ -76,6 +78,7 @@ namespace eudaq {
   Configuration &Configuration::operator=(const Configuration &other) {
     m_config = other.m_config;
     SetSection(other.m_section);
+    std::atomic_store(&m_snapshot, ConfigurationSectionSPC());
     return *this;
   }
 
@@ -124,6 +127,7 @@ namespace eudaq {
             }
         }
     }
+    std::atomic_store(&m_snapshot, ConfigurationSectionSPC());
   }
 
   bool Configuration::SetSection(const std::string &section) const {
@@ -132,15 +136,36 @@ namespace eudaq {
       return false;
     m_section = section;
     m_cur = const_cast<section_t *>(&i->second);
+    std::atomic_store(&m_snapshot, ConfigurationSectionSPC());
     return true;
   }
 
   bool Configuration::SetSection(const std::string &section) {
     m_section = section;
     m_cur = &m_config[section];
+    std::atomic_store(&m_snapshot, ConfigurationSectionSPC());
     return true;
   }
 
+  ConfigurationSectionSPC Configuration::Section() const {
+    ConfigurationSectionSPC sec = std::atomic_load(&m_snapshot);
+    if(!sec){
+      // made twice at worst by concurrent readers, both are equal
+      sec.reset(new ConfigurationSection(m_section, *m_cur));
+      std::atomic_store(&m_snapshot, sec);
+    }
+    return sec;
+  }
+
+  ConfigurationSectionSPC Configuration::Section(const std::string &section) const {
+    if(section == m_section)
+      return Section();
+    map_t::const_iterator i = m_config.find(section);
+    if(i == m_config.end())
+      return ConfigurationSectionSPC(new ConfigurationSection(section, section_t()));
+    return ConfigurationSectionSPC(new ConfigurationSection(section, i->second));
+  }
+
   std::string Configuration::Get(const std::string &key,
                                  const std::string &def) const {
     std::string retval(def);
@@ -235,5 +260,96 @@ namespace eudaq {
   void Configuration::SetString(const std::string &key,
                                 const std::string &val) {
     (*m_cur)[key] = val;
+    std::atomic_store(&m_snapshot, ConfigurationSectionSPC());
+  }
+
+  ConfigurationSection::ConfigurationSection(const std::string &name,
+                                             const std::map<std::string, std::string> &section)
+    : m_name(name) {
+    m_entries.reserve(section.size());
+    for(auto &kv: section){
+      Entry e;
+      e.hash = str2hash(kv.first);
+      e.key = kv.first;
+      e.value = kv.second;
+      // parsed as the Get overloads of Configuration do
+      e.i64 = std::strtoll(e.value.c_str(), 0, 0);
+      e.u64 = std::strtoull(e.value.c_str(), 0, 0);
+      e.l = std::strtol(e.value.c_str(), 0, 0);
+      e.d = 0;
+      e.f = 0;
+      e.d_ok = false;
+      e.f_ok = false;
+      if(!e.value.empty()){
+        try{
+          e.d = from_string(e.value, 0.);
+          e.d_ok = true;
+        }
+        catch(const std::exception&){
+        }
+        try{
+          e.f = from_string(e.value, 0.f);
+          e.f_ok = true;
+        }
+        catch(const std::exception&){
+        }
+      }
+      m_entries.push_back(std::move(e));
+    }
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry &a, const Entry &b){return a.hash < b.hash;});
+  }
+
+  const ConfigurationSection::Entry *ConfigurationSection::Find(const Key &key) const {
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), key.hash,
+                               [](const Entry &e, uint32_t h){return e.hash < h;});
+    for(; it != m_entries.end() && it->hash == key.hash; ++it){
+      if(it->key == key.name)
+        return &*it;
+    }
+    return nullptr;
+  }
+
+  std::vector<std::string> ConfigurationSection::Keylist() const {
+    std::vector<std::string> keys;
+    for(auto &e: m_entries)
+      keys.push_back(e.key);
+    std::sort(keys.begin(), keys.end());
+    return keys;
+  }
+
+  std::string ConfigurationSection::Get(const Key &key, const std::string &def) const {
+    const Entry *e = Find(key);
+    return e ? e->value : def;
+  }
+
+  float ConfigurationSection::Get(const Key &key, float def) const {
+    const Entry *e = Find(key);
+    if(!e || e->value.empty())
+      return def;
+    // an invalid number throws as in Configuration
+    return e->f_ok ? e->f : from_string(e->value, def);
+  }
+
+  double ConfigurationSection::Get(const Key &key, double def) const {
+    const Entry *e = Find(key);
+    if(!e || e->value.empty())
+      return def;
+    return e->d_ok ? e->d : from_string(e->value, def);
+  }
+
+  int64_t ConfigurationSection::Get(const Key &key, int64_t def) const {
+    const Entry *e = Find(key);
+    return e ? e->i64 : def;
+  }
+
+  uint64_t ConfigurationSection::Get(const Key &key, uint64_t def) const {
+    const Entry *e = Find(key);
+    return e ? e->u64 : def;
+  }
+
+  int ConfigurationSection::Get(const Key &key, int def) const {
+    const Entry *e = Find(key);
+    return e ? e->l : def;
   }
 }
@@ -1,5 +1,6 @@
 #include "eudaq/DataCollector.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/Trace.hh"
 #include "eudaq/Utils.hh"
 #include <iostream>
 #include <ostream>
@@ -12,10 +13,14 @@ namespace eudaq {
   Factory<DataCollector>::Instance<const std::string&, const std::string&>(); //TODO
   
   DataCollector::DataCollector(const std::string &name, const std::string &runcontrol)
-    :CommandReceiver("DataCollector", name, runcontrol){
+    :CommandReceiver("DataCollector", name, runcontrol),
+     m_st_build(Metrics::Instance().Stage("build")),
+     m_st_write(Metrics::Instance().Stage("write")),
+     m_g_file_bytes(Metrics::Instance().Gauge("file_bytes")){
     m_dct_n= str2hash(GetFullName());
     m_evt_c = 0;
     m_fraction = 1;
+    m_stat_enabled = true;
   }
 
   DataCollector::~DataCollector(){  
@@ -81,6 +86,7 @@ namespace eudaq {
       m_fwpatt = conf->Get("EUDAQ_FW_PATTERN", "$12D_run$6R$X");
       m_dct_n = conf->Get("EUDAQ_ID", m_dct_n);
       m_fraction = conf->Get("EUDAQ_DATACOL_SEND_MONITOR_FRACTION", 10);
+      m_stat_enabled = conf->Get("EUDAQ_DATACOL_RUN_STATISTICS", 1) != 0;
       DoConfigure();
       CommandReceiver::OnConfigure();
     }catch (const Exception &e) {
@@ -96,7 +102,10 @@ namespace eudaq {
       m_data_addr = Listen(m_data_addr);
       SetStatusTag("_SERVER", m_data_addr);
       m_writer = Factory<FileWriter>::Create<std::string&>(str2hash(m_fwtype), m_fwpatt);
+      if(m_writer)
+	m_writer->SetConfiguration(GetConfiguration());
       m_evt_c = 0;
+      m_stat.Reset();
 
       std::string mn_str = GetConfiguration()->Get("EUDAQ_MN", "");
       std::vector<std::string> col_mn_name = split(mn_str, ";,", true);
@@ -130,6 +139,7 @@ namespace eudaq {
       m_senders.clear();
       lk.unlock();
       StopListen();
+      WriteRunStatistics();
       CommandReceiver::OnStopRun();
     } catch (const Exception &e) {
       std::string msg = "Error stopping for run " + std::to_string(GetRunNumber()) + ": " + e.what();
@@ -165,6 +175,9 @@ namespace eudaq {
   void DataCollector::OnStatus(){
     SetStatusTag("EventN", std::to_string(m_evt_c));
     SetStatusTag("MonitorEventN", std::to_string(float(m_evt_c/m_fraction)));
+    if(m_stat_enabled)
+      m_stat.Publish([this](const std::string &key, const std::string &val){
+	  SetStatusTag(key, val);});
     DoStatus();
     // if(m_writer && m_writer->FileBytes()){
     //   SetStatusTag("FILEBYTES", std::to_string(m_writer->FileBytes()));
@@ -180,6 +193,9 @@ namespace eudaq {
   }
     
   void DataCollector::OnReceive(ConnectionSPC id, EventSP ev){
+    MetricTimer timer(m_st_build);
+    EUDAQ_TRACE_SCOPE("DataCollector::DoReceive");
+    EUDAQ_TRACE_FLOW_STEP("build", Trace::FlowId(ev->GetDeviceN(), ev->GetRunN(), ev->GetEventN()));
     DoReceive(id, ev);
   }  
     
@@ -196,9 +212,26 @@ namespace eudaq {
       ev->SetEventN(m_evt_c);
       m_evt_c ++;
       ev->SetStreamN(m_dct_n);
+      if(m_stat_enabled && !ev->IsEORE())
+	m_stat.Add(*ev);
       auto file_writer = m_writer;
-      if(file_writer)
+      if(file_writer){
+	MetricTimer timer(m_st_write);
+	EUDAQ_TRACE_SCOPE("FileWriter::WriteEvent");
+#ifdef EUDAQ_TRACING
+	if(ev->GetNumSubEvent()){
+	  for(auto &sub: ev->GetSubEvents())
+	    EUDAQ_TRACE_FLOW_END("write", Trace::FlowId(sub->GetDeviceN(), sub->GetRunN(), sub->GetEventN()));
+	}
+	else
+	  EUDAQ_TRACE_FLOW_END("write", Trace::FlowId(ev->GetDeviceN(), ev->GetRunN(), ev->GetEventN()));
+#endif
+	uint64_t bytes_before = file_writer->FileBytes();
 	file_writer->WriteEvent(ev);
+	uint64_t bytes_after = file_writer->FileBytes();
+	timer.SetBytes(bytes_after > bytes_before ? bytes_after - bytes_before : 0);
+	m_g_file_bytes.Set(bytes_after);
+      }
       else
 	EUDAQ_THROW("FileWriter is not created before writing.");
       std::unique_lock<std::mutex> lk(m_mtx_sender);
@@ -207,6 +240,7 @@ namespace eudaq {
       if(m_evt_c%m_fraction != 0 && m_evt_c!=1){
 	return;
       }
+      EUDAQ_TRACE_SCOPE("DataCollector::SendMonitor");
       for(auto &e: senders){
 	if(e.second)
 	  e.second->SendEvent(ev);
@@ -221,6 +255,26 @@ namespace eudaq {
     }
   }
 
+  void DataCollector::WriteRunStatistics(){
+    if(!m_stat_enabled || !m_writer)
+      return;
+    auto summary = m_stat.Summary();
+    if(summary.empty())
+      return;
+    // the last record of the run, after the data events; fake, so that the
+    // converters skip it
+    auto ev = Event::MakeShared("RunStatistics");
+    ev->SetEORE();
+    ev->SetFlagFake();
+    std::string msg = "RUN #" + std::to_string(GetRunNumber()) + " statistics:";
+    for(auto &e: summary){
+      ev->SetTag(e.first, e.second);
+      msg += "\n  " + e.first + ": " + e.second;
+    }
+    EUDAQ_INFO(msg);
+    WriteEvent(ev);
+  }
+
   DataCollectorSP DataCollector::Make(const std::string &code_name,
 				      const std::string &run_name,
 				      const std::string &runcontrol){
@@ -2,6 +2,7 @@
 #include "eudaq/TransportServer.hh"
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/Trace.hh"
 #include "eudaq/Utils.hh"
 #include <iostream>
 #include <ostream>
@@ -10,7 +11,9 @@
 namespace eudaq {
   
   DataReceiver::DataReceiver()
-    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"){
+    :m_is_listening(false),m_is_destructing(false), m_last_addr("tcp://0"),
+     m_st_rcv(Metrics::Instance().Stage("receive")),
+     m_st_des(Metrics::Instance().Stage("deserialize")){
   }
 
   DataReceiver::~DataReceiver(){
@@ -44,6 +47,7 @@ namespace eudaq {
 	  m_vt_con.erase(m_vt_con.begin() + i);
 	  std::unique_lock<std::mutex> lk(m_mx_qu_ev);
 	  m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
+	  m_qu_tp.push(std::chrono::steady_clock::now());
 	  m_cv_not_empty.notify_all();
 	  has_con_for_discon = true;
 	}
@@ -89,20 +93,30 @@ namespace eudaq {
 	m_vt_con.push_back(con);
 	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
 	m_qu_ev.push(std::make_pair<EventSP, ConnectionSPC>(nullptr, con));
+	m_qu_tp.push(std::chrono::steady_clock::now());
 	m_cv_not_empty.notify_all();
       }
       else{ //identified connection  
+	MetricTimer timer(m_st_des, ev.packet.size());
+	EUDAQ_TRACE_SCOPE("DataReceiver::Deserialize");
 	BufferSerializer ser(ev.packet.begin(), ev.packet.end());
 	uint32_t id;
 	ser.PreRead(id);
 	auto ev_con = std::make_pair<EventSP, ConnectionSPC>
 	  (Factory<Event>::MakeUnique<Deserializer&>(id, ser), con);
+	timer.Stop();
+	EUDAQ_TRACE_FLOW_STEP("deserialize", Trace::FlowId(ev_con.first->GetDeviceN(),
+							   ev_con.first->GetRunN(),
+							   ev_con.first->GetEventN()));
 	std::unique_lock<std::mutex> lk(m_mx_qu_ev);
 	m_qu_ev.push(ev_con);
+	m_qu_tp.push(std::chrono::steady_clock::now());
 	if(m_qu_ev.size() > 50000){
 	  m_qu_ev.pop();
+	  m_qu_tp.pop();
 	  EUDAQ_WARN("DataReceiver: Buffer of receving event is full.");
 	}
+	m_st_rcv.SetQueue(m_qu_ev.size());
 	m_cv_not_empty.notify_all();
       }
       break;
@@ -112,6 +126,7 @@ namespace eudaq {
   }
 
   bool DataReceiver::AsyncReceiving(){
+    EUDAQ_TRACE_THREAD("DataReceiver::AsyncReceiving");
     m_is_async_rcv_return = false;
     while (m_is_listening){
       m_dataserver->Process(100000);
@@ -121,6 +136,7 @@ namespace eudaq {
   }
 
   bool DataReceiver::AsyncForwarding(){
+    EUDAQ_TRACE_THREAD("DataReceiver::AsyncForwarding");
     while(!m_is_async_rcv_return){
       std::unique_lock<std::mutex> lk(m_mx_qu_ev);
       while(m_qu_ev.empty()){
@@ -137,9 +153,17 @@ namespace eudaq {
       }
       auto ev = m_qu_ev.front().first;
       auto con = m_qu_ev.front().second;
+      auto tp = m_qu_tp.front();
       m_qu_ev.pop();
+      m_qu_tp.pop();
+      m_st_rcv.SetQueue(m_qu_ev.size());
       lk.unlock();
       if(ev){
+	// time spent waiting in the receiving queue
+	auto dt = std::chrono::steady_clock::now() - tp;
+	m_st_rcv.Add(0, std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+	EUDAQ_TRACE_SCOPE("DataReceiver::AsyncForwarding");
+	EUDAQ_TRACE_FLOW_STEP("forward", Trace::FlowId(ev->GetDeviceN(), ev->GetRunN(), ev->GetEventN()));
 	OnReceive(con, ev);
       }
       else{
@@ -227,6 +251,7 @@ namespace eudaq {
 	  if(!m_qu_ev.empty()){
 	    EUDAQ_WARN("DataReceiver: Data buffer is not empty during the stopping");
 	    m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	    m_qu_tp = std::queue<std::chrono::steady_clock::time_point>();
 	  }
 	  if(m_dataserver)
 	    m_dataserver.reset();
@@ -248,6 +273,7 @@ namespace eudaq {
       if(!m_qu_ev.empty()){
 	EUDAQ_WARN("DataReceiver: Data buffer is not empty during the exiting");
 	m_qu_ev = std::queue<std::pair<EventSP, ConnectionSPC>>();
+	m_qu_tp = std::queue<std::chrono::steady_clock::time_point>();
       }
       if(m_dataserver)
 	m_dataserver.reset();
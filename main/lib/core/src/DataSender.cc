@@ -4,13 +4,15 @@
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/DataSender.hh"
+#include "eudaq/Trace.hh"
 
 namespace eudaq {
 
   DataSender::DataSender(const std::string & type, const std::string & name)
     : m_type(type),
     m_name(name),
-    m_packetCounter(0) {}
+    m_packetCounter(0),
+    m_st_send(Metrics::Instance().Stage("send")) {}
 
 
   DataSender::~DataSender(){
@@ -92,8 +94,12 @@ namespace eudaq {
     m_cv_not_empty.notify_all();
     */
 
+    MetricTimer timer(m_st_send);
+    EUDAQ_TRACE_SCOPE("DataSender::SendEvent");
+    EUDAQ_TRACE_FLOW_STEP("send", Trace::FlowId(ev->GetDeviceN(), ev->GetRunN(), ev->GetEventN()));
     BufferSerializer ser;
     ev->Serialize(ser);
+    timer.SetBytes(ser.size());
     m_packetCounter += 1;
     //TODO: catch exception below
     m_dataclient->SendPacket(ser);
@@ -112,9 +118,14 @@ namespace eudaq {
       }
       auto ev = m_qu_ev.front();
       m_qu_ev.pop();
+      m_st_send.SetQueue(m_qu_ev.size());
       lk.unlock();
+      MetricTimer timer(m_st_send);
+      EUDAQ_TRACE_SCOPE("DataSender::AsyncSending");
+      EUDAQ_TRACE_FLOW_STEP("send", Trace::FlowId(ev->GetDeviceN(), ev->GetRunN(), ev->GetEventN()));
       BufferSerializer ser;
       ev->Serialize(ser);
+      timer.SetBytes(ser.size());
       m_packetCounter += 1;
       //TODO: catch exception below
       m_dataclient->SendPacket(ser);
@@ -104,10 +104,12 @@ namespace eudaq {
     }
   }
 
-  std::vector<uint8_t> Event::GetBlock(uint32_t i) const{
+  const std::vector<uint8_t>& Event::GetBlock(uint32_t i) const{
+    static const std::vector<uint8_t> empty;
     auto it = m_blocks.find(i);
     if(it == m_blocks.end()){
       EUDAQ_WARN(std::string("RAWDATAEVENT:: no bolck with ID ") + std::to_string(i) + " exists");
+      return empty;
     }
     return it->second;
   }
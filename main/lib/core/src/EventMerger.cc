@@ -0,0 +1,238 @@
+#include "eudaq/EventMerger.hh"
+#include "eudaq/Exception.hh"
+
+namespace eudaq {
+
+  PrefetchReader::PrefetchReader(FileReaderSP reader, size_t depth)
+    :m_reader(reader), m_depth(depth ? depth : 1), m_eof(false), m_stop(false){
+    m_thd = std::thread(&PrefetchReader::Reading, this);
+  }
+
+  PrefetchReader::~PrefetchReader(){
+    {
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    if(m_thd.joinable())
+      m_thd.join();
+  }
+
+  void PrefetchReader::Reading(){
+    std::exception_ptr error;
+    try{
+      while(true){
+	EventSPC ev = m_reader->GetNextEvent();
+	if(!ev)
+	  break;
+	std::unique_lock<std::mutex> lk(m_mtx);
+	m_cv.wait(lk, [this]{return m_stop || m_queue.size() < m_depth;});
+	if(m_stop)
+	  break;
+	m_queue.push_back(ev);
+	lk.unlock();
+	m_cv.notify_all();
+      }
+    }
+    catch(...){
+      error = std::current_exception();
+    }
+    {
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_error = error;
+      m_eof = true;
+    }
+    m_cv.notify_all();
+  }
+
+  EventSPC PrefetchReader::Next(){
+    if(m_local.empty()){
+      // take everything read so far in one go, the reader refills meanwhile
+      std::unique_lock<std::mutex> lk(m_mtx);
+      m_cv.wait(lk, [this]{return !m_queue.empty() || m_eof;});
+      if(m_queue.empty()){
+	if(m_error)
+	  std::rethrow_exception(m_error);
+	return nullptr;
+      }
+      m_local.swap(m_queue);
+      lk.unlock();
+      m_cv.notify_all();
+    }
+    EventSPC ev = m_local.front();
+    m_local.pop_front();
+    return ev;
+  }
+
+  EventMerger::EventMerger(Key key, uint64_t window)
+    :m_key(key), m_window(window), m_type("MimosaTlu"), m_depth(256),
+     m_n_merged(0), m_n_incomplete(0){
+  }
+
+  EventMerger::~EventMerger(){
+  }
+
+  std::string EventMerger::FileType(const std::string &path){
+    std::string type = path.substr(path.find_last_of(".") + 1);
+    if(type == "raw")
+      type = "native";
+    return type;
+  }
+
+  void EventMerger::AddInput(const std::string &path, Policy policy, bool flatten){
+    AddInput(FileReader::Make(FileType(path), path), path, policy, flatten);
+  }
+
+  void EventMerger::AddInput(FileReaderSP reader, const std::string &name,
+			     Policy policy, bool flatten){
+    if(!reader)
+      EUDAQ_THROW("EventMerger: no reader for input " + name);
+    Input in;
+    in.name = name;
+    in.file = reader;
+    in.policy = policy;
+    in.flatten = flatten;
+    in.used = false;
+    in.n_used = 0;
+    in.n_dropped = 0;
+    in.n_pending = 0;
+    m_in.push_back(std::move(in));
+  }
+
+  void EventMerger::SetWriter(FileWriterSP writer){
+    m_writer = writer;
+  }
+
+  void EventMerger::SetEventType(const std::string &type){
+    m_type = type;
+  }
+
+  void EventMerger::SetPrefetchDepth(size_t depth){
+    m_depth = depth;
+  }
+
+  uint64_t EventMerger::KeyOf(const EventSPC &ev) const {
+    switch(m_key){
+    case Key::EVENT_N:
+      return ev->GetEventN();
+    case Key::TIMESTAMP:
+      return ev->GetTimestampBegin();
+    default:
+      return ev->GetTriggerN();
+    }
+  }
+
+  void EventMerger::Add(Event &sync, Input &in, const EventSPC &ev){
+    if(in.flatten){
+      uint32_t n = ev->GetNumSubEvent();
+      for(uint32_t i = 0; i < n; i++)
+	sync.AddSubEvent(ev->GetSubEvent(i));
+    }
+    else
+      sync.AddSubEvent(ev);
+    in.used = true;
+    in.n_pending++;
+  }
+
+  bool EventMerger::Advance(Input &in){
+    if(in.cur && !in.used)
+      in.n_dropped++;
+    in.cur = in.next;
+    in.used = false;
+    in.next = in.cur ? in.reader->Next() : nullptr;
+    return bool(in.cur);
+  }
+
+  uint64_t EventMerger::Run(uint64_t max_events){
+    if(m_in.empty())
+      EUDAQ_THROW("EventMerger: no input file");
+    for(auto &in: m_in){
+      in.reader.reset(new PrefetchReader(in.file, m_depth));
+      in.cur = in.reader->Next();
+      in.next = in.cur ? in.reader->Next() : nullptr;
+      in.used = false;
+      in.n_pending = 0;
+    }
+    Input &ref = m_in[0];
+    const uint32_t run_n = ref.cur ? ref.cur->GetRunN() : 0;
+    bool end = false;
+    while(ref.cur && !end && m_n_merged < max_events){
+      const uint64_t k = KeyOf(ref.cur);
+      const uint64_t k_next = ref.next ? KeyOf(ref.next) : UINT64_MAX;
+      auto sync = Event::MakeUnique(m_type);
+      sync->SetFlagPacket();
+      sync->SetTriggerN(ref.cur->GetTriggerN());
+      sync->SetEventN(m_n_merged);
+      sync->SetRunN(run_n);
+      if(m_key == Key::TIMESTAMP)
+	sync->SetTimestamp(ref.cur->GetTimestampBegin(), ref.cur->GetTimestampEnd());
+      Add(*sync, ref, ref.cur);
+
+      bool complete = true;
+      for(size_t i = 1; i < m_in.size() && !end; i++){
+	Input &in = m_in[i];
+	switch(in.policy){
+	case Policy::MATCH:
+	  while(in.cur && KeyOf(in.cur) + m_window < k)
+	    Advance(in);
+	  if(!in.cur)
+	    end = true;
+	  else if(KeyOf(in.cur) <= k + m_window){
+	    Add(*sync, in, in.cur);
+	    Advance(in);
+	  }
+	  else
+	    complete = false;
+	  break;
+	case Policy::DUPLICATE:
+	  while(in.next && KeyOf(in.next) <= k + m_window)
+	    Advance(in);
+	  // the last event still covers the reference keys from its own on
+	  if(!in.cur)
+	    end = true;
+	  else if(KeyOf(in.cur) <= k + m_window)
+	    Add(*sync, in, in.cur);
+	  else
+	    complete = false;
+	  break;
+	case Policy::COLLECT:
+	  while(in.cur && KeyOf(in.cur) + m_window < k)
+	    Advance(in);
+	  while(in.cur && (!ref.next || KeyOf(in.cur) + m_window < k_next)){
+	    Add(*sync, in, in.cur);
+	    Advance(in);
+	  }
+	  break;
+	}
+      }
+      if(end)
+	break;
+      // events added to an incomplete merge are never written
+      for(auto &in: m_in){
+	(complete ? in.n_used : in.n_dropped) += in.n_pending;
+	in.n_pending = 0;
+      }
+      if(complete){
+	if(m_writer)
+	  m_writer->WriteEvent(std::move(sync));
+	m_n_merged++;
+      }
+      else
+	m_n_incomplete++;
+      Advance(ref);
+    }
+    for(auto &in: m_in)
+      in.reader.reset();
+    return m_n_merged;
+  }
+
+  void EventMerger::Print(std::ostream &os) const {
+    os << "Merged events: " << m_n_merged
+       << ", incomplete: " << m_n_incomplete << "\n";
+    for(auto &in: m_in){
+      os << "  " << in.name << ": " << in.n_used << " used, "
+	 << in.n_dropped << " dropped\n";
+    }
+  }
+
+}
@@ -0,0 +1,402 @@
+#include "eudaq/FileScanner.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/Deserializer.hh"
+#include "eudaq/RawEvent.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/StdEventConverter.hh"
+#include "eudaq/Exception.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace eudaq {
+
+  namespace{
+    // Deserializer over one chunk of a file held in memory
+    class ChunkDeserializer : public Deserializer {
+    public:
+      ChunkDeserializer(const std::vector<uint8_t> &buf)
+	:m_buf(buf), m_pos(0){}
+      bool HasData() override {return m_pos < m_buf.size();}
+    private:
+      void Deserialize(unsigned char *data, size_t len) override {
+	PreDeserialize(data, len);
+	m_pos += len;
+      }
+      void PreDeserialize(unsigned char *data, size_t len) override {
+	if(len > m_buf.size() - m_pos)
+	  EUDAQ_THROW("FileScanner: event exceeds the end of its chunk");
+	std::memcpy(data, m_buf.data() + m_pos, len);
+      }
+      const std::vector<uint8_t> &m_buf;
+      size_t m_pos;
+    };
+
+    // Walks the serialised RawEvents of a native file, decoding the headers
+    // and stepping over the tags and data blocks. The file is read in large
+    // blocks, data blocks beyond the current one are skipped with a seek.
+    class HeaderWalker {
+    public:
+      HeaderWalker(const std::string &path)
+	:m_file(path, std::ios::binary), m_pos(0), m_size(0), m_buf_pos(0){
+	if(!m_file)
+	  EUDAQ_THROW("FileScanner: unable to open file: " + path);
+	m_file.seekg(0, std::ios::end);
+	m_size = m_file.tellg();
+	m_file.seekg(0);
+      }
+      uint64_t Pos() const {return m_pos;}
+      uint64_t Size() const {return m_size;}
+      // false if the event at the current position is not a complete RawEvent
+      bool SkipEvent(){
+	uint32_t type;
+	if(!U32(type) || type != RawEvent::m_id_factory)
+	  return false;
+	// version, flags, stream, run, event, trigger, extend, 2 timestamps
+	if(!Skip(7 * 4 + 2 * 8) || !SkipBytes())
+	  return false;
+	uint32_t n;
+	if(!U32(n))
+	  return false;
+	for(uint32_t i = 0; i < n; i++)
+	  if(!SkipBytes() || !SkipBytes())
+	    return false;
+	if(!U32(n))
+	  return false;
+	for(uint32_t i = 0; i < n; i++)
+	  if(!Skip(4) || !SkipBytes())
+	    return false;
+	if(!U32(n))
+	  return false;
+	for(uint32_t i = 0; i < n; i++)
+	  if(!SkipEvent())
+	    return false;
+	return true;
+      }
+    private:
+      // makes the n bytes at the current position available in the buffer
+      bool Fill(uint64_t n){
+	if(m_pos + n > m_size)
+	  return false;
+	if(m_pos >= m_buf_pos && m_pos + n <= m_buf_pos + m_buf.size())
+	  return true;
+	m_buf.resize(std::min<uint64_t>(std::max<uint64_t>(n, 1 << 20), m_size - m_pos));
+	m_buf_pos = m_pos;
+	m_file.clear();
+	m_file.seekg(m_pos);
+	return bool(m_file.read(reinterpret_cast<char*>(m_buf.data()), m_buf.size()));
+      }
+      bool U32(uint32_t &v){
+	if(!Fill(4))
+	  return false;
+	const uint8_t *b = m_buf.data() + (m_pos - m_buf_pos);
+	v = uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+	m_pos += 4;
+	return true;
+      }
+      bool Skip(uint64_t n){
+	if(m_pos + n > m_size)
+	  return false;
+	m_pos += n;
+	return true;
+      }
+      // string or byte vector: length followed by the bytes
+      bool SkipBytes(){
+	uint32_t len;
+	return U32(len) && Skip(len);
+      }
+      std::ifstream m_file;
+      uint64_t m_pos;
+      uint64_t m_size;
+      std::vector<uint8_t> m_buf;
+      uint64_t m_buf_pos;
+    };
+
+    bool InRange(const ScanRange &r, uint64_t v){
+      return !r.IsSet() || (v >= r.low && v < r.high);
+    }
+  }
+
+  ScanStatistics::ScanStatistics()
+    :n_event(0), has_trigger(false), trigger_first(0), trigger_last(0),
+     n_trigger_gap(0), n_trigger_missing(0), has_timestamp(false),
+     ts_min(UINT64_MAX), ts_max(0){
+  }
+
+  void ScanStatistics::Add(const Event &ev){
+    n_event++;
+    uint64_t tg = ev.GetTriggerN();
+    if(has_trigger){
+      if(tg != trigger_last + 1){
+	n_trigger_gap++;
+	if(tg > trigger_last + 1)
+	  n_trigger_missing += tg - trigger_last - 1;
+      }
+    }
+    else{
+      trigger_first = tg;
+      has_trigger = true;
+    }
+    trigger_last = tg;
+
+    std::vector<const Event*> evs(1, &ev);
+    for(size_t i = 0; i < evs.size(); i++){
+      const Event *e = evs[i];
+      n_type[std::make_pair(e->GetDescription(), e->GetStreamN())]++;
+      if(e->IsFlagTimestamp()){
+	ts_min = std::min(ts_min, e->GetTimestampBegin());
+	ts_max = std::max(ts_max, e->GetTimestampEnd());
+	has_timestamp = true;
+      }
+      for(uint32_t j = 0; j < e->GetNumSubEvent(); j++)
+	evs.push_back(e->GetSubEvent(j).get());
+    }
+  }
+
+  void ScanStatistics::AddHits(uint32_t plane, uint64_t hits){
+    n_hit[plane] += hits;
+    n_plane_event[plane]++;
+  }
+
+  void ScanStatistics::Merge(const ScanStatistics &next){
+    n_event += next.n_event;
+    for(auto &t: next.n_type)
+      n_type[t.first] += t.second;
+    if(next.has_trigger){
+      if(has_trigger){
+	if(next.trigger_first != trigger_last + 1){
+	  n_trigger_gap++;
+	  if(next.trigger_first > trigger_last + 1)
+	    n_trigger_missing += next.trigger_first - trigger_last - 1;
+	}
+      }
+      else{
+	trigger_first = next.trigger_first;
+	has_trigger = true;
+      }
+      trigger_last = next.trigger_last;
+      n_trigger_gap += next.n_trigger_gap;
+      n_trigger_missing += next.n_trigger_missing;
+    }
+    if(next.has_timestamp){
+      ts_min = std::min(ts_min, next.ts_min);
+      ts_max = std::max(ts_max, next.ts_max);
+      has_timestamp = true;
+    }
+    for(auto &h: next.n_hit)
+      n_hit[h.first] += h.second;
+    for(auto &h: next.n_plane_event)
+      n_plane_event[h.first] += h.second;
+  }
+
+  void ScanStatistics::Print(std::ostream &os) const {
+    os << "Events per type (description, stream):\n";
+    for(auto &t: n_type)
+      os << "  " << t.first.first << ", " << t.first.second << ": " << t.second << "\n";
+    if(has_trigger)
+      os << "Trigger numbers: " << trigger_first << " - " << trigger_last
+	 << ", " << n_trigger_gap << " gaps, " << n_trigger_missing << " missing\n";
+    if(has_timestamp)
+      os << "Timestamps: " << ts_min << " - " << ts_max << "\n";
+    if(!n_hit.empty()){
+      os << "Hits per plane (plane: hits / events):\n";
+      for(auto &h: n_hit)
+	os << "  " << h.first << ": " << h.second << " / " << n_plane_event.at(h.first) << "\n";
+    }
+  }
+
+  struct FileScanner::Chunk {
+    uint64_t offset;
+    uint64_t size;
+    ScanStatistics st;
+    std::string out;
+    // with conversion, the events left for the sequential pass
+    std::vector<EventSPC> events;
+    bool ready = false;
+  };
+
+  FileScanner::FileScanner(const std::string &path)
+    :m_path(path), m_threads(std::max(1u, std::thread::hardware_concurrency())),
+     m_chunk_size(64 << 20), m_convert(false), m_os(nullptr), m_n_chunk(0){
+  }
+
+  std::string FileScanner::FileType(const std::string &path){
+    std::string type = path.substr(path.find_last_of(".") + 1);
+    if(type == "raw")
+      type = "native";
+    return type;
+  }
+
+  void FileScanner::SetThreads(uint32_t n){
+    m_threads = n ? n : 1;
+  }
+
+  void FileScanner::SetChunkSize(uint64_t bytes){
+    m_chunk_size = bytes;
+  }
+
+  void FileScanner::SetConvert(bool convert, ConfigurationSPC conf){
+    m_convert = convert;
+    m_conf = conf;
+  }
+
+  void FileScanner::Process(const EventSPC &ev, ScanStatistics &st, std::ostream *os) const {
+    st.Add(*ev);
+    bool any = m_range_ev.IsSet() || m_range_tg.IsSet() || m_range_ts.IsSet();
+    bool in_ts = !m_range_ts.IsSet() ||
+      (ev->GetTimestampBegin() >= m_range_ts.low && ev->GetTimestampEnd() <= m_range_ts.high);
+    bool selected = InRange(m_range_ev, ev->GetEventN()) &&
+      InRange(m_range_tg, ev->GetTriggerN()) && in_ts;
+    if(any && selected && os)
+      ev->Print(*os);
+    // with a range only the selected events, otherwise all for the hit counts
+    if(m_convert && selected){
+      auto evstd = StandardEvent::MakeShared();
+      StdEventConverter::Convert(ev, evstd, m_conf);
+      if(any && os)
+	*os << ">>>>>" << evstd->NumPlanes() << "<<<<" << std::endl;
+      for(size_t i = 0; i < evstd->NumPlanes(); i++){
+	auto &plane = evstd->GetPlane(i);
+	st.AddHits(plane.ID(), plane.HitPixels());
+      }
+    }
+  }
+
+  void FileScanner::ProcessChunk(Chunk &ck) const {
+    std::vector<uint8_t> buf(ck.size);
+    std::ifstream file(m_path, std::ios::binary);
+    file.seekg(ck.offset);
+    if(!file.read(reinterpret_cast<char*>(buf.data()), ck.size))
+      EUDAQ_THROW("FileScanner: unable to read " + m_path);
+    ChunkDeserializer ds(buf);
+    std::ostringstream os;
+    std::ostream *pos = m_os ? &os : nullptr;
+    while(ds.HasData()){
+      uint32_t id;
+      ds.PreRead(id);
+      EventSPC ev = Factory<Event>::Create<Deserializer&>(id, ds);
+      if(m_convert)
+	ck.events.push_back(ev);
+      else
+	Process(ev, ck.st, pos);
+    }
+    ck.out = os.str();
+  }
+
+  ScanStatistics FileScanner::RunSequential(){
+    ScanStatistics st;
+    auto reader = FileReader::Make(FileType(m_path), m_path);
+    while(auto ev = reader->GetNextEvent())
+      Process(ev, st, m_os);
+    m_n_chunk = 1;
+    return st;
+  }
+
+  ScanStatistics FileScanner::Run(){
+    if(FileType(m_path) != "native")
+      return RunSequential();
+    std::vector<Chunk> chunks;
+    {
+      HeaderWalker walker(m_path);
+      // several chunks per thread keep all of them busy to the end
+      uint64_t chunk_size = std::min<uint64_t>(m_chunk_size,
+					       std::max<uint64_t>(1 << 20, walker.Size() / (4 * m_threads)));
+      uint64_t begin = 0;
+      while(walker.Pos() < walker.Size()){
+	if(!walker.SkipEvent())
+	  return RunSequential();
+	if(walker.Pos() - begin >= chunk_size || walker.Pos() == walker.Size()){
+	  Chunk ck;
+	  ck.offset = begin;
+	  ck.size = walker.Pos() - begin;
+	  chunks.push_back(std::move(ck));
+	  begin = walker.Pos();
+	}
+      }
+    }
+    m_n_chunk = chunks.size();
+
+    // The chunks are handed out at most m_threads ahead of the one merged.
+    // The converters keep state between events (set up from the BORE, static
+    // maps), so with conversion the workers only deserialise and the events
+    // are processed here, in file order.
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t next = 0;
+    size_t merged = 0;
+    bool abort = false;
+    std::vector<std::exception_ptr> errors(m_threads);
+    std::vector<std::thread> workers;
+    for(uint32_t t = 0; t < m_threads; t++){
+      workers.emplace_back([&, t](){
+	  try{
+	    for(;;){
+	      size_t i;
+	      {
+		std::unique_lock<std::mutex> lk(mtx);
+		cv.wait(lk, [&](){return abort || next >= chunks.size() || next < merged + m_threads;});
+		if(abort || next >= chunks.size())
+		  break;
+		i = next++;
+	      }
+	      ProcessChunk(chunks[i]);
+	      std::unique_lock<std::mutex> lk(mtx);
+	      chunks[i].ready = true;
+	      cv.notify_all();
+	    }
+	  }
+	  catch(...){
+	    std::unique_lock<std::mutex> lk(mtx);
+	    errors[t] = std::current_exception();
+	    abort = true;
+	    cv.notify_all();
+	  }
+	});
+    }
+
+    ScanStatistics st;
+    std::exception_ptr error;
+    try{
+      for(auto &ck: chunks){
+	{
+	  std::unique_lock<std::mutex> lk(mtx);
+	  cv.wait(lk, [&](){return abort || ck.ready;});
+	  if(!ck.ready)
+	    break;
+	}
+	if(m_os)
+	  *m_os << ck.out;
+	for(auto &ev: ck.events)
+	  Process(ev, ck.st, m_os);
+	ck.events.clear();
+	ck.events.shrink_to_fit();
+	st.Merge(ck.st);
+	std::unique_lock<std::mutex> lk(mtx);
+	merged++;
+	cv.notify_all();
+      }
+    }
+    catch(...){
+      error = std::current_exception();
+      std::unique_lock<std::mutex> lk(mtx);
+      abort = true;
+      cv.notify_all();
+    }
+    for(auto &w: workers)
+      w.join();
+    for(auto &e: errors)
+      if(e)
+	std::rethrow_exception(e);
+    if(error)
+      std::rethrow_exception(error);
+    return st;
+  }
+
+}
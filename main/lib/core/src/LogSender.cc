@@ -1,14 +1,88 @@
 #include "eudaq/LogSender.hh"
+#include "eudaq/Logger.hh"
 #include "eudaq/LogMessage.hh"
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Exception.hh"
 #include "eudaq/BufferSerializer.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
 namespace eudaq {
 
+  namespace {
+    struct RateConfig {
+      int64_t interval; // ns per message, 0 without limit
+      int64_t window;   // ns of credit, burst x interval
+    };
+
+    const RateConfig &GetRateConfig() {
+      static const RateConfig conf = []() {
+        double rate = 10, burst = 100;
+        const char *env = std::getenv("EUDAQ_LOG_RATE");
+        if (env && *env) {
+          char *end;
+          rate = std::strtod(env, &end);
+          if (*end == ':')
+            burst = std::strtod(end + 1, nullptr);
+        }
+        RateConfig c = {0, 0};
+        if (rate > 0) {
+          c.interval = int64_t(1e9 / rate);
+          c.window = int64_t(std::max(burst, 1.0) * c.interval);
+        }
+        return c;
+      }();
+      return conf;
+    }
+  }
+
+  bool LogRateLimit::Pass(uint64_t &suppressed) {
+    const RateConfig &conf = GetRateConfig();
+    if (conf.interval) {
+      int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t tat = m_tat.load(std::memory_order_relaxed);
+      int64_t next;
+      do {
+        next = std::max(tat, now) + conf.interval;
+        if (next - now > conf.window) {
+          m_suppressed.fetch_add(1, std::memory_order_relaxed);
+          if (!m_pending.exchange(true))
+            GetLogger().AddSuppressed(this);
+          return false;
+        }
+      } while (!m_tat.compare_exchange_weak(tat, next,
+                                            std::memory_order_relaxed));
+    }
+    suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  uint64_t LogRateLimit::TakeSuppressed() {
+    m_pending = false;
+    return m_suppressed.exchange(0, std::memory_order_relaxed);
+  }
+
+  struct LogSender::Node {
+    Node(const LogMessage &m) : next(nullptr), msg(m) {}
+    std::atomic<Node *> next;
+    LogMessage msg;
+  };
+
   LogSender::LogSender()
-      : m_logclient(0), m_errlevel(Status::LVL_DEBUG),
-        m_shownotconnected(false) {}
+      : m_logclient(0), m_level(Status::LVL_DEBUG),
+        m_errlevel(Status::LVL_DEBUG), m_shownotconnected(false),
+        m_has_client(false), m_stub(new Node(LogMessage())), m_n_queued(0),
+        m_n_done(0), m_exit(false) {
+    m_head = m_stub;
+    m_tail = m_stub;
+    m_thread = std::thread(&LogSender::SenderThread, this);
+  }
 
   void LogSender::Connect(const std::string &type, const std::string &name,
                           const std::string &server) {
@@ -21,6 +95,7 @@ namespace eudaq {
     delete m_logclient;
     m_name = type + " " + name;
     m_logclient = TransportClient::CreateClient(server);
+    m_has_client = true;
 
     std::string packet;
     if (!m_logclient->ReceivePacket(&packet, 1000000))
@@ -61,54 +136,209 @@ namespace eudaq {
   }
 
   void LogSender::Disconnect() {
+    Flush();
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
     delete m_logclient;
+    m_logclient = 0;
+    m_has_client = false;
     isConnected = false;
   }
 
+  void LogSender::Enqueue(Node *node) {
+    m_n_queued++;
+    Push(node);
+  }
+
+  void LogSender::Push(Node *node) {
+    Node *prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // nullptr when empty, or while a producer is between its exchange and
+  // its link; the message is then taken on the next call
+  LogSender::Node *LogSender::Dequeue() {
+    Node *tail = m_tail;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (tail == m_stub) {
+      if (!next)
+        return nullptr;
+      m_tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+      m_tail = next;
+      return tail;
+    }
+    if (tail != m_head.load(std::memory_order_acquire))
+      return nullptr;
+    m_stub->next.store(nullptr, std::memory_order_relaxed);
+    Push(m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      m_tail = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+  void LogSender::AddSuppressed(LogRateLimit *site) {
+    std::lock_guard<std::mutex> lk(m_suppressed_mutex);
+    m_suppressed.push_back(site);
+  }
+
+  void LogSender::SendSummaries() {
+    std::vector<LogRateLimit *> sites;
+    {
+      std::lock_guard<std::mutex> lk(m_suppressed_mutex);
+      sites.swap(m_suppressed);
+    }
+    for (auto site : sites) {
+      uint64_t n = site->TakeSuppressed();
+      if (n)
+        Enqueue(new Node(
+            LogMessage(std::to_string(n) + " similar messages suppressed",
+                       Status::Level(site->Level()))
+                .SetLocation(site->File(), site->Line())));
+    }
+  }
+
+  void LogSender::SenderThread() {
+    std::vector<Node *> batch;
+    auto summary = std::chrono::steady_clock::now();
+    for (;;) {
+      if (std::chrono::steady_clock::now() - summary > std::chrono::seconds(1)) {
+        SendSummaries();
+        summary = std::chrono::steady_clock::now();
+      }
+      while (Node *node = Dequeue())
+        batch.push_back(node);
+      if (batch.empty()) {
+        if (m_exit && m_n_done == m_n_queued) {
+          // call sites are trivially destructible and still valid here
+          std::lock_guard<std::mutex> lk(m_suppressed_mutex);
+          if (m_suppressed.empty())
+            break;
+          summary = std::chrono::steady_clock::time_point();
+          continue;
+        }
+        std::unique_lock<std::mutex> lk(m_wait_mutex);
+        if (m_n_done == m_n_queued && !m_exit)
+          m_wait_queue.wait_for(lk, std::chrono::milliseconds(50));
+        continue;
+      }
+      {
+        // one write and flush per stream for the whole batch
+        std::ostringstream out, err;
+        std::lock_guard<std::recursive_mutex> lk(m_mutex);
+        for (auto node : batch)
+          Print(node->msg, out, err);
+        if (out.tellp() > 0)
+          std::cout << out.str() << std::flush;
+        if (err.tellp() > 0)
+          std::cerr << err.str() << std::flush;
+        for (auto node : batch)
+          Send(node->msg, std::cerr);
+      }
+      for (auto node : batch)
+        delete node;
+      {
+        std::lock_guard<std::mutex> lk(m_wait_mutex);
+        m_n_done += batch.size();
+      }
+      m_wait_done.notify_all();
+      batch.clear();
+    }
+  }
+
+  void LogSender::Flush() {
+    if (std::this_thread::get_id() == m_thread.get_id())
+      return;
+    uint64_t target = m_n_queued;
+    m_wait_queue.notify_one();
+    std::unique_lock<std::mutex> lk(m_wait_mutex);
+    m_wait_done.wait(lk, [&]() { return m_n_done >= target; });
+  }
+
   void LogSender::SendLogMessage(const LogMessage &msg) {
+    Enqueue(new Node(msg));
+    if (msg.GetLevel() >= Status::LVL_ERROR)
+      Flush();
+    else
+      m_wait_queue.notify_one();
+  }
 
-    SendLogMessage(msg, std::cout, std::cerr);
+  void LogSender::SendLogMessage(const LogMessage &msg, uint64_t suppressed) {
+    if (!suppressed) {
+      SendLogMessage(msg);
+      return;
+    }
+    LogMessage note(msg);
+    note.SetMessage(msg.GetMessage() + " [" + std::to_string(suppressed) +
+                    " similar messages suppressed]");
+    SendLogMessage(note);
   }
 
   void LogSender::SendLogMessage(const LogMessage &msg, std::ostream &out,
                                  std::ostream &error_out) {
+    Flush();
     std::lock_guard<std::recursive_mutex> lk(m_mutex);
+    Print(msg, out, error_out);
+    out.flush();
+    error_out.flush();
+    Send(msg, error_out);
+  }
+
+  void LogSender::Print(const LogMessage &msg, std::ostream &out,
+                        std::ostream &error_out) {
     if (msg.GetLevel() >= m_level) {
       if (msg.GetLevel() >= m_errlevel) {
         if (m_name != "")
           error_out << "[" << m_name << "] ";
-        error_out << msg << std::endl;
+        error_out << msg << "\n";
       } else {
         if (m_name != "")
           out << "[" << m_name << "] ";
-        out << msg << std::endl;
+        out << msg << "\n";
       }
     }
+    if (!m_logclient && m_shownotconnected)
+      error_out << "### Log message triggered but Logger not connected ###\n";
+  }
 
-    if (!m_logclient) {
-      if (m_shownotconnected)
-        error_out << "### Log message triggered but Logger not connected ###\n";
-    } else {
-      BufferSerializer ser;
-      msg.Serialize(ser);
-      try {
-        m_logclient->SendPacket(ser);
-      } catch (const eudaq::Exception &e) {
-        error_out << "Caught exception trying to log message '" << msg
-                  << "': " << e.what() << std::endl;
-        error_out << " -> will delete LogClient" << std::endl;
-        delete m_logclient;
-        m_logclient = 0;
-      } catch (...) {
-        error_out << "Caught exception trying to log message '" << msg << "'! "
-                  << std::endl;
-        error_out << " -> will delete LogClient" << std::endl;
-        delete m_logclient;
-        m_logclient = 0;
-      }
+  void LogSender::Send(const LogMessage &msg, std::ostream &error_out) {
+    if (!m_logclient)
+      return;
+    BufferSerializer ser;
+    msg.Serialize(ser);
+    try {
+      m_logclient->SendPacket(ser);
+    } catch (const eudaq::Exception &e) {
+      error_out << "Caught exception trying to log message '" << msg
+                << "': " << e.what() << std::endl;
+      error_out << " -> will delete LogClient" << std::endl;
+      delete m_logclient;
+      m_logclient = 0;
+      m_has_client = false;
+    } catch (...) {
+      error_out << "Caught exception trying to log message '" << msg << "'! "
+                << std::endl;
+      error_out << " -> will delete LogClient" << std::endl;
+      delete m_logclient;
+      m_logclient = 0;
+      m_has_client = false;
     }
   }
 
-  LogSender::~LogSender() { delete m_logclient; }
+  LogSender::~LogSender() {
+    {
+      std::lock_guard<std::mutex> lk(m_wait_mutex);
+      m_exit = true;
+    }
+    m_wait_queue.notify_one();
+    if (m_thread.joinable())
+      m_thread.join();
+    delete m_stub;
+    delete m_logclient;
+  }
 }
@@ -0,0 +1,202 @@
+#include "eudaq/Metrics.hh"
+
+#include <cmath>
+#include <cstdio>
+
+namespace eudaq {
+
+  static size_t HighestBit(uint64_t v){
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    size_t n = 0;
+    while(v >>= 1)
+      n++;
+    return n;
+#endif
+  }
+
+  MetricCounter::MetricCounter(){
+    Reset();
+  }
+
+  size_t MetricCounter::ShardIndex(){
+    static std::atomic<size_t> next(0);
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % N_SHARDS;
+    return index;
+  }
+
+  uint64_t MetricCounter::Get() const{
+    uint64_t sum = 0;
+    for(auto &s: m_shards)
+      sum += s.v.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  void MetricCounter::Reset(){
+    for(auto &s: m_shards)
+      s.v.store(0, std::memory_order_relaxed);
+  }
+
+  MetricHistogram::MetricHistogram(){
+    Reset();
+  }
+
+  size_t MetricHistogram::BucketIndex(uint64_t v){
+    if(v < N_SUB)
+      return v;
+    size_t msb = HighestBit(v);
+    return (msb - 3) * N_SUB + ((v >> (msb - 4)) & (N_SUB - 1));
+  }
+
+  uint64_t MetricHistogram::BucketValue(size_t i){
+    if(i < N_SUB)
+      return i;
+    size_t msb = i / N_SUB + 3;
+    uint64_t width = uint64_t(1) << (msb - 4);
+    uint64_t lower = (N_SUB + i % N_SUB) << (msb - 4);
+    return lower + width / 2;
+  }
+
+  uint64_t MetricHistogram::Count() const{
+    uint64_t n = 0;
+    for(auto &b: m_buckets)
+      n += b.load(std::memory_order_relaxed);
+    return n;
+  }
+
+  void MetricHistogram::Snapshot(std::vector<uint64_t> &counts) const{
+    counts.resize(N_BUCKETS);
+    for(size_t i = 0; i < N_BUCKETS; i++)
+      counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+  }
+
+  uint64_t MetricHistogram::Percentile(double q) const{
+    std::vector<uint64_t> counts;
+    Snapshot(counts);
+    return Percentile(counts, q);
+  }
+
+  uint64_t MetricHistogram::Percentile(const std::vector<uint64_t> &counts, double q){
+    uint64_t total = 0;
+    for(auto c: counts)
+      total += c;
+    if(!total)
+      return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    if(!rank)
+      rank = 1;
+    uint64_t acc = 0;
+    for(size_t i = 0; i < counts.size(); i++){
+      acc += counts[i];
+      if(acc >= rank)
+	return BucketValue(i);
+    }
+    return BucketValue(counts.size() - 1);
+  }
+
+  void MetricHistogram::Reset(){
+    for(auto &b: m_buckets)
+      b.store(0, std::memory_order_relaxed);
+  }
+
+  MetricStage::MetricStage(const std::string &name)
+    :m_name(name), m_queue(0){
+  }
+
+  void MetricStage::Reset(){
+    m_events.Reset();
+    m_bytes.Reset();
+    m_latency.Reset();
+    m_queue.store(0, std::memory_order_relaxed);
+  }
+
+  Metrics &Metrics::Instance(){
+    static Metrics metrics;
+    return metrics;
+  }
+
+  MetricStage &Metrics::Stage(const std::string &name){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    auto &st = m_stages[name];
+    if(!st)
+      st.reset(new MetricStage(name));
+    return *st;
+  }
+
+  std::vector<MetricStage*> Metrics::Stages(){
+    std::vector<MetricStage*> stages;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &e: m_stages)
+      stages.push_back(e.second.get());
+    return stages;
+  }
+
+  MetricGauge &Metrics::Gauge(const std::string &name){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    auto &g = m_gauges[name];
+    if(!g)
+      g.reset(new MetricGauge);
+    return *g;
+  }
+
+  std::map<std::string, const MetricGauge*> Metrics::Gauges(){
+    std::map<std::string, const MetricGauge*> gauges;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &e: m_gauges)
+      gauges[e.first] = e.second.get();
+    return gauges;
+  }
+
+  void Metrics::Reset(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    for(auto &e: m_stages)
+      e.second->Reset();
+    for(auto &e: m_gauges)
+      e.second->Set(0);
+  }
+
+  const std::string MetricsPublisher::TAG_PREFIX = "_PERF_";
+
+  MetricsPublisher::MetricsPublisher()
+    :m_interval(1000), m_tp_last(std::chrono::steady_clock::now()){
+  }
+
+  bool MetricsPublisher::IsDue() const{
+    return std::chrono::steady_clock::now() - m_tp_last >= m_interval;
+  }
+
+  void MetricsPublisher::Publish(const std::function<void(const std::string&, const std::string&)> &tag){
+    auto tp_now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(tp_now - m_tp_last).count();
+    m_tp_last = tp_now;
+    if(dt <= 0)
+      return;
+    std::vector<uint64_t> counts;
+    for(auto st: Metrics::Instance().Stages()){
+      Last &last = m_last[st->Name()];
+      uint64_t events = st->Events().Get();
+      uint64_t bytes = st->Bytes().Get();
+      st->Latency().Snapshot(counts);
+      if(last.latency.size() != counts.size())
+	last.latency.assign(counts.size(), 0);
+      std::vector<uint64_t> delta(counts.size());
+      for(size_t i = 0; i < counts.size(); i++)
+	delta[i] = counts[i] >= last.latency[i] ? counts[i] - last.latency[i] : counts[i];
+      uint64_t d_events = events >= last.events ? events - last.events : events;
+      uint64_t d_bytes = bytes >= last.bytes ? bytes - last.bytes : bytes;
+      last.events = events;
+      last.bytes = bytes;
+      last.latency.swap(counts);
+      if(!events && !st->Queue())
+	continue;
+      char buf[128];
+      std::snprintf(buf, sizeof(buf), "evt/s=%.1f MB/s=%.3f queue=%lld p99_us=%.1f",
+		    d_events / dt, d_bytes / dt / 1e6,
+		    static_cast<long long>(st->Queue()),
+		    MetricHistogram::Percentile(delta, 0.99) / 1e3);
+      tag(TAG_PREFIX + st->Name(), buf);
+    }
+  }
+
+}
@@ -0,0 +1,247 @@
+#include "eudaq/MetricsServer.hh"
+#include "eudaq/Metrics.hh"
+#include "eudaq/TransportTCP.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+#include "eudaq/Utils.hh"
+
+#include <cstring>
+#include <sstream>
+
+#if EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW)
+#include "TransportTCP_WIN32.hh"
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include "TransportTCP_POSIX.hh"
+#endif
+
+namespace eudaq {
+
+  namespace {
+#ifdef MSG_NOSIGNAL
+    static const int FLAGS = MSG_NOSIGNAL;
+#else
+    static const int FLAGS = 0;
+#endif
+    static const double QUANTILES[] = {0.5, 0.9, 0.99};
+
+    std::string Label(const std::string &v){
+      std::string out;
+      for(auto c: v){
+	if(c == '\\' || c == '"')
+	  out += '\\';
+	if(c == '\n')
+	  out += "\\n";
+	else
+	  out += c;
+      }
+      return out;
+    }
+  }
+
+  const std::string MetricsServer::CONTENT_TYPE =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+  MetricsServer::MetricsServer()
+    :m_port(0), m_srvsock(-1), m_stop(false){
+  }
+
+  MetricsServer::~MetricsServer(){
+    Stop();
+  }
+
+  void MetricsServer::Start(const std::string &addr, const std::string &process){
+    Stop();
+    std::string host = "127.0.0.1";
+    std::string port = addr;
+    size_t i = addr.rfind(':');
+    if(i != std::string::npos){
+      host = trim(addr.substr(0, i));
+      port = addr.substr(i + 1);
+    }
+    m_port = static_cast<uint16_t>(from_string(trim(port), 0));
+    m_process = process;
+
+    SOCKET sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(sock == (SOCKET)-1)
+      EUDAQ_THROW(LastSockErrorString("MetricsServer:: Failed to create socket"));
+    setup_socket(sock);
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(m_port);
+    if(host == "*" || host.empty())
+      sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    else if(inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1){
+      closesocket(sock);
+      EUDAQ_THROW("MetricsServer:: Invalid address: " + addr);
+    }
+    if(bind(sock, (sockaddr *)&sa, sizeof sa)){
+      closesocket(sock);
+      EUDAQ_THROW(LastSockErrorString("MetricsServer:: Failed to bind socket: " + addr));
+    }
+    socklen_t len = sizeof sa;
+    getsockname(sock, (sockaddr *)&sa, &len);
+    m_port = ntohs(sa.sin_port);
+    if(listen(sock, 4)){
+      closesocket(sock);
+      EUDAQ_THROW(LastSockErrorString("MetricsServer:: Failed to listen on socket: " + addr));
+    }
+    m_srvsock = sock;
+    m_addr = host + ":" + std::to_string(m_port);
+    m_stop = false;
+    m_thd = std::thread(&MetricsServer::Serve, this);
+    EUDAQ_INFO("MetricsServer:: Serving http://" + m_addr + "/metrics");
+  }
+
+  void MetricsServer::Stop(){
+    m_stop = true;
+    if(m_thd.joinable())
+      m_thd.join();
+    if(m_srvsock != -1){
+      closesocket(static_cast<SOCKET>(m_srvsock));
+      m_srvsock = -1;
+    }
+  }
+
+  void MetricsServer::Serve(){
+    SOCKET srv = static_cast<SOCKET>(m_srvsock);
+    while(!m_stop){
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(srv, &fds);
+      timeval tv;
+      tv.tv_sec = 0;
+      tv.tv_usec = 200000;
+      int n = select(static_cast<int>(srv + 1), &fds, NULL, NULL, &tv);
+      if(n <= 0)
+	continue;
+      SOCKET peer = accept(srv, NULL, NULL);
+      if(peer == (SOCKET)-1)
+	continue;
+      Answer(peer);
+      closesocket(peer);
+    }
+  }
+
+  void MetricsServer::Answer(int64_t s){
+    SOCKET sock = static_cast<SOCKET>(s);
+    // The peer socket inherits the non-blocking mode, wait for the request
+    // line with a short timeout instead of blocking the serving thread.
+    std::string req;
+    char buf[1024];
+    for(int tries = 0; tries < 10 && req.find("\r\n") == std::string::npos; tries++){
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(sock, &fds);
+      timeval tv;
+      tv.tv_sec = 0;
+      tv.tv_usec = 100000;
+      if(select(static_cast<int>(sock + 1), &fds, NULL, NULL, &tv) <= 0)
+	continue;
+      int r = recv(sock, buf, sizeof(buf), 0);
+      if(r <= 0)
+	return;
+      req.append(buf, r);
+      if(req.size() > 8192)
+	break;
+    }
+
+    std::string status = "200 OK";
+    std::string type = CONTENT_TYPE;
+    std::string body;
+    std::istringstream line(req.substr(0, req.find("\r\n")));
+    std::string method, path;
+    line >> method >> path;
+    if(method != "GET" && method != "HEAD"){
+      status = "405 Method Not Allowed";
+      type = "text/plain";
+      body = "Only GET is supported\n";
+    }
+    else if(path != "/metrics" && path.compare(0, 9, "/metrics?") != 0){
+      status = "404 Not Found";
+      type = "text/plain";
+      body = "Metrics are served on /metrics\n";
+    }
+    else
+      body = Render(m_process);
+
+    std::string resp = "HTTP/1.0 " + status + "\r\n"
+      "Content-Type: " + type + "\r\n"
+      "Content-Length: " + std::to_string(body.size()) + "\r\n"
+      "Connection: close\r\n\r\n";
+    if(method != "HEAD")
+      resp += body;
+    size_t sent = 0;
+    for(int tries = 0; tries < 100 && sent < resp.size() && !m_stop; tries++){
+      int r = send(sock, resp.data() + sent, static_cast<int>(resp.size() - sent), FLAGS);
+      if(r > 0){
+	sent += r;
+	continue;
+      }
+      if(r < 0 && LastSockError() != EUDAQ_ERROR_Resource_temp_unavailable)
+	return;
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(sock, &fds);
+      timeval tv;
+      tv.tv_sec = 0;
+      tv.tv_usec = 100000;
+      select(static_cast<int>(sock + 1), NULL, &fds, NULL, &tv);
+    }
+  }
+
+  std::string MetricsServer::Render(const std::string &process){
+    std::string proc;
+    if(!process.empty())
+      proc = "process=\"" + Label(process) + "\",";
+    auto stages = Metrics::Instance().Stages();
+    std::ostringstream os;
+    os.precision(9);
+
+    os << "# TYPE eudaq_events counter\n"
+       << "# HELP eudaq_events Events processed by a stage of the data path.\n";
+    for(auto st: stages)
+      os << "eudaq_events_total{" << proc << "stage=\"" << Label(st->Name()) << "\"} "
+	 << st->Events().Get() << "\n";
+
+    os << "# TYPE eudaq_bytes counter\n"
+       << "# UNIT eudaq_bytes bytes\n"
+       << "# HELP eudaq_bytes Bytes handled by a stage of the data path.\n";
+    for(auto st: stages)
+      os << "eudaq_bytes_total{" << proc << "stage=\"" << Label(st->Name()) << "\"} "
+	 << st->Bytes().Get() << "\n";
+
+    os << "# TYPE eudaq_queue_depth gauge\n"
+       << "# HELP eudaq_queue_depth Entries waiting in the queue feeding a stage.\n";
+    for(auto st: stages)
+      os << "eudaq_queue_depth{" << proc << "stage=\"" << Label(st->Name()) << "\"} "
+	 << st->Queue() << "\n";
+
+    os << "# TYPE eudaq_latency_seconds summary\n"
+       << "# UNIT eudaq_latency_seconds seconds\n"
+       << "# HELP eudaq_latency_seconds Per-event processing time of a stage.\n";
+    std::vector<uint64_t> counts;
+    for(auto st: stages){
+      st->Latency().Snapshot(counts);
+      uint64_t n = 0;
+      for(auto c: counts)
+	n += c;
+      std::string lb = proc + "stage=\"" + Label(st->Name()) + "\"";
+      for(auto q: QUANTILES)
+	os << "eudaq_latency_seconds{" << lb << ",quantile=\"" << q << "\"} "
+	   << MetricHistogram::Percentile(counts, q) / 1e9 << "\n";
+      os << "eudaq_latency_seconds_count{" << lb << "} " << n << "\n";
+    }
+
+    for(auto &g: Metrics::Instance().Gauges()){
+      std::string name = "eudaq_" + g.first;
+      os << "# TYPE " << name << " gauge\n";
+      os << name << (proc.empty() ? "" : "{" + proc.substr(0, proc.size() - 1) + "}")
+	 << " " << g.second->Get() << "\n";
+    }
+    os << "# EOF\n";
+    return os.str();
+  }
+
+}
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 
 #if !defined(__GNUC__) || (__GNUC__ > 5) || (__GNUC__ == 5 && (__GNUC_MINOR__ > 2))
 #define EUDAQ_CXX17_FS
@@ -38,6 +40,15 @@ namespace filesystem = std::experimental::filesystem;
 namespace eudaq{
   namespace {
     auto dummy = ModuleManager::Instance();
+    // IDs registered while a module is indexed by this thread
+    thread_local std::set<uint32_t> *t_registered = nullptr;
+
+    bool IsYes(const char *env){
+      if(!env)
+	return false;
+      std::string str(env);
+      return str == "YES" || str == "yes" || str == "1";
+    }
   }
 
   ModuleManager::ModuleManager(){
@@ -49,26 +60,23 @@ namespace eudaq{
       	std::string dir;
       	std::getline(ss,dir,':');
       	if(!dir.empty()){
-      	  LoadModuleDir(dir);
+      	  m_dirs.push_back(dir);
       	}
       }
     }
-    char *env_module_ignore_default = std::getenv("EUDAQ_MODULE_IGNORE_DEFALUT");
-    if(env_module_ignore_default){
-      std::string env_ignore_default(env_module_ignore_default);
-      if(env_ignore_default == "YES" || env_ignore_default == "yes" || env_ignore_default == "1")
-	return;
-    }
-
-    std::string core_lib_path_str = GetModulePath();
+    m_load_all = IsYes(std::getenv("EUDAQ_MODULE_LOAD_ALL"));
+    if(!IsYes(std::getenv("EUDAQ_MODULE_IGNORE_DEFALUT"))){
+      std::string core_lib_path_str = GetModulePath();
 #ifdef EUDAQ_CXX17_FS
-    filesystem::path core_lib_dir = filesystem::path(core_lib_path_str).parent_path();
-    LoadModuleDir(core_lib_dir.string());
+      filesystem::path core_lib_dir = filesystem::path(core_lib_path_str).parent_path();
+      m_dirs.push_back(core_lib_dir.string());
 #else
-    std::string core_lib_dir_str = core_lib_path_str.substr(0, core_lib_path_str.find_last_of("/\\"));
-    LoadModuleDir(core_lib_dir_str);
+      std::string core_lib_dir_str = core_lib_path_str.substr(0, core_lib_path_str.find_last_of("/\\"));
+      m_dirs.push_back(core_lib_dir_str);
 #endif
-
+    }
+    if(m_load_all)
+      Scan();
   }
 
   ModuleManager* ModuleManager::Instance(){
@@ -76,6 +84,50 @@ namespace eudaq{
     return &mm;
   }
 
+  std::recursive_mutex& ModuleManager::FactoryMutex(){
+    static std::recursive_mutex mtx;
+    return mtx;
+  }
+
+  void ModuleManager::Registered(uint32_t id){
+    if(t_registered)
+      t_registered->insert(id);
+  }
+
+  std::string ModuleManager::GetIndexPath(const std::string& file){
+    return file + ".idx";
+  }
+
+  void ModuleManager::Scan(){
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
+    if(m_scanned)
+      return;
+    m_scanned = true;
+    for(auto &dir: m_dirs)
+      LoadModuleDir(dir);
+  }
+
+  bool ModuleManager::LoadModuleFor(uint32_t id){
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
+    Scan();
+    bool loaded = false;
+    auto range = m_index.equal_range(id);
+    for(auto it = range.first; it != range.second; ++it){
+      if(!m_modules.count(it->second) && LoadModuleFile(it->second))
+	loaded = true;
+    }
+    return loaded;
+  }
+
+  void ModuleManager::LoadAllModules(){
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
+    Scan();
+    for(auto &e: m_index){
+      if(!m_modules.count(e.second))
+	LoadModuleFile(e.second);
+    }
+  }
+
   uint32_t ModuleManager::LoadModuleDir(const std::string& dir){
     const std::string module_prefix("libeudaq_module_");
 #if EUDAQ_PLATFORM_IS(WIN32)
@@ -86,7 +138,7 @@ namespace eudaq{
     const std::string module_suffix(".so");
 #endif
 
-    uint32_t n=0;
+    std::vector<std::string> files;
 #ifdef EUDAQ_CXX17_FS
     if(!filesystem::is_directory(dir)){
       EUDAQ_INFO("Ignored module path which does not exist: "+dir);
@@ -96,10 +148,9 @@ namespace eudaq{
       filesystem::path file(e);
       std::string fname = file.filename().string();
       if(!fname.compare(0, module_prefix.size(), module_prefix)
-	 && (fname.find(module_suffix) != std::string::npos)){
-	if(LoadModuleFile(file.string())){
-	  n++;
-	}
+	 && (fname.find(module_suffix) != std::string::npos)
+	 && fname.find(GetIndexPath(module_suffix)) == std::string::npos){
+	files.push_back(file.string());
       }
     }
 #else
@@ -108,26 +159,89 @@ namespace eudaq{
     while((dfile = readdir(dpath)) != NULL){
       std::string fname(dfile->d_name);
       if(!fname.compare(0, module_prefix.size(), module_prefix)
-	 && (fname.find(module_suffix) != std::string::npos)){
-	if(LoadModuleFile(fname)){
-	  n++;
-	}
+	 && (fname.find(module_suffix) != std::string::npos)
+	 && fname.find(GetIndexPath(module_suffix)) == std::string::npos){
+	files.push_back(dir + "/" + fname);
       }
     }
     closedir(dpath);
 #endif
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
+    uint32_t n=0;
+    for(auto &file: files){
+      if(m_modules.count(file))
+	continue;
+      if((!m_load_all && ReadModuleIndex(file)) || LoadModuleFile(file)){
+	n++;
+      }
+    }
     return n;
   }
 
+  bool ModuleManager::ReadModuleIndex(const std::string& file){
+    std::string index = GetIndexPath(file);
+    std::ifstream in(index);
+    if(!in.is_open())
+      return false;
+#ifdef EUDAQ_CXX17_FS
+    if(filesystem::last_write_time(index) < filesystem::last_write_time(file)){
+      EUDAQ_WARN("Module index is older than the module, loading it: "+ file);
+      return false;
+    }
+#endif
+    std::vector<uint32_t> ids;
+    std::string line;
+    while(std::getline(in, line)){
+      if(line.empty() || line[0] == '#')
+	continue;
+      try{
+	ids.push_back(std::stoul(line));
+      }
+      catch(const std::exception&){
+	EUDAQ_WARN("Invalid module index, loading the module: "+ index);
+	return false;
+      }
+    }
+    for(auto id: ids)
+      m_index.emplace(id, file);
+    return true;
+  }
+
+  bool ModuleManager::WriteModuleIndex(const std::string& file){
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
+#if !EUDAQ_PLATFORM_IS(WIN32)
+    // the static initialisers of a loaded module do not run again
+    void *loaded = dlopen(file.c_str(), RTLD_NOW | RTLD_NOLOAD);
+    if(loaded){
+      dlclose(loaded);
+      EUDAQ_WARN("Module is loaded already, can not index it: "+ file);
+      return false;
+    }
+#endif
+    std::set<uint32_t> ids;
+    t_registered = &ids;
+    bool ok = LoadModuleFile(file);
+    t_registered = nullptr;
+    if(!ok)
+      return false;
+    std::ofstream out(GetIndexPath(file));
+    out<< "# factory IDs registered by "<< file<< "\n";
+    for(auto id: ids)
+      out<< id<< "\n";
+    return bool(out);
+  }
+
   bool ModuleManager::LoadModuleFile(const std::string& file){
+    std::lock_guard<std::recursive_mutex> lk(FactoryMutex());
     void *handle;
 #if EUDAQ_PLATFORM_IS(WIN32)
     handle = (void *)LoadLibrary(file.c_str());
 #else
     handle = dlopen(file.c_str(), RTLD_NOW);
 #endif
+    // a failed module is kept with a null handle and not tried again
+    m_modules[file]=handle;
     if(handle){
-      m_modules[file]=handle;
       return true;
     }
     else{
@@ -183,6 +297,17 @@ namespace eudaq{
       os<< "</Status>\n";
       os<< std::string(offset+2, ' ')<< "</Module>\n";
     }
+    std::set<std::string> indexed;
+    for(auto &e : m_index){
+      if(!m_modules.count(e.second))
+	indexed.insert(e.second);
+    }
+    for(auto &e : indexed){
+      os<< std::string(offset+2, ' ')<< "<Module>\n";
+      os<< std::string(offset+4, ' ')<< "<Path>" <<e << "</Path>";
+      os<< std::string(offset+4, ' ')<< "<Status> Indexed</Status>\n";
+      os<< std::string(offset+2, ' ')<< "</Module>\n";
+    }
     os << std::string(offset, ' ')<< "</Modules>\n";
   }
 }
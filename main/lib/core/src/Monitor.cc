@@ -4,6 +4,7 @@
 #include "eudaq/BufferSerializer.hh"
 #include "eudaq/Logger.hh"
 #include "eudaq/Utils.hh"
+#include "eudaq/Trace.hh"
 #include <iostream>
 #include <ostream>
 #include <ctime>
@@ -15,7 +16,8 @@ namespace eudaq {
   Factory<Monitor>::Instance<const std::string&, const std::string&>(); //TODO
   
   Monitor::Monitor(const std::string &name, const std::string &runcontrol)
-    :m_evt_c(0),CommandReceiver("Monitor", name, runcontrol){
+    :m_evt_c(0),CommandReceiver("Monitor", name, runcontrol),
+     m_st_mon(Metrics::Instance().Stage("monitor")){
   }
 
   void Monitor::DoInitialise(){
@@ -134,6 +136,8 @@ namespace eudaq {
 
   void Monitor::OnReceive(ConnectionSPC id, EventSP ev){
     m_evt_c ++;
+    MetricTimer timer(m_st_mon);
+    EUDAQ_TRACE_SCOPE("Monitor::DoReceive");
     DoReceive(ev);
   }
   
@@ -1,5 +1,6 @@
 #include "Processor.hh"
 #include "Utils.hh"
+#include "Trace.hh"
 
 using namespace eudaq;
 
@@ -152,6 +153,7 @@ void Processor::RegisterProcessing(ProcessorSP ps, EventSPC ev){ //NOTE:: return
 }
 
 void Processor::HubProcessing(){
+  EUDAQ_TRACE_THREAD("Processor::HubProcessing " + m_description);
   while(!m_hub_go_stop){
     std::unique_lock<std::mutex> lk(m_mtx_hub);
     if(m_que_hub.empty()){
@@ -162,6 +164,7 @@ void Processor::HubProcessing(){
     EventSPC ev(m_que_hub.front().second);
     m_que_hub.pop_front();
     lk.unlock();
+    EUDAQ_TRACE_SCOPE("Processor::HubProcessing");
     ps->Processing(ev);
   }
   std::unique_lock<std::mutex> lk(m_mtx_hub);
@@ -172,6 +175,7 @@ void Processor::HubProcessing(){
 }
 
 void Processor::ConsumeEvent(){
+  EUDAQ_TRACE_THREAD("Processor::ConsumeEvent " + m_description);
   while(!m_csm_go_stop){
     std::unique_lock<std::mutex> lk(m_mtx_csm);
     if(m_que_csm.empty()){
@@ -181,6 +185,7 @@ void Processor::ConsumeEvent(){
     EventSPC ev(m_que_csm.front());
     m_que_csm.pop_front();
     lk.unlock();
+    EUDAQ_TRACE_SCOPE("Processor::ProcessEvent");
     ProcessEvent(ev);
   }
   std::unique_lock<std::mutex> lk(m_mtx_csm);
@@ -1,5 +1,6 @@
 #include "eudaq/TransportClient.hh"
 #include "eudaq/Producer.hh"
+#include "eudaq/Trace.hh"
 
 namespace eudaq {
 
@@ -9,7 +10,8 @@ namespace eudaq {
   Factory<Producer>::Instance<const std::string&, const std::string&>();  
   
   Producer::Producer(const std::string &name, const std::string &runcontrol)
-    : CommandReceiver("Producer", name, runcontrol){
+    : CommandReceiver("Producer", name, runcontrol),
+      m_st_prod(Metrics::Instance().Stage("produce")){
     m_evt_c = 0;
     m_pdc_n = str2hash(GetFullName());
   }
@@ -151,6 +153,7 @@ namespace eudaq {
   }
   
   void Producer::SendEvent(EventSP ev){
+    MetricTimer timer(m_st_prod);
     if(ev->IsBORE()){
       if(GetConfiguration())
 	ev->SetTag("EUDAQ_CONFIG", to_string(*GetConfiguration()));
@@ -161,6 +164,8 @@ namespace eudaq {
     ev->SetEventN(m_evt_c);
     m_evt_c ++;
     ev->SetDeviceN(m_pdc_n);
+    EUDAQ_TRACE_SCOPE("Producer::SendEvent");
+    EUDAQ_TRACE_FLOW_BEGIN("produce", Trace::FlowId(m_pdc_n, ev->GetRunN(), ev->GetEventN()));
     std::unique_lock<std::mutex> lk(m_mtx_sender);
     auto senders = m_senders; //hold on the ptrs
     lk.unlock();
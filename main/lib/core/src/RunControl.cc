@@ -197,6 +197,11 @@ namespace eudaq {
     SendCommand("RESET", "", id);
   }  
 
+  void RunControl::DumpTrace(const std::string &prefix){
+    EUDAQ_INFO("Processing Trace command");
+    SendCommand("TRACE", prefix);
+  }
+
   void RunControl::StartRun(){
     EUDAQ_INFO("Processing StartRun command for RUN #" + std::to_string(m_run_n));
     m_listening = false;
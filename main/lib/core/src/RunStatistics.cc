@@ -0,0 +1,178 @@
+#include "eudaq/RunStatistics.hh"
+#include "eudaq/Utils.hh"
+
+#include <cstdio>
+
+namespace eudaq {
+
+  const std::string RunStatistics::TAG_PREFIX = "_RUNSTAT";
+
+  RunStatistics::RunStatistics(){
+    Reset();
+  }
+
+  void RunStatistics::Reset(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_streams.clear();
+    m_has_ref = false;
+    m_ref = 0;
+    m_events = 0;
+    m_events_last = 0;
+    m_bytes = 0;
+    m_size_peak = 0;
+    m_tp_first = m_tp_last = std::chrono::steady_clock::now();
+  }
+
+  uint64_t RunStatistics::Size(const Event &ev){
+    uint64_t size = 0;
+    for(auto bn: ev.GetBlockNumList())
+      size += ev.GetBlock(bn).size();
+    return size;
+  }
+
+  void RunStatistics::Add(const Event &ev){
+    auto tp_now = std::chrono::steady_clock::now();
+    // the sub-events, or the event itself
+    std::vector<EventSPC> subs = ev.GetSubEvents();
+    uint64_t size = Size(ev);
+    std::unique_lock<std::mutex> lk(m_mtx);
+    if(!m_events)
+      m_tp_first = tp_now;
+    m_events++;
+    if(subs.empty()){
+      Stream &st = m_streams[uint64_t(str2hash(ev.GetDescription())) << 32 | ev.GetDeviceN()];
+      AddStream(ev, st, size);
+    }
+    else{
+      // timestamp of the reference stream in this event
+      const Event *ref = nullptr;
+      for(auto &sub: subs){
+	uint64_t key = uint64_t(str2hash(sub->GetDescription())) << 32 | sub->GetDeviceN();
+	if(!m_has_ref && sub->IsFlagTimestamp()){
+	  m_has_ref = true;
+	  m_ref = key;
+	}
+	if(m_has_ref && key == m_ref)
+	  ref = sub.get();
+      }
+      for(auto &sub: subs){
+	uint64_t key = uint64_t(str2hash(sub->GetDescription())) << 32 | sub->GetDeviceN();
+	Stream &st = m_streams[key];
+	uint64_t sub_size = Size(*sub);
+	size += sub_size;
+	AddStream(*sub, st, sub_size);
+	if(ref && key != m_ref && ref->IsFlagTimestamp() && sub->IsFlagTimestamp())
+	  AddTimestamp(st, ref->GetTimestampBegin(), sub->GetTimestampBegin());
+      }
+    }
+    m_bytes += size;
+    if(size > m_size_peak)
+      m_size_peak = size;
+  }
+
+  void RunStatistics::AddStream(const Event &ev, Stream &st, uint64_t size){
+    if(st.name.empty())
+      st.name = ev.GetDescription() + "." + std::to_string(ev.GetDeviceN());
+    st.events++;
+    st.bytes += size;
+    if(size > st.size_peak)
+      st.size_peak = size;
+    if(ev.IsFlagTrigger()){
+      uint32_t tg = ev.GetTriggerN();
+      if(st.has_trigger){
+	if(tg > st.trigger_last + 1){
+	  st.trigger_gaps++;
+	  st.trigger_missing += tg - st.trigger_last - 1;
+	}
+	else if(tg <= st.trigger_last)
+	  st.trigger_back++;
+      }
+      st.has_trigger = true;
+      st.trigger_last = tg;
+    }
+  }
+
+  void RunStatistics::AddTimestamp(Stream &st, uint64_t ref, uint64_t ts){
+    if(!st.ts_n){
+      st.ts_x0 = ref;
+      st.ts_y0 = ts;
+    }
+    // Welford updates of the means, the variance of the reference and the
+    // covariance, stable for timestamps far from zero
+    double x = double(int64_t(ref - st.ts_x0));
+    double y = double(int64_t(ts - st.ts_y0));
+    st.ts_n++;
+    double dx = x - st.ts_mean_x;
+    st.ts_mean_x += dx / st.ts_n;
+    st.ts_mean_y += (y - st.ts_mean_y) / st.ts_n;
+    st.ts_m2_x += dx * (x - st.ts_mean_x);
+    st.ts_c_xy += dx * (y - st.ts_mean_y);
+    st.ts_offset = int64_t(ts - ref);
+  }
+
+  std::string RunStatistics::Format(const Stream &st, double rate) const {
+    char buf[256];
+    int n = std::snprintf(buf, sizeof(buf),
+			  "evt/s=%.1f complete=%.1f%% gaps=%llu missing=%llu back=%llu"
+			  " size_mean=%.0f size_peak=%llu",
+			  rate, m_events ? 100. * st.events / m_events : 0.,
+			  static_cast<unsigned long long>(st.trigger_gaps),
+			  static_cast<unsigned long long>(st.trigger_missing),
+			  static_cast<unsigned long long>(st.trigger_back),
+			  st.events ? double(st.bytes) / st.events : 0.,
+			  static_cast<unsigned long long>(st.size_peak));
+    if(st.ts_n >= 2 && st.ts_m2_x > 0 && n > 0 && size_t(n) < sizeof(buf))
+      std::snprintf(buf + n, sizeof(buf) - n, " drift_ppm=%.3f offset=%lld",
+		    (st.ts_c_xy / st.ts_m2_x - 1) * 1e6,
+		    static_cast<long long>(st.ts_offset));
+    return buf;
+  }
+
+  void RunStatistics::Publish(const std::function<void(const std::string&, const std::string&)> &tag){
+    auto tp_now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lk(m_mtx);
+    double dt = std::chrono::duration<double>(tp_now - m_tp_last).count();
+    m_tp_last = tp_now;
+    if(dt <= 0 || !m_events)
+      return;
+    for(auto &e: m_streams){
+      Stream &st = e.second;
+      tag(TAG_PREFIX + "_" + st.name, Format(st, (st.events - st.events_last) / dt));
+      st.events_last = st.events;
+    }
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "evt/s=%.1f events=%llu size_mean=%.0f size_peak=%llu",
+		  (m_events - m_events_last) / dt,
+		  static_cast<unsigned long long>(m_events),
+		  double(m_bytes) / m_events,
+		  static_cast<unsigned long long>(m_size_peak));
+    m_events_last = m_events;
+    tag(TAG_PREFIX, buf);
+  }
+
+  std::map<std::string, std::string> RunStatistics::Summary() const {
+    std::map<std::string, std::string> summary;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    if(!m_events)
+      return summary;
+    // averages over the run
+    double dt = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_tp_first).count();
+    if(dt <= 0)
+      dt = 1;
+    std::string prefix = TAG_PREFIX.substr(1);
+    for(auto &e: m_streams){
+      const Stream &st = e.second;
+      summary[prefix + "_" + st.name] = "events=" + std::to_string(st.events) + " "
+	+ Format(st, st.events / dt);
+    }
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "evt/s=%.1f events=%llu size_mean=%.0f size_peak=%llu",
+		  m_events / dt,
+		  static_cast<unsigned long long>(m_events),
+		  double(m_bytes) / m_events,
+		  static_cast<unsigned long long>(m_size_peak));
+    summary[prefix] = buf;
+    return summary;
+  }
+
+}
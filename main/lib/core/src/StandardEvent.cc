@@ -67,4 +67,9 @@ namespace eudaq {
     m_planes.push_back(plane);
     return m_planes.back();
   }
+
+  StandardPlane &StandardEvent::AddPlane(StandardPlane &&plane) {
+    m_planes.push_back(std::move(plane));
+    return m_planes.back();
+  }
 }
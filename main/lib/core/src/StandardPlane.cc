@@ -41,7 +41,18 @@ namespace eudaq{
     ser.write(m_flags);
     ser.write(m_pivotpixel);
     ser.write(m_pix);
-    ser.write(m_waveform);
+    if(m_waveform_src.empty())
+      ser.write(m_waveform);
+    else{
+      // references are expanded, the stored format has one waveform per pixel
+      std::vector<std::vector<std::vector<double>>> waveform(m_waveform.size());
+      for(uint32_t f = 0; f < m_waveform.size(); ++f){
+	waveform[f].reserve(m_waveform[f].size());
+	for(uint32_t i = 0; i < m_waveform[f].size(); ++i)
+	  waveform[f].push_back(m_waveform[f][WaveformIndex(i, f)]);
+      }
+      ser.write(waveform);
+    }
     ser.write(m_waveform_x0);
     ser.write(m_waveform_dx);
     ser.write(m_x);
@@ -81,6 +92,7 @@ namespace eudaq{
     m_waveform_x0.resize(frames);
     m_waveform_dx.resize(frames);
     m_auxinfo.resize(frames);
+    m_waveform_src.clear();
     m_time.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
     m_x.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
     m_y.resize(GetFlags(FLAG_DIFFCOORDS) ? frames : 1);
@@ -115,6 +127,8 @@ namespace eudaq{
     m_waveform_x0[frame].push_back(0);
     m_waveform_dx[frame].push_back(0);
     m_auxinfo[frame].push_back("");
+    if (frame < m_waveform_src.size() && !m_waveform_src[frame].empty())
+      m_waveform_src[frame].push_back(m_waveform_src[frame].size());
     m_time[frame].push_back(time_ps);
     if (m_pivot.size())
       m_pivot[frame].push_back(pivot);
@@ -122,6 +136,36 @@ namespace eudaq{
     // ";" << m_pix[0].size() << ", " << m_pivot.size() << std::endl;
   }
 
+  void StandardPlane::Reserve(uint32_t npix, uint32_t frame) {
+    if (frame >= m_pix.size() || frame >= m_x.size())
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " in Reserve");
+    m_x[frame].reserve(npix);
+    m_y[frame].reserve(npix);
+    m_pix[frame].reserve(npix);
+    m_time[frame].reserve(npix);
+    m_waveform[frame].reserve(npix);
+    m_waveform_x0[frame].reserve(npix);
+    m_waveform_dx[frame].reserve(npix);
+    m_auxinfo[frame].reserve(npix);
+    if (frame < m_pivot.size())
+      m_pivot[frame].reserve(npix);
+  }
+
+  void StandardPlane::PushPixelsHelper(size_t n, uint32_t frame) {
+    if (frame >= m_pix.size() || frame >= m_x.size())
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " in PushPixels");
+    size_t npix = m_pix[frame].size() + n;
+    m_waveform[frame].resize(npix);
+    m_waveform_x0[frame].resize(npix);
+    m_waveform_dx[frame].resize(npix);
+    m_auxinfo[frame].resize(npix);
+    if (frame < m_waveform_src.size() && !m_waveform_src[frame].empty())
+      while (m_waveform_src[frame].size() < npix)
+	m_waveform_src[frame].push_back(m_waveform_src[frame].size());
+    if (frame < m_pivot.size())
+      m_pivot[frame].resize(npix);
+  }
+
   void StandardPlane::SetPixelAuxInfo(uint32_t index, std::string  aux_info, uint32_t frame) {
     if(frame > m_x.size()) {
       EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetPixelAuxInfo");
@@ -146,6 +190,35 @@ namespace eudaq{
     m_waveform.at(frame).at(index) = std::move(waveform);
     m_waveform_x0.at(frame).at(index) = x0;
     m_waveform_dx.at(frame).at(index) = dx;
+    if (frame < m_waveform_src.size() && !m_waveform_src[frame].empty())
+      m_waveform_src[frame][index] = index;
+  }
+
+  void StandardPlane::SetWaveformReference(uint32_t index, uint32_t source, uint32_t frame) {
+    if (frame >= m_waveform.size()) {
+      EUDAQ_THROW("Bad frame number " + to_string(frame) + " in SetWaveformReference");
+    }
+    if (index >= m_waveform[frame].size() || source >= m_waveform[frame].size()) {
+      EUDAQ_THROW("Bad pixel index " + to_string(index) + " in SetWaveformReference");
+    }
+    if (m_waveform_src.size() < m_waveform.size())
+      m_waveform_src.resize(m_waveform.size());
+    std::vector<uint32_t> &src = m_waveform_src[frame];
+    if (src.empty()) {
+      src.resize(m_waveform[frame].size());
+      for (uint32_t i = 0; i < src.size(); ++i)
+	src[i] = i;
+    }
+    src[index] = src[source];
+    m_waveform[frame][index] = std::vector<double>();
+    m_waveform_x0[frame][index] = m_waveform_x0[frame][source];
+    m_waveform_dx[frame][index] = m_waveform_dx[frame][source];
+  }
+
+  uint32_t StandardPlane::WaveformIndex(uint32_t index, uint32_t frame) const {
+    if (frame < m_waveform_src.size() && !m_waveform_src[frame].empty())
+      return m_waveform_src[frame].at(index);
+    return index;
   }
 
   void StandardPlane::SetPixelHelper(uint32_t index, uint32_t x, uint32_t y,
@@ -167,6 +240,9 @@ namespace eudaq{
     if (frame < m_waveform.size()) {
       m_waveform.at(frame).at(index) = std::vector<double>();
     }
+    if (frame < m_waveform_src.size() && !m_waveform_src[frame].empty()) {
+      m_waveform_src[frame].at(index) = index;
+    }
     if (frame < m_waveform_x0.size()) {
       m_waveform_x0.at(frame).at(index) = 0.;
     }
@@ -202,11 +278,11 @@ namespace eudaq{
   }
 
   bool StandardPlane::HasWaveform(uint32_t index, uint32_t frame) const {
-    return !m_waveform.at(frame).at(index).empty();
+    return !m_waveform.at(frame).at(WaveformIndex(index, frame)).empty();
   }
 
   std::vector<double> StandardPlane::GetWaveform(uint32_t index, uint32_t frame) const {
-    return m_waveform.at(frame).at(index);
+    return m_waveform.at(frame).at(WaveformIndex(index, frame));
   }
   double StandardPlane::GetWaveformX0(uint32_t index, uint32_t frame) const {
     return m_waveform_x0.at(frame).at(index);
@@ -217,11 +293,15 @@ namespace eudaq{
 
   bool StandardPlane::HasWaveform(uint32_t index) const {
     SetupResult();
+    if (m_result_waveform_src)
+      index = m_result_waveform_src->at(index);
     return !m_result_waveform->at(index).empty();
   }
 
   std::vector<double> StandardPlane::GetWaveform(uint32_t index) const {
     SetupResult();
+    if (m_result_waveform_src)
+      index = m_result_waveform_src->at(index);
     return m_result_waveform->at(index);
   }
   double StandardPlane::GetWaveformX0(uint32_t index) const {
@@ -359,6 +439,7 @@ namespace eudaq{
     m_result_y = &m_y[0];
     m_result_time = &m_time[0];
     m_result_waveform = &m_waveform[0];
+    m_result_waveform_src = (m_waveform_src.size() && m_waveform_src[0].size()) ? &m_waveform_src[0] : nullptr;
     m_result_waveform_x0 = &m_waveform_x0[0];
     m_result_waveform_dx = &m_waveform_dx[0];
     m_result_auxinfo = &m_auxinfo[0];
@@ -389,6 +470,7 @@ namespace eudaq{
       m_result_pix = &m_temp_pix;
       m_result_time = & m_temp_time;
       m_result_waveform = &m_temp_waveform;
+      m_result_waveform_src = nullptr;
       m_result_waveform_x0 = &m_temp_waveform_x0;
       m_result_waveform_dx = &m_temp_waveform_dx;
       m_result_auxinfo = &m_temp_auxinfo;
@@ -451,6 +533,7 @@ namespace eudaq{
           m_result_x = &m_temp_x;
           m_result_y = &m_temp_y;
           m_result_time = &m_temp_time;
+          m_result_waveform_src = nullptr;
         }
         m_result_pix = &m_temp_pix;
         m_result_waveform = &m_temp_waveform;
@@ -1,4 +1,5 @@
 #include "eudaq/StdEventConverter.hh"
+#include "eudaq/Metrics.hh"
 
 namespace eudaq{
 
@@ -44,6 +45,8 @@ namespace eudaq{
     uint32_t id = d1->GetType();
     auto cvt = Factory<StdEventConverter>::MakeUnique(id);
     if(cvt){
+      static MetricStage &st_cvt = Metrics::Instance().Stage("convert");
+      MetricTimer timer(st_cvt);
       return cvt->Converting(d1, d2, conf);
     }
     else{
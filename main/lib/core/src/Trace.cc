@@ -0,0 +1,198 @@
+#include "eudaq/Trace.hh"
+#include "eudaq/Exception.hh"
+#include "eudaq/Logger.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+
+#if EUDAQ_PLATFORM_IS(WIN32) || EUDAQ_PLATFORM_IS(MINGW)
+#include <process.h>
+#define EUDAQ_TRACE_GETPID _getpid
+#else
+#include <unistd.h>
+#define EUDAQ_TRACE_GETPID getpid
+#endif
+
+namespace eudaq {
+
+  namespace {
+    static const std::chrono::steady_clock::time_point TP_START = std::chrono::steady_clock::now();
+    static volatile std::sig_atomic_t s_dump_requested = 0;
+
+    extern "C" void TraceSignalHandler(int){
+      s_dump_requested = 1;
+    }
+
+    std::string Escape(const std::string &s){
+      std::string out;
+      for(auto c: s){
+	if(c == '"' || c == '\\')
+	  out += '\\';
+	if(static_cast<unsigned char>(c) < 0x20)
+	  continue;
+	out += c;
+      }
+      return out;
+    }
+  }
+
+  TraceRing::TraceRing(size_t capacity, uint32_t tid)
+    :m_rec(capacity ? capacity : 1), m_head(0), m_tid(tid){
+  }
+
+  void TraceRing::Snapshot(std::vector<TraceRecord> &out) const{
+    const uint64_t cap = m_rec.size();
+    uint64_t h1 = m_head.load(std::memory_order_acquire);
+    uint64_t first = h1 > cap ? h1 - cap : 0;
+    std::vector<TraceRecord> rec;
+    rec.reserve(h1 - first);
+    for(uint64_t i = first; i < h1; i++)
+      rec.push_back(m_rec[i % cap]);
+    // drop what the owning thread overwrote meanwhile, including the slot it
+    // may be writing right now
+    uint64_t h2 = m_head.load(std::memory_order_acquire);
+    uint64_t valid = h2 + 1 > cap ? h2 + 1 - cap : 0;
+    for(uint64_t i = first; i < h1; i++)
+      if(i >= valid)
+	out.push_back(rec[i - first]);
+  }
+
+  std::string TraceRing::Name() const{
+    std::unique_lock<std::mutex> lk(m_mtx_name);
+    return m_name;
+  }
+
+  void TraceRing::SetName(const std::string &name){
+    std::unique_lock<std::mutex> lk(m_mtx_name);
+    m_name = name;
+  }
+
+  Trace::Trace()
+    :m_capacity(16384), m_next_tid(1){
+  }
+
+  Trace &Trace::Instance(){
+    static Trace trace;
+    return trace;
+  }
+
+  uint64_t Trace::Now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now() - TP_START).count();
+  }
+
+  uint64_t Trace::FlowId(uint32_t device, uint32_t run, uint32_t event){
+    return ((uint64_t(device) << 32) ^ (uint64_t(run) << 48)) + event;
+  }
+
+  TraceRing &Trace::Ring(){
+    // hands the ring back when the thread exits
+    struct Holder{
+      std::shared_ptr<TraceRing> ring;
+      ~Holder(){
+	if(ring)
+	  Trace::Instance().Release(std::move(ring));
+      }
+    };
+    thread_local TraceRing *ring = nullptr;
+    if(!ring){
+      thread_local Holder holder;
+      holder.ring = Acquire();
+      ring = holder.ring.get();
+    }
+    return *ring;
+  }
+
+  std::shared_ptr<TraceRing> Trace::Acquire(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    while(!m_free.empty()){
+      std::shared_ptr<TraceRing> ring = std::move(m_free.back());
+      m_free.pop_back();
+      if(ring->Capacity() == (m_capacity ? m_capacity : 1)){
+	ring->SetName("");
+	return ring;
+      }
+      // sized before SetCapacity, the new size applies to it as well
+      m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring), m_rings.end());
+    }
+    m_rings.push_back(std::make_shared<TraceRing>(m_capacity, m_next_tid++));
+    return m_rings.back();
+  }
+
+  void Trace::Release(std::shared_ptr<TraceRing> ring){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_free.push_back(std::move(ring));
+  }
+
+  void Trace::SetCapacity(size_t n){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_capacity = n;
+  }
+
+  void Trace::Dump(const std::string &path){
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    rings = m_rings;
+    lk.unlock();
+
+    std::ofstream os(path);
+    if(!os.is_open())
+      EUDAQ_THROW("Trace: unable to open " + path);
+    const long pid = static_cast<long>(EUDAQ_TRACE_GETPID());
+    char buf[256];
+    bool first = true;
+    auto sep = [&](){
+      if(!first)
+	os << ",\n";
+      first = false;
+    };
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    std::vector<TraceRecord> rec;
+    for(auto &ring: rings){
+      std::string name = ring->Name();
+      if(!name.empty()){
+	sep();
+	os << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+	   << ",\"tid\":" << ring->Tid() << ",\"args\":{\"name\":\"" << Escape(name) << "\"}}";
+      }
+      rec.clear();
+      ring->Snapshot(rec);
+      for(auto &r: rec){
+	sep();
+	if(r.ph == 'X'){
+	  std::snprintf(buf, sizeof(buf),
+			"{\"ph\":\"X\",\"cat\":\"eudaq\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"",
+			pid, ring->Tid(), r.ts / 1e3, r.dur / 1e3);
+	  os << buf << Escape(r.name) << "\"}";
+	}
+	else{
+	  // the viewers only chain flow records of the same name and category
+	  std::snprintf(buf, sizeof(buf),
+			"{\"ph\":\"%c\",\"cat\":\"event\",\"name\":\"event\",\"bp\":\"e\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"id\":\"0x%llx\",\"args\":{\"step\":\"",
+			r.ph, pid, ring->Tid(), r.ts / 1e3, static_cast<unsigned long long>(r.id));
+	  os << buf << Escape(r.name) << "\"}}";
+	}
+      }
+    }
+    os << "\n]}\n";
+    EUDAQ_INFO("Trace: written to " + path);
+  }
+
+  void Trace::InstallSignalHandler(){
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, TraceSignalHandler);
+#endif
+  }
+
+  bool Trace::DumpIfRequested(const std::string &path){
+    if(!s_dump_requested)
+      return false;
+    s_dump_requested = 0;
+    Dump(path);
+    return true;
+  }
+
+}
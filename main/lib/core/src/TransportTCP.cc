@@ -44,6 +44,7 @@ at some places we have constructions like:
 #include "eudaq/Time.hh"
 #include "eudaq/Utils.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/Trace.hh"
 
 #include <iostream>
 
@@ -297,7 +298,7 @@ namespace eudaq {
                  LastSockError() != EUDAQ_ERROR_Interrupted_function_call) {
         EUDAQ_THROW_NOLOG(LastSockErrorString("Error in select()"));
       } else if (result > 0) {
-
+        EUDAQ_TRACE_SCOPE("TCPServer::ProcessEvents");
         if (FD_ISSET(m_srvsock, &tempset)) {
           sockaddr_in addr;
           socklen_t len = sizeof(addr);
@@ -6,6 +6,35 @@ namespace eudaq{
   std::map<uint32_t, typename Factory<LCEventConverter>::UP(*)()>&
   Factory<LCEventConverter>::Instance<>();
   
+  namespace{
+    // The converters of this thread, made once per event type
+    const LCEventConverter *GetConverter(uint32_t id){
+      thread_local std::map<uint32_t, LCEventConverterUP> cvts;
+      auto it = cvts.find(id);
+      if(it == cvts.end())
+	it = cvts.emplace(id, Factory<LCEventConverter>::MakeUnique(id)).first;
+      return it->second.get();
+    }
+
+    bool ConvertSubEvent(EventSPC d1, LCEventSP d2, ConfigurationSPC conf){
+      if(d1->IsFlagFake()){
+	return true;
+      }
+      if(d1->IsFlagPacket()){
+	return LCEventConverter::Convert(d1, d2, conf);
+      }
+      // the header of the packet is already set
+      auto cvt = GetConverter(d1->GetType());
+      if(cvt){
+	return cvt->Converting(d1, d2, conf);
+      }
+      else{
+	std::cerr<<"LCEventConverter: WARNING, no converter for EventID = "<<d1<<"\n";
+	return false;
+      }
+    }
+  }
+
   bool LCEventConverter::Convert(EventSPC d1, LCEventSP d2, ConfigurationSPC conf){
     if(d1->IsFlagFake()){
       return true;
@@ -30,7 +59,7 @@ namespace eudaq{
       size_t nsub = d1->GetNumSubEvent();
       for(size_t i=0; i<nsub; i++){
 	auto subev = d1->GetSubEvent(i);
-	if(!LCEventConverter::Convert(subev, d2, conf))
+	if(!ConvertSubEvent(subev, d2, conf))
 	  return false;
       }
       d2->parameters().setValue("EventFlag", (int)(d1->GetFlag() & ~Event::Flags::FLAG_PACK));
@@ -56,8 +85,7 @@ namespace eudaq{
       }
     }
     
-    uint32_t id = d1->GetType();
-    auto cvt = Factory<LCEventConverter>::MakeUnique(id);
+    auto cvt = GetConverter(d1->GetType());
     if(cvt){
       return cvt->Converting(d1, d2, conf);
     }
@@ -2,9 +2,16 @@
 #include "eudaq/FileWriter.hh"
 #include "eudaq/Configuration.hh"
 #include "eudaq/LCEventConverter.hh"
+#include "eudaq/Logger.hh"
 #include <ostream>
 #include <ctime>
 #include <iomanip>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
 
 
 #include "lcio.h"
@@ -23,41 +30,198 @@ namespace eudaq {
     auto dummy11 = Factory<FileWriter>::Register<LCFileWriter, std::string&&>(cstr2hash("slcio"));
   }
 
+  // Events are converted in the calling thread, or by EUDAQ_FW_THREADS
+  // converter threads, and written to the file by a writer thread. A reorder
+  // buffer keeps the events in the order of WriteEvent, and WriteEvent waits
+  // while EUDAQ_FW_QUEUE events are converted or waiting to be written.
+  // Converters must be thread safe for EUDAQ_FW_THREADS > 0.
   class LCFileWriter : public FileWriter {
   public:
     LCFileWriter(const std::string &patt);
+    ~LCFileWriter() override;
     void WriteEvent(EventSPC ev) override;
   private:
+    struct Slot{
+      uint32_t run_n;
+      EventSPC ev;
+      LCEventSP lcevent;
+    };
+    void Start();
+    void Convert(Slot &slot);
+    void Converted(uint64_t seq, Slot &&slot);
+    void ConvertLoop();
+    void WriteLoop();
+    void Open(uint32_t run_n);
+
     std::unique_ptr<lcio::LCWriter> m_lcwriter;
     std::string m_filepattern;
     uint32_t m_run_n;
+
+    bool m_started = false;
+    uint32_t m_n_threads = 0;
+    uint64_t m_max_pending = 256;
+    std::mutex m_mtx;
+    std::condition_variable m_cv_input;
+    std::condition_variable m_cv_output;
+    std::condition_variable m_cv_space;
+    std::deque<std::pair<uint64_t, Slot>> m_input;
+    std::map<uint64_t, Slot> m_reorder;
+    uint64_t m_seq_in = 0;
+    uint64_t m_seq_out = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+    std::vector<std::thread> m_converters;
+    std::thread m_writer;
   };
 
   LCFileWriter::LCFileWriter(const std::string &patt){
     m_filepattern = patt;
   }
 
+  LCFileWriter::~LCFileWriter(){
+    if(!m_started)
+      return;
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_stop = true;
+    lk.unlock();
+    m_cv_input.notify_all();
+    m_cv_output.notify_all();
+    for(auto &t: m_converters)
+      t.join();
+    m_writer.join();
+    try{
+      if(m_error)
+	std::rethrow_exception(m_error);
+      if(m_lcwriter)
+	m_lcwriter->close();
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(std::string("LCFileWriter: ") + e.what());
+    }
+    catch(...){
+      EUDAQ_ERROR("LCFileWriter: unknown exception");
+    }
+  }
+
+  void LCFileWriter::Start(){
+    auto conf = GetConfiguration();
+    if(conf){
+      m_n_threads = conf->Get("EUDAQ_FW_THREADS", m_n_threads);
+      m_max_pending = conf->Get("EUDAQ_FW_QUEUE", m_max_pending);
+    }
+    if(m_max_pending == 0)
+      m_max_pending = 1;
+    for(uint32_t i = 0; i < m_n_threads; i++)
+      m_converters.emplace_back(&LCFileWriter::ConvertLoop, this);
+    m_writer = std::thread(&LCFileWriter::WriteLoop, this);
+    m_started = true;
+  }
+
   void LCFileWriter::WriteEvent(EventSPC ev) {
-    uint32_t run_n = ev->GetRunN();
-    if(!m_lcwriter || m_run_n != run_n){
-      try {
-	m_lcwriter.reset(lcio::LCFactory::getInstance()->createLCWriter());
-	std::time_t time_now = std::time(nullptr);
-	char time_buff[13];
-	time_buff[12] = 0;
-	std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
-	std::string time_str(time_buff);
-	m_lcwriter->open(FileNamer(m_filepattern).Set('R', run_n).Set('D', time_str),
-			 lcio::LCIO::WRITE_NEW);
-	m_run_n = run_n;
-      } catch (const lcio::IOException &e) {
-	EUDAQ_THROW(std::string("Fail to open LCIO file")+e.what());
+    if(!m_started)
+      Start();
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_cv_space.wait(lk, [this](){return m_error || m_seq_in - m_seq_out < m_max_pending;});
+    if(m_error)
+      std::rethrow_exception(m_error);
+    uint64_t seq = m_seq_in++;
+    Slot slot{ev->GetRunN(), ev, nullptr};
+    if(m_n_threads){
+      m_input.emplace_back(seq, std::move(slot));
+      lk.unlock();
+      m_cv_input.notify_one();
+      return;
+    }
+    lk.unlock();
+    Convert(slot);
+    Converted(seq, std::move(slot));
+  }
+
+  void LCFileWriter::Convert(Slot &slot){
+    try{
+      slot.lcevent.reset(new lcio::LCEventImpl);
+      LCEventConverter::Convert(slot.ev, slot.lcevent, GetConfiguration());
+    }
+    catch(...){
+      slot.lcevent.reset();
+      std::unique_lock<std::mutex> lk(m_mtx);
+      if(!m_error)
+	m_error = std::current_exception();
+    }
+    slot.ev.reset();
+  }
+
+  void LCFileWriter::Converted(uint64_t seq, Slot &&slot){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_reorder.emplace(seq, std::move(slot));
+    bool next = (seq == m_seq_out);
+    lk.unlock();
+    if(next)
+      m_cv_output.notify_one();
+  }
+
+  void LCFileWriter::ConvertLoop(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    while(true){
+      m_cv_input.wait(lk, [this](){return m_stop || !m_input.empty();});
+      if(m_input.empty())
+	return;
+      auto item = std::move(m_input.front());
+      m_input.pop_front();
+      lk.unlock();
+      Convert(item.second);
+      Converted(item.first, std::move(item.second));
+      lk.lock();
+    }
+  }
+
+  void LCFileWriter::WriteLoop(){
+    std::unique_lock<std::mutex> lk(m_mtx);
+    while(true){
+      m_cv_output.wait(lk, [this](){
+	  return m_reorder.count(m_seq_out) || (m_stop && m_seq_out == m_seq_in);});
+      auto it = m_reorder.find(m_seq_out);
+      if(it == m_reorder.end())
+	return;
+      Slot slot = std::move(it->second);
+      m_reorder.erase(it);
+      bool failed = bool(m_error);
+      lk.unlock();
+      if(slot.lcevent && !failed){
+	try{
+	  if(!m_lcwriter || m_run_n != slot.run_n)
+	    Open(slot.run_n);
+	  m_lcwriter->writeEvent(slot.lcevent.get());
+	}
+	catch(...){
+	  std::unique_lock<std::mutex> lk_error(m_mtx);
+	  if(!m_error)
+	    m_error = std::current_exception();
+	}
       }
+      // the LCIO event and its collections are freed here, off the converters
+      slot.lcevent.reset();
+      lk.lock();
+      m_seq_out++;
+      m_cv_space.notify_all();
+    }
+  }
+
+  void LCFileWriter::Open(uint32_t run_n){
+    try {
+      if(m_lcwriter)
+	m_lcwriter->close();
+      m_lcwriter.reset(lcio::LCFactory::getInstance()->createLCWriter());
+      std::time_t time_now = std::time(nullptr);
+      char time_buff[13];
+      time_buff[12] = 0;
+      std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
+      std::string time_str(time_buff);
+      m_lcwriter->open(FileNamer(m_filepattern).Set('R', run_n).Set('D', time_str),
+		       lcio::LCIO::WRITE_NEW);
+      m_run_n = run_n;
+    } catch (const lcio::IOException &e) {
+      EUDAQ_THROW(std::string("Fail to open LCIO file")+e.what());
     }
-    if(!m_lcwriter)
-      EUDAQ_THROW("LCFileWriter: Attempt to write unopened file");
-    LCEventSP lcevent(new lcio::LCEventImpl);
-    LCEventConverter::Convert(ev, lcevent, GetConfiguration());
-    m_lcwriter->writeEvent(lcevent.get());
   }
 }
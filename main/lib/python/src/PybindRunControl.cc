@@ -89,6 +89,8 @@ void init_pybind_runcontrol(py::module &m){
   runcontrol_.def("StopRun", &eudaq::RunControl::StopRun,py::call_guard<py::gil_scoped_release>());
   runcontrol_.def("Reset", &eudaq::RunControl::Reset,py::call_guard<py::gil_scoped_release>());
   runcontrol_.def("Terminate", &eudaq::RunControl::Terminate,py::call_guard<py::gil_scoped_release>());
+  runcontrol_.def("DumpTrace", &eudaq::RunControl::DumpTrace,py::call_guard<py::gil_scoped_release>(),
+		  "Write the trace buffers of all components", py::arg("prefix") = "");
   runcontrol_.def("ReadConfigureFile", &eudaq::RunControl::ReadConfigureFile,"",py::arg("path"));
   runcontrol_.def("ReadInitialiseFile", &eudaq::RunControl::ReadInitilizeFile,"",py::arg("path")); // take the opportunity to rename
   runcontrol_.def("DoConnect", &eudaq::RunControl::DoConnect,
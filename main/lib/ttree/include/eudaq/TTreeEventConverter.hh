@@ -6,6 +6,7 @@
 #include "eudaq/Event.hh"
 
 #include "TTree.h"
+#include "TBranch.h"
 
 
 
@@ -21,6 +22,11 @@ namespace eudaq{
   using TTreeEventSP = std::shared_ptr<TTree>;
   using TTreeEventSPC = std::shared_ptr<const TTree>;
   
+  // Adds the device specific branches of an event to the tree of the
+  // TTreeFileWriter, which sets the header and plane branches and fills
+  // the entry after the conversion. Branches must be bound to buffers which
+  // live as long as the converter, e.g. mutable members, through BindBranch;
+  // one instance per event type and thread is kept.
   class DLLEXPORT TTreeEventConverter:public DataConverter<Event, TTree>{
   public:
     TTreeEventConverter() = default;
@@ -28,18 +34,11 @@ namespace eudaq{
     TTreeEventConverter& operator = (const TTreeEventConverter&) = delete;
     bool Converting(EventSPC d1, TTreeEventSP d2, ConfigurationSPC conf) const override = 0;
     static bool Convert(EventSPC d1, TTreeEventSP d2, ConfigurationSPC conf);
-  private:
-    /*	TTree *m_ttree; // book the tree (to store the needed event info)
-	// Book variables for the Event_to_TTree conversion
-	Int_t id_plane;        // plane id, where the hit is
-	Int_t id_hit;          // the hit id (within a plane)
-	Double_t id_x;         // the hit position along  X-axis
-	Double_t id_y;         // the hit position along  Y-axis
-	unsigned i_tlu;        // a trigger id
-	unsigned run_n;        // a run  number
-	unsigned event_n;      // an event number
-	uint64_t time_stamp; // the time stamp */
-	
+  protected:
+    // Binds the branch to addr, creating it from the leaf list if the tree
+    // has none of this name yet. A branch created after the first entry gets
+    // the current content of addr for the entries before.
+    static TBranch *BindBranch(TTree *tree, const char *name, void *addr, const char *leaflist);
   };
 
 }
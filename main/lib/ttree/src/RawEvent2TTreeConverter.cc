@@ -22,14 +22,21 @@ namespace eudaq{
     }
     uint32_t id = ev->GetExtendWord();
     //    std::cout << " Sub Type " << ev->GetDescription() << std::endl;
-    auto cvt = Factory<TTreeEventConverter>::MakeUnique(id);
+    // made once per ExtendWord and thread, a missing one is reported once
+    thread_local std::map<uint32_t, TTreeEventConverterUP> cvts;
+    auto it = cvts.find(id);
+    if(it == cvts.end()){
+      it = cvts.emplace(id, Factory<TTreeEventConverter>::MakeUnique(id)).first;
+      if(!it->second)
+	EUDAQ_WARN("WARNING, no TTreeEventConverter for RawDataEvent with ExtendWord("
+		   + std::to_string(id)+ ") and Description("+ ev->GetDescription()+ ")");
+    }
+    auto &cvt = it->second;
      if(cvt){
       cvt->Converting(d1, d2, conf);
       return true;
     }
     else{
-      EUDAQ_WARN("WARNING, no TTreeEventConverter for RawDataEvent with ExtendWord("
-		 + std::to_string(id)+ ") and Description("+ ev->GetDescription()+ ")");
       return false;
     }
   }  
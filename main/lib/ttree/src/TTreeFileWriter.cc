@@ -1,16 +1,20 @@
 #include "eudaq/FileNamer.hh"
 #include "eudaq/FileWriter.hh"
 #include "eudaq/Configuration.hh"
+#include "eudaq/StdEventConverter.hh"
 #include "eudaq/TTreeEventConverter.hh"
+#include "eudaq/Logger.hh"
 #include <ostream>
 #include <ctime>
 #include <iomanip>
+#include <map>
 #include <vector>
 
 
 #include "TFile.h"
 #include "TTree.h"
-#include "TRandom.h"
+#include "TBranch.h"
+#include "TROOT.h"
 #include "TString.h"
 
 
@@ -21,57 +25,195 @@ namespace eudaq {
     auto dummy11 = Factory<FileWriter>::Register<TTreeFileWriter, std::string&&>(cstr2hash("root"));
   }
 
+  // One entry of the tree "EventTree" per event, one file per run. The
+  // header branches and the std::vector branches of each plane
+  // (plane<id>_x, _y, _value, _time) are bound once to buffers of the
+  // writer; a plane first seen after the first entry gets empty entries for
+  // the events before. The planes are those of the StandardEvent, converted
+  // by the StdEventConverters if the event is not one already; device
+  // specific branches can be added by TTreeEventConverters. Configuration:
+  //   EUDAQ_FW_ROOT_BASKET       buffer size of the branches (32000)
+  //   EUDAQ_FW_ROOT_COMPRESSION  ROOT compression setting, e.g. 101 or 505
+  //                              (-1 for the ROOT default)
+  //   EUDAQ_FW_ROOT_AUTOFLUSH    TTree::SetAutoFlush, 0 for the ROOT default
+  //   EUDAQ_FW_ROOT_IMT          threads for the implicit multithreading of
+  //                              ROOT, compressing baskets in parallel (0 off)
   class TTreeFileWriter : public FileWriter {
   public:
     TTreeFileWriter(const std::string &patt);
-    ~TTreeFileWriter();
+    ~TTreeFileWriter() override;
     void WriteEvent(EventSPC ev) override;
+    uint64_t FileBytes() const override;
   private:
-    std::unique_ptr<TFile> m_ttreewriter;
-    std::string m_filepattern;
-    uint32_t m_run_n;
-    TFile *m_tfile; // book the pointer to a file (to store the otuput)
-    TTreeEventSP ttree;
+    struct PlaneColumns{
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> value;
+      std::vector<ULong64_t> time;
     };
+    void Configure();
+    void Open(uint32_t run_n);
+    void Close();
+    PlaneColumns &Plane(uint32_t id);
+    void FillPlanes(const StandardEvent &sev);
+
+    std::string m_filepattern;
+    uint32_t m_run_n = 0;
+    std::unique_ptr<TFile> m_file;
+    TTree *m_tree = nullptr; // owned by m_file
+    TTreeEventSP m_ttree;
+
+    bool m_configured = false;
+    Int_t m_basket = 32000;
+    Int_t m_compression = -1;
+    Long64_t m_autoflush = 0;
+
+    UInt_t m_run = 0;
+    UInt_t m_event = 0;
+    UInt_t m_flag = 0;
+    UInt_t m_device = 0;
+    UInt_t m_trigger = 0;
+    ULong64_t m_tsb = 0;
+    ULong64_t m_tse = 0;
+    // node based, the branches keep the addresses of the columns
+    std::map<uint32_t, PlaneColumns> m_planes;
+  };
 
   TTreeFileWriter::TTreeFileWriter(const std::string &patt){
-    m_filepattern = patt;    
-	std::time_t time_now = std::time(nullptr);
-	char time_buff[13];
-	time_buff[12] = 0;
-	std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
-	std::string time_str(time_buff);
-	std::string foutput(FileNamer(m_filepattern).Set('X', ".root").Set('R', m_run_n).Set('D', time_str));
-	m_tfile = new TFile(foutput.c_str(), "RECREATE");
-	EUDAQ_INFO("Preparing the outputfile: " + foutput);
-	ttree.reset(new TTree("EventTree","Converted from .raw"));
-	TBranch* run   = ttree->Branch("run_n",0, "run_n/i");
-	TBranch* event = ttree->Branch("event_n",0, "event_n/i");
-	TBranch* eventflag = ttree->Branch("event_flag",0, "eflag/i");
-	TBranch* device_n = ttree->Branch("device_n",0, "devnum/i");	
-	TBranch* trigger_n = ttree->Branch("trigger_n",0, "trign/i");
-	TBranch* tsb = ttree->Branch("timestampbegin",0, "tsb/l");
-	TBranch* tse = ttree->Branch("timestampend",0, "tse/l");
+    m_filepattern = patt;
   }
-  TTreeFileWriter::~TTreeFileWriter () {
-    m_tfile->Write();    
+
+  TTreeFileWriter::~TTreeFileWriter(){
+    try{
+      Close();
+    }
+    catch(const std::exception &e){
+      EUDAQ_ERROR(std::string("TTreeFileWriter: ") + e.what());
+    }
   }
-  
-  void TTreeFileWriter::WriteEvent(EventSPC ev) {
-    uint32_t run_n = ev->GetRunN();
-    if(!m_ttreewriter || m_run_n != run_n){
-      try{
-	m_ttreewriter.reset(m_tfile);
-	m_run_n = run_n;
-      } catch(const Exception &e){
-      EUDAQ_THROW(std::string("Fail to open ROOT file")+e.what());
+
+  void TTreeFileWriter::Configure(){
+    auto conf = GetConfiguration();
+    if(conf){
+      m_basket = conf->Get("EUDAQ_FW_ROOT_BASKET", m_basket);
+      m_compression = conf->Get("EUDAQ_FW_ROOT_COMPRESSION", m_compression);
+      m_autoflush = conf->Get("EUDAQ_FW_ROOT_AUTOFLUSH", (int64_t)m_autoflush);
+      int imt = conf->Get("EUDAQ_FW_ROOT_IMT", 0);
+      if(imt > 0 && !ROOT::IsImplicitMTEnabled())
+	ROOT::EnableImplicitMT(imt);
     }
+    m_configured = true;
+  }
+
+  void TTreeFileWriter::Open(uint32_t run_n){
+    Close();
+    std::time_t time_now = std::time(nullptr);
+    char time_buff[13];
+    time_buff[12] = 0;
+    std::strftime(time_buff, sizeof(time_buff), "%y%m%d%H%M%S", std::localtime(&time_now));
+    std::string time_str(time_buff);
+    std::string foutput(FileNamer(m_filepattern).Set('X', ".root").Set('R', run_n).Set('D', time_str));
+    m_file.reset(new TFile(foutput.c_str(), "RECREATE"));
+    if(m_file->IsZombie()){
+      m_file.reset();
+      EUDAQ_THROW("Fail to open ROOT file " + foutput);
     }
-    if(!m_ttreewriter)
-      EUDAQ_THROW("TTreeFileWriter: Attempt to write unopened file");
-    uint32_t event_n = ev->GetEventN();
-    TTreeEventConverter::Convert(ev, ttree, GetConfiguration());
+    if(m_compression >= 0)
+      m_file->SetCompressionSettings(m_compression);
+    EUDAQ_INFO("Preparing the outputfile: " + foutput);
+    m_tree = new TTree("EventTree", "Converted from .raw");
+    m_tree->SetDirectory(m_file.get());
+    if(m_autoflush != 0)
+      m_tree->SetAutoFlush(m_autoflush);
+    m_tree->Branch("run_n", &m_run, "run_n/i", m_basket);
+    m_tree->Branch("event_n", &m_event, "event_n/i", m_basket);
+    m_tree->Branch("event_flag", &m_flag, "eflag/i", m_basket);
+    m_tree->Branch("device_n", &m_device, "devnum/i", m_basket);
+    m_tree->Branch("trigger_n", &m_trigger, "trign/i", m_basket);
+    m_tree->Branch("timestampbegin", &m_tsb, "tsb/l", m_basket);
+    m_tree->Branch("timestampend", &m_tse, "tse/l", m_basket);
+    // the tree belongs to the file, the converters only borrow it
+    m_ttree = TTreeEventSP(m_tree, [](TTree*){});
+    m_run_n = run_n;
   }
 
+  void TTreeFileWriter::Close(){
+    if(!m_file)
+      return;
+    m_file->cd();
+    m_tree->Write();
+    m_file->Close();
+    m_ttree.reset();
+    m_tree = nullptr;
+    m_file.reset();
+    m_planes.clear();
+  }
 
+  TTreeFileWriter::PlaneColumns &TTreeFileWriter::Plane(uint32_t id){
+    auto it = m_planes.find(id);
+    if(it != m_planes.end())
+      return it->second;
+    PlaneColumns &cols = m_planes[id];
+    std::string name = "plane" + std::to_string(id);
+    TBranch *br[4] = {
+      m_tree->Branch((name + "_x").c_str(), &cols.x, m_basket),
+      m_tree->Branch((name + "_y").c_str(), &cols.y, m_basket),
+      m_tree->Branch((name + "_value").c_str(), &cols.value, m_basket),
+      m_tree->Branch((name + "_time").c_str(), &cols.time, m_basket)};
+    // no hits in this plane for the entries before
+    for(Long64_t i = 0; i < m_tree->GetEntries(); i++)
+      for(auto b: br)
+	b->Fill();
+    return cols;
+  }
+
+  void TTreeFileWriter::FillPlanes(const StandardEvent &sev){
+    for(auto &p: m_planes){
+      p.second.x.clear();
+      p.second.y.clear();
+      p.second.value.clear();
+      p.second.time.clear();
+    }
+    for(size_t i = 0; i < sev.NumPlanes(); i++){
+      const StandardPlane &plane = sev.GetPlane(i);
+      PlaneColumns &cols = Plane(plane.ID());
+      const auto &x = plane.XVector();
+      const auto &y = plane.YVector();
+      const auto &pix = plane.PixVector();
+      cols.x.insert(cols.x.end(), x.begin(), x.end());
+      cols.y.insert(cols.y.end(), y.begin(), y.end());
+      cols.value.insert(cols.value.end(), pix.begin(), pix.end());
+      for(uint32_t j = 0; j < plane.HitPixels(); j++)
+	cols.time.push_back(plane.GetTimestamp(j));
+    }
+  }
+
+  void TTreeFileWriter::WriteEvent(EventSPC ev) {
+    if(!m_configured)
+      Configure();
+    uint32_t run_n = ev->GetRunN();
+    if(!m_file || m_run_n != run_n)
+      Open(run_n);
+    m_run = ev->GetRunN();
+    m_event = ev->GetEventN();
+    m_flag = ev->GetFlag() & ~Event::Flags::FLAG_PACK;
+    m_device = ev->GetDeviceN();
+    m_trigger = ev->GetTriggerN();
+    m_tsb = ev->GetTimestampBegin();
+    m_tse = ev->GetTimestampEnd();
+
+    auto sev = std::dynamic_pointer_cast<const StandardEvent>(ev);
+    if(!sev){
+      auto stdev = StandardEvent::MakeShared();
+      StdEventConverter::Convert(ev, stdev, GetConfiguration());
+      sev = stdev;
+    }
+    FillPlanes(*sev);
+    TTreeEventConverter::Convert(ev, m_ttree, GetConfiguration());
+    m_tree->Fill();
+  }
+
+  uint64_t TTreeFileWriter::FileBytes() const {
+    return m_file ? m_file->GetBytesWritten() : 0;
+  }
 }
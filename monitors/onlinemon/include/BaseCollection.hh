@@ -73,6 +73,11 @@ class BaseCollection {
   /*!This resets all the histograms ready for a new run*/
   virtual void Reset() = 0;
 
+  //!Flush
+  /*!This pushes data accumulated outside of the histograms into them. It is
+   * called on every GUI refresh, the default does nothing*/
+  virtual void Flush() {}
+
   //!Set Reduce
   /*!This sets a new value for the parameter _reduce*/
   void setReduce(const unsigned int red);
@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "CorrelationHistos.hh"
+#include "CorrelationEngine.hh"
 #include "BaseCollection.hh"
 
 using namespace std;
@@ -47,6 +48,8 @@ class CorrelationCollection : public BaseCollection {
 protected:
   map<pair<SimpleStandardPlane, SimpleStandardPlane>, CorrelationHistos *> _map;
   vector<SimpleStandardPlane> _planes;
+  CorrelationEngine _engine;
+  void setupEngine(const SimpleStandardEvent &simpev);
   bool isPlaneRegistered(SimpleStandardPlane p);
   bool checkCorrelations(const SimpleStandardCluster &cluster1,
                          const SimpleStandardCluster &cluster2,
@@ -62,6 +65,7 @@ class CorrelationCollection : public BaseCollection {
   void Fill(const SimpleStandardEvent &simpev);
   unsigned int FillWithTracks(const SimpleStandardEvent &simpev);
   virtual void Reset();
+  virtual void Flush();
   void setRootMonitor(RootMonitor *mon);
   CorrelationHistos *getCorrelationHistos(const SimpleStandardPlane &p1,
                                           const SimpleStandardPlane &p2);
@@ -0,0 +1,147 @@
+/*
+ * CorrelationEngine.hh
+ *
+ *  Accumulates plane-pair cluster correlations into compact integer arrays
+ *  and only pushes them into the ROOT histograms when the GUI refreshes.
+ */
+
+#ifndef CORRELATIONENGINE_HH_
+#define CORRELATIONENGINE_HH_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SimpleStandardEvent.hh"
+
+class CorrelationHistos;
+
+//!Correlation Accumulator Class
+/*!
+  Holds the pending correlations of one plane pair. The 2D projections are
+  stored with the same bin layout as the corresponding TH2I (including under-
+  and overflow bins), the correlation-vs-time entries are buffered so they can
+  be handed to TH2::FillN in one call.
+ */
+class CorrelationAccumulator {
+public:
+  CorrelationAccumulator(int maxX1, int maxY1, int maxX2, int maxY2,
+                         double pitchRatioX, double pitchRatioY,
+                         unsigned projections);
+
+  void Add(int x1, int y1, int x2, int y2, double event);
+  void Clear();
+  //! Drops the buffered correlation-vs-time entries only
+  void ClearTime();
+  bool Empty() const { return m_entries == 0; }
+  uint64_t Entries() const { return m_entries; }
+
+  // bin counts in TH2 layout: index = binx + (nbinsx + 2) * biny
+  const std::vector<uint32_t> &X() const { return m_x; }
+  const std::vector<uint32_t> &Y() const { return m_y; }
+  const std::vector<uint32_t> &XY() const { return m_xy; }
+  const std::vector<uint32_t> &YX() const { return m_yx; }
+
+  const std::vector<double> &TimeEvent() const { return m_t_ev; }
+  const std::vector<double> &TimeX() const { return m_t_x; }
+  const std::vector<double> &TimeY() const { return m_t_y; }
+  const std::vector<double> &TimeXY() const { return m_t_xy; }
+  const std::vector<double> &TimeYX() const { return m_t_yx; }
+
+private:
+  static int Bin(int v, int nbins) {
+    return v < 0 ? 0 : (v >= nbins ? nbins + 1 : v + 1);
+  }
+  static void Resize(std::vector<uint32_t> &v, int nx, int ny, bool enable);
+
+  int m_maxX1, m_maxY1, m_maxX2, m_maxY2;
+  double m_pitchRatioX, m_pitchRatioY;
+  unsigned m_projections;
+  uint64_t m_entries;
+  std::vector<uint32_t> m_x, m_y, m_xy, m_yx;
+  std::vector<double> m_t_ev, m_t_x, m_t_y, m_t_xy, m_t_yx;
+};
+
+//!Correlation Engine Class
+/*!
+  Used by the CorrelationCollection. The cluster positions of every event are
+  copied once into flat per-plane arrays and queued. Once a batch of events is
+  complete, all selected plane pairs are correlated in a single pass, with an
+  optional cap on the number of cluster pairs processed per event. The
+  accumulated counts are merged into the ROOT histograms by Flush(), which is
+  called on GUI refresh and before writing. The correlation-vs-time entries
+  grow with the number of events, they are merged after every batch.
+ */
+class CorrelationEngine {
+public:
+  enum Projection : unsigned {
+    PROJ_X = 0x1,
+    PROJ_Y = 0x2,
+    PROJ_XY = 0x4,
+    PROJ_YX = 0x8,
+    PROJ_TIME = 0x10,
+    PROJ_ALL = 0x1f
+  };
+
+  CorrelationEngine();
+  ~CorrelationEngine();
+
+  //! Parses names like "X", "Y", "XY", "YX" and "Time" into a projection mask
+  static unsigned ParseProjections(const std::vector<std::string> &names);
+
+  void setProjections(unsigned mask) { m_projections = mask; }
+  unsigned getProjections() const { return m_projections; }
+  void setBatchSize(unsigned n) { m_batch_size = n ? n : 1; }
+  unsigned getBatchSize() const { return m_batch_size; }
+  void setMaxPairsPerEvent(unsigned n) { m_max_pairs = n; }
+  unsigned getMaxPairsPerEvent() const { return m_max_pairs; }
+  //! Restricts the correlations to the given plane index pairs (empty: all)
+  void setPlanePairs(const std::vector<std::pair<int, int>> &pairs) {
+    m_selected_pairs = pairs;
+  }
+  bool isPairSelected(int planeA, int planeB) const;
+
+  //! Adds a plane pair, identified by the plane indices inside the event
+  void addPair(int planeA, int planeB, const SimpleStandardPlane &p1,
+               const SimpleStandardPlane &p2, CorrelationHistos *histos);
+  void clearPairs();
+  int getNPlanes() const { return m_nplanes; }
+  void setNPlanes(int n) { m_nplanes = n; }
+  size_t getNPairs() const { return m_pairs.size(); }
+
+  void Fill(const SimpleStandardEvent &simpev, int minclustersize);
+  void Flush();
+  void Reset();
+
+  uint64_t getTruncatedEvents() const { return m_truncated; }
+
+private:
+  struct PairEntry {
+    int planeA;
+    int planeB;
+    CorrelationHistos *histos;
+    CorrelationAccumulator acc;
+  };
+
+  void ProcessBatch();
+
+  unsigned m_projections;
+  unsigned m_batch_size;
+  unsigned m_max_pairs;
+  int m_nplanes;
+  uint64_t m_truncated;
+  std::vector<std::pair<int, int>> m_selected_pairs;
+  std::vector<PairEntry> m_pairs;
+
+  // queued events: per event m_nplanes + 1 offsets into m_cl_x / m_cl_y
+  std::vector<unsigned> m_ev_number;
+  std::vector<size_t> m_offsets;
+  std::vector<int> m_cl_x;
+  std::vector<int> m_cl_y;
+
+  std::mutex m_mu;
+};
+
+#endif /* CORRELATIONENGINE_HH_ */
@@ -15,6 +15,8 @@
 
 #include "SimpleStandardEvent.hh"
 
+class CorrelationAccumulator;
+
 using namespace std;
 
 class CorrelationHistos {
@@ -53,7 +55,12 @@ class CorrelationHistos {
   void FillCorrVsTime(const SimpleStandardCluster &cluster1,
 		      const SimpleStandardCluster &cluster2,
 		      const SimpleStandardEvent &simpev);
+  // adds the counts collected by the CorrelationEngine to the histograms
+  void Merge(const CorrelationAccumulator &acc);
+  void MergeTime(const CorrelationAccumulator &acc);
 
+  double getPitchRatioX() const { return m_pitchX2 / m_pitchX1; }
+  double getPitchRatioY() const { return m_pitchY2 / m_pitchY1; }
   
   void Reset();
 
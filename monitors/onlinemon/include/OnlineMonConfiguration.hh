@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <utility>
 
 #include <fstream>
 #include <iostream>
@@ -47,6 +48,14 @@ class OnlineMonConfiguration {
   void setCorrel_minclustersize(int correl_minclustersize);
   std::vector<int> getPlanes_to_be_skipped() const;
   void setPlanes_to_be_skipped(std::vector<int> planes_to_be_skipped);
+  std::vector<std::pair<int, int>> getCorrel_planepairs() const;
+  void setCorrel_planepairs(std::vector<std::pair<int, int>> planepairs);
+  std::vector<std::string> getCorrel_projections() const;
+  void setCorrel_projections(std::vector<std::string> projections);
+  unsigned int getCorrel_batchsize() const;
+  void setCorrel_batchsize(unsigned int batchsize);
+  unsigned int getCorrel_maxpairsperevent() const;
+  void setCorrel_maxpairsperevent(unsigned int maxpairs);
 
 private:
   // general settings
@@ -60,6 +69,10 @@ class OnlineMonConfiguration {
   std::map<int, bool> correlation_xy_flip;
   std::vector<int> planes_to_be_skipped;
   int correl_minclustersize;
+  std::vector<std::pair<int, int>> correl_planepairs; // empty: all pairs
+  std::vector<std::string> correl_projections;
+  unsigned int correl_batchsize;
+  unsigned int correl_maxpairsperevent; // 0: unlimited
   // Clusterizer settings
 
   // hotcluster finder settings
@@ -74,6 +74,7 @@ CorrelationCollection::getCorrelationHistos(const SimpleStandardPlane &p1,
 }
 
 void CorrelationCollection::Reset() {
+  _engine.Reset();
   std::map<std::pair<SimpleStandardPlane, SimpleStandardPlane>,
            CorrelationHistos *>::iterator it;
   for (it = _map.begin(); it != _map.end(); ++it) {
@@ -97,7 +98,7 @@ void CorrelationCollection::Fill(const SimpleStandardEvent &simpev) {
   if (skip_this_plane.size() == 0) // do this only at the very first event
   {
     selected_planes_to_skip = _mon->mon_configdata.getPlanes_to_be_skipped();
-    skip_this_plane.reserve(nPlanes);
+    skip_this_plane.resize(nPlanes);
     // init vector
     for (int elements = 0; elements < nPlanes; elements++) {
       skip_this_plane[elements] = false;
@@ -163,18 +164,42 @@ void CorrelationCollection::Fill(const SimpleStandardEvent &simpev) {
         }
         _planes.push_back(simpPlane); // we have to deal with all planes
       }
-      for (int planeB = planeA + 1; planeB < nPlanes; planeB++) {
-        if ((skip_this_plane[planeA] == false) &&
-            (skip_this_plane[planeB]) == false) {
-          const SimpleStandardPlane &p1 = simpev.getPlane(planeA);
-          const SimpleStandardPlane &p2 = simpev.getPlane(planeB);
-          fillHistograms(p1, p2,simpev);
-        }
-      }
+    }
+    if (_engine.getNPlanes() != nPlanes)
+      setupEngine(simpev);
+    _engine.Fill(simpev, _mon->mon_configdata.getCorrel_minclustersize());
+  }
+}
+
+void CorrelationCollection::setupEngine(const SimpleStandardEvent &simpev) {
+  const OnlineMonConfiguration &conf = _mon->mon_configdata;
+  int nPlanes = simpev.getNPlanes();
+
+  _engine.clearPairs();
+  _engine.setProjections(
+      CorrelationEngine::ParseProjections(conf.getCorrel_projections()));
+  _engine.setBatchSize(conf.getCorrel_batchsize());
+  _engine.setMaxPairsPerEvent(conf.getCorrel_maxpairsperevent());
+  _engine.setPlanePairs(conf.getCorrel_planepairs());
+
+  for (int planeA = 0; planeA < nPlanes; planeA++) {
+    if (skip_this_plane[planeA])
+      continue;
+    const SimpleStandardPlane p1 = simpev.getPlane(planeA);
+    for (int planeB = planeA + 1; planeB < nPlanes; planeB++) {
+      if (skip_this_plane[planeB] || !_engine.isPairSelected(planeA, planeB))
+        continue;
+      const SimpleStandardPlane p2 = simpev.getPlane(planeB);
+      auto it = _map.find(std::make_pair(p1, p2));
+      if (it != _map.end() && it->second)
+        _engine.addPair(planeA, planeB, p1, p2, it->second);
     }
   }
+  _engine.setNPlanes(nPlanes);
 }
 
+void CorrelationCollection::Flush() { _engine.Flush(); }
+
 unsigned int
 CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
   int nPlanes = simpev.getNPlanes();
@@ -192,7 +217,7 @@ CorrelationCollection::FillWithTracks(const SimpleStandardEvent &simpev) {
   if (skip_this_plane.size() == 0) // do this only at the very first event
   {
     selected_planes_to_skip = _mon->mon_configdata.getPlanes_to_be_skipped();
-    skip_this_plane.reserve(nPlanes);
+    skip_this_plane.resize(nPlanes);
     // init vector
     for (int elements = 0; elements < nPlanes; elements++) {
       skip_this_plane[elements] = false;
@@ -543,6 +568,7 @@ void CorrelationCollection::Write(TFile *file) {
     cout << "Can't Write Correllation Collections " << endl;
     return;
   }
+  Flush();
   if (_mon->getUseTrack_corr() == true) {
     gDirectory->mkdir("Track Correlations");
     gDirectory->cd("Track Correlations");
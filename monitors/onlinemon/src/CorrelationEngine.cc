@@ -0,0 +1,228 @@
+/*
+ * CorrelationEngine.cc
+ *
+ *  Accumulates plane-pair cluster correlations into compact integer arrays
+ *  and only pushes them into the ROOT histograms when the GUI refreshes.
+ */
+
+#include "CorrelationEngine.hh"
+#include "CorrelationHistos.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+CorrelationAccumulator::CorrelationAccumulator(int maxX1, int maxY1, int maxX2,
+                                               int maxY2, double pitchRatioX,
+                                               double pitchRatioY,
+                                               unsigned projections)
+    : m_maxX1(maxX1), m_maxY1(maxY1), m_maxX2(maxX2), m_maxY2(maxY2),
+      m_pitchRatioX(pitchRatioX), m_pitchRatioY(pitchRatioY),
+      m_projections(projections), m_entries(0) {
+  Resize(m_x, m_maxX1, m_maxX2, projections & CorrelationEngine::PROJ_X);
+  Resize(m_y, m_maxY1, m_maxY2, projections & CorrelationEngine::PROJ_Y);
+  Resize(m_xy, m_maxX1, m_maxY2, projections & CorrelationEngine::PROJ_XY);
+  Resize(m_yx, m_maxY1, m_maxX2, projections & CorrelationEngine::PROJ_YX);
+}
+
+void CorrelationAccumulator::Resize(std::vector<uint32_t> &v, int nx, int ny,
+                                    bool enable) {
+  if (enable && nx > 0 && ny > 0)
+    v.assign(static_cast<size_t>(nx + 2) * static_cast<size_t>(ny + 2), 0);
+  else
+    v.clear();
+}
+
+void CorrelationAccumulator::Add(int x1, int y1, int x2, int y2,
+                                 double event) {
+  if (!m_x.empty())
+    ++m_x[Bin(x1, m_maxX1) + (m_maxX1 + 2) * Bin(x2, m_maxX2)];
+  if (!m_y.empty())
+    ++m_y[Bin(y1, m_maxY1) + (m_maxY1 + 2) * Bin(y2, m_maxY2)];
+  if (!m_xy.empty())
+    ++m_xy[Bin(x1, m_maxX1) + (m_maxX1 + 2) * Bin(y2, m_maxY2)];
+  if (!m_yx.empty())
+    ++m_yx[Bin(y1, m_maxY1) + (m_maxY1 + 2) * Bin(x2, m_maxX2)];
+  if (m_projections & CorrelationEngine::PROJ_TIME) {
+    m_t_ev.push_back(event);
+    m_t_x.push_back(x1 - x2 * m_pitchRatioX);
+    m_t_y.push_back(y1 - y2 * m_pitchRatioY);
+    m_t_xy.push_back(x1 - y2 * m_pitchRatioX);
+    m_t_yx.push_back(y1 - x2 * m_pitchRatioY);
+  }
+  ++m_entries;
+}
+
+void CorrelationAccumulator::Clear() {
+  if (!m_entries)
+    return;
+  std::fill(m_x.begin(), m_x.end(), 0);
+  std::fill(m_y.begin(), m_y.end(), 0);
+  std::fill(m_xy.begin(), m_xy.end(), 0);
+  std::fill(m_yx.begin(), m_yx.end(), 0);
+  m_t_ev.clear();
+  m_t_x.clear();
+  m_t_y.clear();
+  m_t_xy.clear();
+  m_t_yx.clear();
+  m_entries = 0;
+}
+
+void CorrelationAccumulator::ClearTime() {
+  m_t_ev.clear();
+  m_t_x.clear();
+  m_t_y.clear();
+  m_t_xy.clear();
+  m_t_yx.clear();
+}
+
+CorrelationEngine::CorrelationEngine()
+    : m_projections(PROJ_ALL), m_batch_size(16), m_max_pairs(0), m_nplanes(0),
+      m_truncated(0) {}
+
+CorrelationEngine::~CorrelationEngine() {}
+
+unsigned
+CorrelationEngine::ParseProjections(const std::vector<std::string> &names) {
+  unsigned mask = 0;
+  for (auto name : names) {
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    if (name == "X")
+      mask |= PROJ_X;
+    else if (name == "Y")
+      mask |= PROJ_Y;
+    else if (name == "XY")
+      mask |= PROJ_XY;
+    else if (name == "YX")
+      mask |= PROJ_YX;
+    else if (name == "TIME")
+      mask |= PROJ_TIME;
+    else if (name == "ALL")
+      mask |= PROJ_ALL;
+    else
+      std::cerr << "CorrelationEngine : Unknown projection " << name
+                << std::endl;
+  }
+  return mask;
+}
+
+bool CorrelationEngine::isPairSelected(int planeA, int planeB) const {
+  if (m_selected_pairs.empty())
+    return true;
+  for (auto &p : m_selected_pairs) {
+    if ((p.first == planeA && p.second == planeB) ||
+        (p.first == planeB && p.second == planeA))
+      return true;
+  }
+  return false;
+}
+
+void CorrelationEngine::addPair(int planeA, int planeB,
+                                const SimpleStandardPlane &p1,
+                                const SimpleStandardPlane &p2,
+                                CorrelationHistos *histos) {
+  std::lock_guard<std::mutex> lk(m_mu);
+  CorrelationAccumulator acc(p1.getMaxX(), p1.getMaxY(), p2.getMaxX(),
+                             p2.getMaxY(), histos->getPitchRatioX(),
+                             histos->getPitchRatioY(), m_projections);
+  m_pairs.push_back(PairEntry{planeA, planeB, histos, std::move(acc)});
+}
+
+void CorrelationEngine::clearPairs() {
+  std::lock_guard<std::mutex> lk(m_mu);
+  m_pairs.clear();
+  m_ev_number.clear();
+  m_offsets.clear();
+  m_cl_x.clear();
+  m_cl_y.clear();
+  m_nplanes = 0;
+}
+
+void CorrelationEngine::Fill(const SimpleStandardEvent &simpev,
+                             int minclustersize) {
+  std::lock_guard<std::mutex> lk(m_mu);
+  if (m_pairs.empty() || simpev.getNPlanes() != m_nplanes)
+    return;
+
+  m_ev_number.push_back(simpev.getEvent_number());
+  for (int i = 0; i < m_nplanes; i++) {
+    m_offsets.push_back(m_cl_x.size());
+    const std::vector<SimpleStandardCluster> clusters =
+        simpev.getPlane(i).getClusters();
+    for (auto &cl : clusters) {
+      if (cl.getNPixel() < minclustersize)
+        continue;
+      m_cl_x.push_back(cl.getX());
+      m_cl_y.push_back(cl.getY());
+    }
+  }
+  m_offsets.push_back(m_cl_x.size());
+
+  if (m_ev_number.size() >= m_batch_size)
+    ProcessBatch();
+}
+
+// must be called with m_mu held
+void CorrelationEngine::ProcessBatch() {
+  const size_t stride = m_nplanes + 1;
+  for (size_t ev = 0; ev < m_ev_number.size(); ev++) {
+    const size_t *off = &m_offsets[ev * stride];
+    const double evnum = m_ev_number[ev];
+    uint64_t budget = m_max_pairs ? m_max_pairs : UINT64_MAX;
+    bool truncated = false;
+    for (auto &pair : m_pairs) {
+      const size_t a0 = off[pair.planeA], a1 = off[pair.planeA + 1];
+      const size_t b0 = off[pair.planeB], b1 = off[pair.planeB + 1];
+      for (size_t a = a0; a < a1 && !truncated; a++) {
+        const int xa = m_cl_x[a], ya = m_cl_y[a];
+        for (size_t b = b0; b < b1; b++) {
+          if (!budget) {
+            truncated = true;
+            break;
+          }
+          pair.acc.Add(xa, ya, m_cl_x[b], m_cl_y[b], evnum);
+          --budget;
+        }
+      }
+      if (truncated)
+        break;
+    }
+    if (truncated)
+      m_truncated++;
+  }
+  if (m_projections & PROJ_TIME) {
+    for (auto &pair : m_pairs) {
+      if (pair.acc.TimeEvent().empty())
+        continue;
+      pair.histos->MergeTime(pair.acc);
+      pair.acc.ClearTime();
+    }
+  }
+  m_ev_number.clear();
+  m_offsets.clear();
+  m_cl_x.clear();
+  m_cl_y.clear();
+}
+
+void CorrelationEngine::Flush() {
+  std::lock_guard<std::mutex> lk(m_mu);
+  if (!m_ev_number.empty())
+    ProcessBatch();
+  for (auto &pair : m_pairs) {
+    if (pair.acc.Empty())
+      continue;
+    pair.histos->Merge(pair.acc);
+    pair.acc.Clear();
+  }
+}
+
+void CorrelationEngine::Reset() {
+  std::lock_guard<std::mutex> lk(m_mu);
+  m_ev_number.clear();
+  m_offsets.clear();
+  m_cl_x.clear();
+  m_cl_y.clear();
+  for (auto &pair : m_pairs)
+    pair.acc.Clear();
+  m_truncated = 0;
+}
@@ -6,13 +6,15 @@
  */
 
 #include "CorrelationHistos.hh"
+#include "CorrelationEngine.hh"
 
 CorrelationHistos::CorrelationHistos(SimpleStandardPlane p1,
                                      SimpleStandardPlane p2)
     : _sensor1(p1.getName()), _sensor2(p2.getName()), _id1(p1.getID()),
       _id2(p2.getID()), _maxX1(p1.getMaxX()), _maxX2(p2.getMaxX()),
       _maxY1(p1.getMaxY()), _maxY2(p2.getMaxY()), _fills(0), _2dcorrX(NULL),
-      _2dcorrY(NULL), _2dcorrXY(NULL), _2dcorrYX(NULL) {
+      _2dcorrY(NULL), _2dcorrXY(NULL), _2dcorrYX(NULL), _2dcorrTimeX(NULL),
+      _2dcorrTimeY(NULL), _2dcorrTimeXY(NULL), _2dcorrTimeYX(NULL) {
   char out[1024], out2[1024], out_x[1024], out_y[1024];  
   if (_maxX1 != -1 && _maxX2 != -1) {
     sprintf(out, "X Correlation of %s %i and %s %i", _sensor1.c_str(), _id1,
@@ -222,6 +224,46 @@ void CorrelationHistos::FillCorrVsTime(const SimpleStandardCluster &cluster1,
 
 }
 
+static void mergeBins(TH2I *h, const std::vector<uint32_t> &counts) {
+  if (h == NULL || counts.empty())
+    return;
+  // counts follow the TH2 global bin numbering, including the flow bins
+  const int ncells = (h->GetNbinsX() + 2) * (h->GetNbinsY() + 2);
+  if (static_cast<int>(counts.size()) != ncells)
+    return;
+  for (int bin = 0; bin < ncells; ++bin) {
+    if (counts[bin])
+      h->AddBinContent(bin, counts[bin]);
+  }
+  h->ResetStats();
+}
+
+static void mergeTime(TH2I *h, const std::vector<double> &ev,
+                      const std::vector<double> &diff) {
+  if (h == NULL || ev.empty())
+    return;
+  h->FillN(ev.size(), ev.data(), diff.data(), NULL);
+}
+
+void CorrelationHistos::Merge(const CorrelationAccumulator &acc) {
+  std::lock_guard<std::mutex> lckx(m_mu);
+  mergeBins(_2dcorrX, acc.X());
+  mergeBins(_2dcorrY, acc.Y());
+  mergeBins(_2dcorrXY, acc.XY());
+  mergeBins(_2dcorrYX, acc.YX());
+  mergeTime(_2dcorrTimeX, acc.TimeEvent(), acc.TimeX());
+  mergeTime(_2dcorrTimeY, acc.TimeEvent(), acc.TimeY());
+  mergeTime(_2dcorrTimeXY, acc.TimeEvent(), acc.TimeXY());
+  mergeTime(_2dcorrTimeYX, acc.TimeEvent(), acc.TimeYX());
+}
+
+void CorrelationHistos::MergeTime(const CorrelationAccumulator &acc) {
+  std::lock_guard<std::mutex> lckx(m_mu);
+  mergeTime(_2dcorrTimeX, acc.TimeEvent(), acc.TimeX());
+  mergeTime(_2dcorrTimeY, acc.TimeEvent(), acc.TimeY());
+  mergeTime(_2dcorrTimeXY, acc.TimeEvent(), acc.TimeXY());
+  mergeTime(_2dcorrTimeYX, acc.TimeEvent(), acc.TimeYX());
+}
 
 void CorrelationHistos::Reset() {
   _2dcorrX->Reset();
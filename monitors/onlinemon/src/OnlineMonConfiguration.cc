@@ -157,6 +157,32 @@ int OnlineMonConfiguration::ReadConfigurationFile() {
             planes_to_be_skipped.push_back(StringToNumber<int>(v[element]));
           }
 
+        } else if (key.compare("PlanePairs") == 0) {
+          // comma separated list of plane index pairs, e.g. 0:1,0:5
+          vector<string> v;
+          stringsplit(value, ',', v);
+          correl_planepairs.clear();
+          for (unsigned int element = 0; element < v.size(); element++) {
+            size_t sep = v[element].find(':');
+            if (sep == string::npos) {
+              cerr << " Warning Malformed plane pair " << v[element] << endl;
+              continue;
+            }
+            correl_planepairs.push_back(
+                make_pair(StringToNumber<int>(v[element].substr(0, sep)),
+                          StringToNumber<int>(v[element].substr(sep + 1))));
+          }
+        } else if (key.compare("Projections") == 0) {
+          correl_projections.clear();
+          stringsplit(value, ',', correl_projections);
+        } else if (key.compare("BatchSize") == 0) {
+          correl_batchsize = StringToNumber<unsigned int>(value);
+          if (correl_batchsize == 0) {
+            cerr << " Warning Illegal BatchSize used " << endl;
+            correl_batchsize = 1;
+          }
+        } else if (key.compare("MaxPairsPerEvent") == 0) {
+          correl_maxpairsperevent = StringToNumber<unsigned int>(value);
         } else {
           cerr << "Unknown Key " << key << endl;
         }
@@ -216,6 +242,10 @@ void OnlineMonConfiguration::SetDefaults() {
 
   // correl cluster settings
   correl_minclustersize = 1;
+  correl_planepairs.clear();
+  correl_projections = {"X", "Y", "XY", "YX", "Time"};
+  correl_batchsize = 16;
+  correl_maxpairsperevent = 0;
 }
 
 void OnlineMonConfiguration::setSnapShotDir(string SnapShotDir) {
@@ -270,6 +300,21 @@ void OnlineMonConfiguration::PrintConfiguration() {
     cout << planes_to_be_skipped[i] << " ";
   }
   cout << endl;
+  cout << "Plane pairs         : ";
+  if (correl_planepairs.empty())
+    cout << "all";
+  for (unsigned int i = 0; i < correl_planepairs.size(); i++) {
+    cout << correl_planepairs[i].first << ":" << correl_planepairs[i].second
+         << " ";
+  }
+  cout << endl;
+  cout << "Projections         : ";
+  for (unsigned int i = 0; i < correl_projections.size(); i++) {
+    cout << correl_projections[i] << " ";
+  }
+  cout << endl;
+  cout << "BatchSize           : " << correl_batchsize << endl;
+  cout << "MaxPairsPerEvent    : " << correl_maxpairsperevent << endl;
   cout << "Clusterizer Settings" << endl;
   cout << "HotPixelFinder Settings" << endl;
   cout << "HotPixelCut         : " << hotpixelcut << endl;
@@ -321,3 +366,38 @@ unsigned int OnlineMonConfiguration::stringsplit(string str, char c,
   }
   return v.size();
 }
+
+vector<pair<int, int>> OnlineMonConfiguration::getCorrel_planepairs() const {
+  return correl_planepairs;
+}
+
+void OnlineMonConfiguration::setCorrel_planepairs(
+    vector<pair<int, int>> planepairs) {
+  this->correl_planepairs = planepairs;
+}
+
+vector<string> OnlineMonConfiguration::getCorrel_projections() const {
+  return correl_projections;
+}
+
+void OnlineMonConfiguration::setCorrel_projections(
+    vector<string> projections) {
+  this->correl_projections = projections;
+}
+
+unsigned int OnlineMonConfiguration::getCorrel_batchsize() const {
+  return correl_batchsize;
+}
+
+void OnlineMonConfiguration::setCorrel_batchsize(unsigned int batchsize) {
+  this->correl_batchsize = batchsize;
+}
+
+unsigned int OnlineMonConfiguration::getCorrel_maxpairsperevent() const {
+  return correl_maxpairsperevent;
+}
+
+void OnlineMonConfiguration::setCorrel_maxpairsperevent(
+    unsigned int maxpairs) {
+  this->correl_maxpairsperevent = maxpairs;
+}
@@ -340,6 +340,9 @@ void OnlineMonWindow::autoUpdate() {
   _reduceUpdate++;
   unsigned int activeHistoSize = _activeHistos.size();
   if (activeHistoSize && _reduceUpdate > activeHistoSize){
+    for (unsigned int i = 0; i < _colls.size(); ++i) {
+      _colls.at(i)->Flush();
+    }
     TCanvas *fCanvas = ECvs_right->GetCanvas();
     for (unsigned int i = 0; i < activeHistoSize; ++i) {
       if(activeHistoSize ==1){
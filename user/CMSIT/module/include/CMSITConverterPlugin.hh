@@ -14,6 +14,7 @@
 
 #include "CMSITEventData.hh"
 
+#include "eudaq/CalibrationStore.hh"
 #include "eudaq/RawEvent.hh"
 #include "eudaq/StdEventConverter.hh"
 
@@ -84,20 +85,16 @@ class TheConverter
   public:
     struct calibrationParameters
     {
-#ifdef ROOTSYS
-        TFile* calibrationFile;
-        TH2D*  hSlope;
-        TH2D*  hIntercept;
-
-        calibrationParameters()
-        {
-            calibrationFile = nullptr;
-            hSlope          = nullptr;
-            hIntercept      = nullptr;
-        }
-#endif
         float slopeVCal2Charge;
         float interceptVCal2Charge;
+
+        // ################################################################
+        // # Slope (rows 0 to nBinsY-1) and intercept (rows nBinsY to     #
+        // # 2*nBinsY-1) per pixel, copied from the histograms once and   #
+        // # then mapped from the calibration cache                       #
+        // ################################################################
+        int              nBinsX = 0, nBinsY = 0;
+        CalibrationTable table;
     };
 
     enum class SensorType : uint8_t
@@ -122,6 +119,25 @@ class TheConverter
     int ChargeConverter(const int row, const int col, const int ToT, const calibrationParameters& calibPar, const int& chargeCut);
 };
 
+// ####################################################################
+// # Settings of one chip, resolved once from the configuration file #
+// ####################################################################
+struct ChipSettings
+{
+    std::string                         chipTypeFromFile;
+    TheConverter::calibrationParameters calibPar;
+    int                                 chargeCut;
+    int                                 triggerIdLow;
+    int                                 triggerIdHigh;
+    int                                 deviceId;
+
+    // Geometry, precomputed when the chip type is given in the configuration file
+    bool         hasGeometry = false;
+    TheConverter theConverter;
+    std::string  ChipType;
+    int          nRows, nCols, planeId;
+};
+
 class CMSITConverterPlugin : public StdEventConverter
 {
   public:
@@ -139,6 +155,9 @@ class CMSITConverterPlugin : public StdEventConverter
     TH2D* FindHistogram(const std::string& nameInHisto, uint16_t hybridId, uint16_t chipId);
 #endif
     bool Deserialize(const EventSPC ev, CMSITEventData::EventData& theEvent) const;
+    static bool DecodeCompact(const uint8_t* data, size_t size, CMSITEventData::EventData& theEvent);
+    void        FillChipSettings();
+    const ChipSettings& GetChipSettings(const uint32_t hybridId, const uint32_t chipId, ChipSettings& fallback) const;
     int  ReadConfigurationAndComputeDeviceId(const uint32_t                       hybridId,
                                              const uint32_t                       chipId,
                                              std::string&                         chipTypeFromFile,
@@ -150,8 +169,11 @@ class CMSITConverterPlugin : public StdEventConverter
     static bool                                                       exitIfOutOfSync;
     static int                                                        theTLUtriggerId_previous;
     static std::shared_ptr<Configuration>                             theConfigFromFile;
+    static ConfigurationSectionSPC                                    theGeometrySection;
+    static ConfigurationSectionSPC                                    theSelectionSection;
     static std::map<std::string, TheConverter::calibrationParameters> calibMap;
     static std::once_flag                                             callOnce;
+    static std::vector<ChipSettings>                                  chipSettings; // index hybridId * MAXCHIPID + chipId
 };
 
 } // namespace eudaq
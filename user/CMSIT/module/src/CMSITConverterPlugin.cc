@@ -10,8 +10,92 @@
 
 #include "CMSITConverterPlugin.hh"
 
+#include <cstring>
+#include <memory>
+#include <streambuf>
+
 using namespace eudaq;
 
+namespace
+{
+// ##########################################################
+// # Read-only stream over a data block, for the Boost path #
+// ##########################################################
+class BlockStreamBuf : public std::streambuf
+{
+  public:
+    BlockStreamBuf(const uint8_t* data, size_t size)
+    {
+        char* begin = (char*)data;
+        setg(begin, begin, begin + size);
+    }
+};
+
+// ###################################################################
+// # Reader of the Boost binary archive layout of EventData:         #
+// # native integers, strings and collection sizes as 64-bit length, #
+// # a 32-bit item version after each collection size, and tracking  #
+// # (1 byte) + class version (4 bytes) the first time a class shows #
+// ###################################################################
+class ArchiveReader
+{
+  public:
+    ArchiveReader(const uint8_t* data, size_t size) : ptr(data), end(data + size), good(true) {}
+
+    template <typename T>
+    T Get()
+    {
+        T value{};
+        if(size_t(end - ptr) < sizeof(T))
+            good = false;
+        else
+        {
+            std::memcpy(&value, ptr, sizeof(T));
+            ptr += sizeof(T);
+        }
+        return value;
+    }
+
+    std::string GetString()
+    {
+        const uint64_t size = Get<uint64_t>();
+        if((good == false) || (size > uint64_t(end - ptr)))
+        {
+            good = false;
+            return "";
+        }
+        std::string value((const char*)ptr, size);
+        ptr += size;
+        return value;
+    }
+
+    uint64_t GetCollectionSize(size_t minItemSize)
+    {
+        const uint64_t size = Get<uint64_t>();
+        Get<uint32_t>(); // item version
+        if(size > uint64_t(end - ptr) / minItemSize) good = false;
+        return (good == true ? size : 0);
+    }
+
+    void ClassInfo(bool& seen)
+    {
+        if(seen == true) return;
+        const uint8_t  tracking = Get<uint8_t>();
+        const uint32_t version  = Get<uint32_t>();
+        if((tracking != 0) || (version != 0)) good = false;
+        seen = true;
+    }
+
+    bool AtEnd() const { return (good == true) && (ptr == end); }
+    bool Good() const { return good; }
+
+  private:
+    const uint8_t* ptr;
+    const uint8_t* end;
+    bool           good;
+};
+} // namespace
+
 // #####################################
 // # Row, Column, and Charge converter #
 // #####################################
@@ -92,17 +176,19 @@ void TheConverter::operator()(int& row, int& col, int& charge, const int& chipId
 
 int TheConverter::ChargeConverter(const int row, const int col, const int ToT, const calibrationParameters& calibPar, const int& chargeCut)
 {
-#ifdef ROOTSYS
-    if((calibPar.hIntercept != nullptr) && (calibPar.hSlope != nullptr) && (calibPar.hSlope->GetBinContent(col + 1, row + 1) != 0))
+    if((calibPar.table.Empty() == false) && (row >= 0) && (row < calibPar.nBinsY) && (col >= 0) && (col < calibPar.nBinsX))
     {
-        double value = -1;
-
-        if((std::isnan(calibPar.hIntercept->GetBinContent(col + 1, row + 1)) == false) && (std::isnan(calibPar.hSlope->GetBinContent(col + 1, row + 1)) == false))
-            value = (ToT - calibPar.hIntercept->GetBinContent(col + 1, row + 1)) / calibPar.hSlope->GetBinContent(col + 1, row + 1) * calibPar.slopeVCal2Charge + calibPar.interceptVCal2Charge;
+        const float slope = calibPar.table.At(row, col);
 
-        return (value > chargeCut ? value : -1);
+        if(slope != 0)
+        {
+            // ###########################################
+            // # NaN slope or intercept gives a NaN, cut #
+            // ###########################################
+            double value = (ToT - calibPar.table.At(calibPar.nBinsY + row, col)) / slope * calibPar.slopeVCal2Charge + calibPar.interceptVCal2Charge;
+            return (value > chargeCut ? value : -1);
+        }
     }
-#endif
     return (ToT > chargeCut ? ToT : -1);
 }
 
@@ -131,19 +217,30 @@ bool CMSITConverterPlugin::Converting(EventSPC ev, StandardEventSP sev, Configur
         std::vector<StandardPlane> planes;
         for(auto& theChip: theEvent.chipData)
         {
-            int                                 chargeCut;
-            int                                 triggerIdLow;
-            int                                 triggerIdHigh;
-            TheConverter::calibrationParameters theCalibPar;
-            std::string                         chipTypeFromFile;
-            const auto deviceId = CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(theChip.hybridId, theChip.chipId, chipTypeFromFile, theCalibPar, chargeCut, triggerIdLow, triggerIdHigh);
+            ChipSettings        fallback;
+            const ChipSettings& theSettings   = CMSITConverterPlugin::GetChipSettings(theChip.hybridId, theChip.chipId, fallback);
+            const auto&         theCalibPar   = theSettings.calibPar;
+            const int           chargeCut     = theSettings.chargeCut;
+            const int           triggerIdLow  = theSettings.triggerIdLow;
+            const int           triggerIdHigh = theSettings.triggerIdHigh;
+            const auto          deviceId      = theSettings.deviceId;
 
             if(std::find(deviceIDs.begin(), deviceIDs.end(), deviceId) == deviceIDs.end())
             {
                 StandardPlane* plane;
                 std::string    ChipType;
                 int            nRows, nCols, planeId;
-                auto           theConverter = CMSITConverterPlugin::GetChipGeometry(theChip.chipType, chipTypeFromFile, nRows, nCols, ChipType, deviceId, planeId);
+                TheConverter   theConverter;
+                if(theSettings.hasGeometry == true)
+                {
+                    theConverter = theSettings.theConverter;
+                    ChipType     = theSettings.ChipType;
+                    nRows        = theSettings.nRows;
+                    nCols        = theSettings.nCols;
+                    planeId      = theSettings.planeId;
+                }
+                else
+                    theConverter = CMSITConverterPlugin::GetChipGeometry(theChip.chipType, theSettings.chipTypeFromFile, nRows, nCols, ChipType, deviceId, planeId);
 
                 // ###########################################################################
                 // # Check if the plane was already created: needed for quad or dual modules #
@@ -218,6 +315,8 @@ void CMSITConverterPlugin::Initialize()
 {
     theTLUtriggerId_previous = 0;
     theConfigFromFile        = nullptr;
+    theGeometrySection       = nullptr;
+    theSelectionSection      = nullptr;
     std::ifstream cfgFile(CFG_FILE_NAME);
 
     if(cfgFile.good() == true)
@@ -234,45 +333,68 @@ void CMSITConverterPlugin::Initialize()
             // ########################
             // # Fill calibration map #
             // ########################
-            theConfigFromFile->SetSection("sensor.calibration");
+            const auto calibSection = theConfigFromFile->Section("sensor.calibration");
 
             for(auto chipId = 0; chipId < MAXCHIPID; chipId++)
                 for(auto hybridId = 0; hybridId < MAXHYBRID; hybridId++)
                 {
                     const std::string calibration("fileName_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-                    const std::string calibFileName(theConfigFromFile->Get(calibration, ""));
+                    const std::string calibFileName(calibSection->Get(calibration, ""));
 
                     if(calibFileName != "")
                     {
                         calibMap[calibration] = TheConverter::calibrationParameters();
 #ifdef ROOTSYS
-                        calibMap[calibration].calibrationFile = TFile::Open(calibFileName.c_str());
-                        if((calibMap[calibration].calibrationFile != nullptr) && (calibMap[calibration].calibrationFile->IsOpen() == true))
-                        {
-                            myString.clear();
-                            myString.str("");
-                            myString << "[EUDAQ::CMSITConverterPlugin::Initialize] --> Opening calibration file: " << calibFileName;
-                            EUDAQ_INFO(myString.str().c_str());
+                        const std::string slope("slopeVCal2Electrons_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
+                        calibMap[calibration].slopeVCal2Charge = calibSection->Get(slope, 0.);
+
+                        const std::string intercept("interceptVCal2Electrons_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
+                        calibMap[calibration].interceptVCal2Charge = calibSection->Get(intercept, 0.);
+
+                        // ##############################################
+                        // # Flatten the per-pixel parameters once, the #
+                        // # next processes map the cached table        #
+                        // ##############################################
+                        auto&       calibPar = calibMap[calibration];
+                        bool        opened   = true;
+                        const std::string kind("CMSIT.SlopeIntercept.hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
+                        calibPar.table = CalibrationStore::Load(calibFileName, kind, 1, [&](const std::string& path) {
+                            std::unique_ptr<TFile> calibrationFile(TFile::Open(path.c_str()));
+                            if((calibrationFile == nullptr) || (calibrationFile->IsOpen() == false))
+                            {
+                                opened = false;
+                                return CalibrationTable();
+                            }
 
-                            TDirectory* rootDir          = gDirectory;
-                            calibMap[calibration].hSlope = CMSITConverterPlugin::FindHistogram("Slope2D", hybridId, chipId);
+                            TDirectory* rootDir = gDirectory;
+                            TH2D*       hSlope  = CMSITConverterPlugin::FindHistogram("Slope2D", hybridId, chipId);
 
                             rootDir->cd();
-                            calibMap[calibration].hIntercept = CMSITConverterPlugin::FindHistogram("Intercept2D", hybridId, chipId);
-
-                            const std::string slope("slopeVCal2Electrons_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-                            calibMap[calibration].slopeVCal2Charge = theConfigFromFile->Get(slope, 0.);
+                            TH2D* hIntercept = CMSITConverterPlugin::FindHistogram("Intercept2D", hybridId, chipId);
+
+                            if((hSlope == nullptr) || (hIntercept == nullptr)) return CalibrationTable();
+
+                            const int          nBinsX = hSlope->GetNbinsX();
+                            const int          nBinsY = hSlope->GetNbinsY();
+                            std::vector<float> values(2 * nBinsX * nBinsY);
+                            for(auto row = 0; row < nBinsY; row++)
+                                for(auto col = 0; col < nBinsX; col++)
+                                {
+                                    values[row * nBinsX + col]            = hSlope->GetBinContent(col + 1, row + 1);
+                                    values[(nBinsY + row) * nBinsX + col] = hIntercept->GetBinContent(col + 1, row + 1);
+                                }
+                            return CalibrationTable(nBinsX, std::move(values));
+                        });
+                        calibPar.nBinsX = calibPar.table.Columns();
+                        calibPar.nBinsY = calibPar.table.Rows() / 2;
 
-                            const std::string intercept("interceptVCal2Electrons_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-                            calibMap[calibration].interceptVCal2Charge = theConfigFromFile->Get(intercept, 0.);
-                        }
+                        myString.clear();
+                        myString.str("");
+                        if(opened == true)
+                            myString << "[EUDAQ::CMSITConverterPlugin::Initialize] --> Opening calibration file: " << calibFileName;
                         else
-                        {
-                            myString.clear();
-                            myString.str("");
                             myString << "[EUDAQ::CMSITConverterPlugin::Initialize] --> I couldn't open the calibration file: " << calibFileName;
-                            EUDAQ_INFO(myString.str().c_str());
-                        }
+                        EUDAQ_INFO(myString.str().c_str());
 #else
                         myString.clear();
                         myString.str("");
@@ -285,8 +407,13 @@ void CMSITConverterPlugin::Initialize()
             // ########################
             // # Fill calibration map #
             // ########################
-            theConfigFromFile->SetSection("converter.settings");
-            exitIfOutOfSync = theConfigFromFile->Get("exitIfOutOfSync", false);
+            exitIfOutOfSync = theConfigFromFile->Section("converter.settings")->Get("exitIfOutOfSync", false);
+
+            // ###############################################
+            // # Sections read per chip, also during running #
+            // ###############################################
+            theGeometrySection  = theConfigFromFile->Section("sensor.geometry");
+            theSelectionSection = theConfigFromFile->Section("sensor.selection");
         }
 
         cfgFile.close();
@@ -299,6 +426,36 @@ void CMSITConverterPlugin::Initialize()
         myString << "[EUDAQ::CMSITConverterPlugin::Initialize] --> I couldn't find cfg file: " << CFG_FILE_NAME << " (it's not mandatory)";
         EUDAQ_INFO(myString.str().c_str());
     }
+
+    CMSITConverterPlugin::FillChipSettings();
+}
+
+void CMSITConverterPlugin::FillChipSettings()
+{
+    chipSettings.resize(MAXHYBRID * MAXCHIPID);
+    for(auto hybridId = 0; hybridId < MAXHYBRID; hybridId++)
+        for(auto chipId = 0; chipId < MAXCHIPID; chipId++)
+        {
+            auto& theSettings    = chipSettings[hybridId * MAXCHIPID + chipId];
+            theSettings.deviceId = CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(
+                hybridId, chipId, theSettings.chipTypeFromFile, theSettings.calibPar, theSettings.chargeCut, theSettings.triggerIdLow, theSettings.triggerIdHigh);
+
+            if(theSettings.chipTypeFromFile != "")
+            {
+                theSettings.hasGeometry  = true;
+                theSettings.theConverter = CMSITConverterPlugin::GetChipGeometry(
+                    "", theSettings.chipTypeFromFile, theSettings.nRows, theSettings.nCols, theSettings.ChipType, theSettings.deviceId, theSettings.planeId);
+            }
+        }
+}
+
+const ChipSettings& CMSITConverterPlugin::GetChipSettings(const uint32_t hybridId, const uint32_t chipId, ChipSettings& fallback) const
+{
+    if((hybridId < MAXHYBRID) && (chipId < MAXCHIPID)) return chipSettings[hybridId * MAXCHIPID + chipId];
+
+    fallback.deviceId = CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(
+        hybridId, chipId, fallback.chipTypeFromFile, fallback.calibPar, fallback.chargeCut, fallback.triggerIdLow, fallback.triggerIdHigh);
+    return fallback;
 }
 
 TheConverter CMSITConverterPlugin::GetChipGeometry(const std::string& cfgFromData, const std::string& cfgFromFile, int& nRows, int& nCols, std::string& ChipType, int deviceId, int& planeId) const
@@ -412,9 +569,17 @@ bool CMSITConverterPlugin::Deserialize(const EventSPC ev, CMSITEventData::EventD
     // Make sure the event is of class RawDataEvent
     if(auto rev = static_cast<const RawDataEvent*>(ev.get()))
     {
-        if((rev->NumBlocks() > 0) && (rev->GetBlock(0).size() > 0))
+        if(rev->NumBlocks() > 0)
         {
-            std::istringstream              theSerialized(std::string((char*)rev->GetBlock(0).data(), rev->GetBlock(0).size()));
+            const std::vector<uint8_t>& theBlock = rev->GetBlock(0);
+            if(theBlock.size() == 0) return false;
+            if(CMSITConverterPlugin::DecodeCompact(theBlock.data(), theBlock.size(), theEvent) == true) return true;
+
+            // ###############################################################
+            // # Layout not recognised (other platform or library): use Boost #
+            // ###############################################################
+            theEvent = CMSITEventData::EventData();
+            BlockStreamBuf                  theSerialized(theBlock.data(), theBlock.size());
             boost::archive::binary_iarchive theArchive(theSerialized);
             theArchive >> theEvent;
 
@@ -425,6 +590,60 @@ bool CMSITConverterPlugin::Deserialize(const EventSPC ev, CMSITEventData::EventD
     return false;
 }
 
+bool CMSITConverterPlugin::DecodeCompact(const uint8_t* data, size_t size, CMSITEventData::EventData& theEvent)
+{
+    ArchiveReader theReader(data, size);
+
+    // ##################
+    // # Archive header #
+    // ##################
+    if(theReader.GetString() != "serialization::archive") return false;
+    const uint16_t libraryVersion = theReader.Get<uint16_t>();
+    if(libraryVersion < 16) return false;
+    if((theReader.Get<uint8_t>() != sizeof(int)) || (theReader.Get<uint8_t>() != sizeof(long)) || (theReader.Get<uint8_t>() != sizeof(float)) ||
+       (theReader.Get<uint8_t>() != sizeof(double)) || (theReader.Get<int>() != 1))
+        return false;
+    if(sizeof(std::time_t) != sizeof(int64_t)) return false;
+
+    bool seenEvent = false, seenChipVector = false, seenChip = false, seenHitVector = false, seenHit = false;
+
+    theReader.ClassInfo(seenEvent);
+    theEvent.timestamp    = theReader.Get<int64_t>();
+    theEvent.nTRIGxEvent  = theReader.Get<uint32_t>();
+    theEvent.l1aCounter   = theReader.Get<uint32_t>();
+    theEvent.tdc          = theReader.Get<uint32_t>();
+    theEvent.bxCounter    = theReader.Get<uint32_t>();
+    theEvent.tluTriggerId = theReader.Get<uint32_t>();
+
+    theReader.ClassInfo(seenChipVector);
+    theEvent.chipData.resize(theReader.GetCollectionSize(8 + 7 * sizeof(uint32_t) + 12));
+    for(auto& theChip: theEvent.chipData)
+    {
+        theReader.ClassInfo(seenChip);
+        theChip.chipType   = theReader.GetString();
+        theChip.chipId     = theReader.Get<uint32_t>();
+        theChip.chipIdMod4 = theReader.Get<uint32_t>();
+        theChip.chipLane   = theReader.Get<uint32_t>();
+        theChip.hybridId   = theReader.Get<uint32_t>();
+        theChip.triggerId  = theReader.Get<uint32_t>();
+        theChip.triggerTag = theReader.Get<uint32_t>();
+        theChip.bcId       = theReader.Get<uint32_t>();
+
+        theReader.ClassInfo(seenHitVector);
+        theChip.hits.resize(theReader.GetCollectionSize(3 * sizeof(uint32_t)));
+        for(auto& theHit: theChip.hits)
+        {
+            theReader.ClassInfo(seenHit);
+            theHit.row = theReader.Get<uint32_t>();
+            theHit.col = theReader.Get<uint32_t>();
+            theHit.tot = theReader.Get<uint32_t>();
+        }
+        if(theReader.Good() == false) return false;
+    }
+
+    return theReader.AtEnd();
+}
+
 int CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(const uint32_t                       hybridId,
                                                               const uint32_t                       chipId,
                                                               std::string&                         chipTypeFromFile,
@@ -437,11 +656,8 @@ int CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(const uint32_t
     // # Set chip type #
     // #################
     const std::string pitch("pitch_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-    if(theConfigFromFile != nullptr)
-    {
-        theConfigFromFile->SetSection("sensor.geometry");
-        chipTypeFromFile = theConfigFromFile->Get(pitch, "");
-    }
+    if(theGeometrySection != nullptr)
+        chipTypeFromFile = theGeometrySection->Get(pitch, "");
     else
         chipTypeFromFile = "";
 
@@ -455,11 +671,8 @@ int CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(const uint32_t
     // # Set charge cut #
     // ##################
     const std::string charge("charge_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-    if(theConfigFromFile != nullptr)
-    {
-        theConfigFromFile->SetSection("sensor.selection");
-        chargeCut = theConfigFromFile->Get(charge, -1);
-    }
+    if(theSelectionSection != nullptr)
+        chargeCut = theSelectionSection->Get(charge, -1);
     else
         chargeCut = -1;
 
@@ -468,11 +681,10 @@ int CMSITConverterPlugin::ReadConfigurationAndComputeDeviceId(const uint32_t
     // #####################
     const std::string triggerIdL("triggerIdLow_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
     const std::string triggerIdH("triggerIdHigh_hybridId" + std::to_string(hybridId) + "_chipId" + std::to_string(chipId));
-    if(theConfigFromFile != nullptr)
+    if(theSelectionSection != nullptr)
     {
-        theConfigFromFile->SetSection("sensor.selection");
-        triggerIdLow  = theConfigFromFile->Get(triggerIdL, -1);
-        triggerIdHigh = theConfigFromFile->Get(triggerIdH, -1);
+        triggerIdLow  = theSelectionSection->Get(triggerIdL, -1);
+        triggerIdHigh = theSelectionSection->Get(triggerIdH, -1);
     }
     else
     {
@@ -494,7 +706,10 @@ bool                                                       CMSITConverterPlugin:
 int                                                        CMSITConverterPlugin::theTLUtriggerId_previous = 0;
 std::map<std::string, TheConverter::calibrationParameters> CMSITConverterPlugin::calibMap                 = {};
 std::shared_ptr<Configuration>                             CMSITConverterPlugin::theConfigFromFile        = nullptr;
+ConfigurationSectionSPC                                    CMSITConverterPlugin::theGeometrySection       = nullptr;
+ConfigurationSectionSPC                                    CMSITConverterPlugin::theSelectionSection      = nullptr;
 std::once_flag                                             CMSITConverterPlugin::callOnce;
+std::vector<ChipSettings>                                  CMSITConverterPlugin::chipSettings;
 
 namespace
 {
@@ -0,0 +1,150 @@
+#ifndef ALPIDEDECODER_HH
+#define ALPIDEDECODER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Decoder of the ALPIDE event format of the ITS3 DAQ board:
+//   AA AA AA AA | event number (4, LE) | timestamp in 80 MHz clocks (8, LE)
+//   chip data (chip empty frame, or chip header ... chip trailer)
+//   padding to 4 bytes | BB BB BB BB
+// The word type is dispatched on a 256-entry table of the leading byte and
+// the hit-map of DATA LONG words is expanded from a second table holding the
+// set bit positions of each map. Hits are collected in buffers which keep
+// their capacity from one event to the next.
+class ALPIDEDecoder{
+public:
+  static const uint32_t X_SIZE = 1024;
+  static const uint32_t Y_SIZE = 512;
+
+  // Decode one event, returns false and sets Error()/ErrorPos() on bad data
+  bool Decode(const uint8_t *data, size_t n){
+    const Tables &tab = GetTables();
+    m_x.clear();
+    m_y.clear();
+    m_error.clear();
+    m_error_pos = 0;
+    m_event_n = 0;
+    m_time = 0;
+    if(n < 20 || !IsMarker(data, 0xAA))
+      return Fail("BAD DATA. Skipping raw event.", 0);
+    for(int j = 0; j < 4; ++j) m_event_n |= uint32_t(data[4 + j]) << (j * 8);
+    for(int j = 0; j < 8; ++j) m_time |= uint64_t(data[8 + j]) << (j * 8);
+    size_t i = 16;
+    if((data[i] & 0xF0) == 0xE0){// chip empty frame
+      i += 4;
+    }else if((data[i] & 0xF0) == 0xA0){// chip header
+      i += 2;
+      uint32_t reg = 0;
+      bool trailer = false;
+      while(i < n - 4 && !trailer){
+	uint8_t data0 = data[i];
+	switch(tab.word[data0]){
+	case DATA_LONG:{
+	  if(i + 2 >= n)
+	    return Fail("BAD WORD. Truncated data long. Skipping raw event.", i);
+	  uint32_t d = reg << 14 | (data0 & 0x3F) << 8 | data[i + 1];
+	  const HitMap &map = tab.hitmap[data[i + 2]];
+	  Push(d);
+	  for(uint8_t k = 0; k < map.n; ++k)
+	    Push(d + 1 + map.bit[k]);
+	  i += 3;
+	  break;
+	}
+	case DATA_SHORT:
+	  Push(reg << 14 | (data0 & 0x3F) << 8 | data[i + 1]);
+	  i += 2;
+	  break;
+	case REGION_HEADER:
+	  reg = data0 & 0x1F;
+	  i += 1;
+	  break;
+	case CHIP_TRAILER:
+	  i += 1;
+	  i = (i + 3) / 4 * 4;
+	  trailer = true;
+	  break;
+	case IDLE:
+	  i += 1;
+	  break;
+	case EVENT_HEADER:
+	  return Fail("BAD WORD. An event header now? Skipping raw event.", i);
+	default:
+	  return Fail("BAD WORD. Skipping raw event.", i);
+	}
+      }
+    }else{
+      return Fail("BAD WORD. No event start? Skipping raw event.", i);
+    }
+    if(i + 4 > n || !IsMarker(data + i, 0xBB))
+      return Fail("BAD WORD. Bad/no event trailer? Skipping raw event.", i);
+    return true;
+  }
+
+  uint32_t EventN() const {return m_event_n;}
+  // trigger time in 80 MHz clocks
+  uint64_t Time() const {return m_time;}
+  size_t NumHits() const {return m_x.size();}
+  const std::vector<uint16_t> &X() const {return m_x;}
+  const std::vector<uint16_t> &Y() const {return m_y;}
+  const std::string &Error() const {return m_error;}
+  size_t ErrorPos() const {return m_error_pos;}
+
+private:
+  enum WordType : uint8_t {
+    BAD = 0, DATA_LONG, DATA_SHORT, REGION_HEADER, CHIP_TRAILER, IDLE, EVENT_HEADER
+  };
+  struct HitMap{
+    uint8_t n;
+    uint8_t bit[8];
+  };
+  struct Tables{
+    WordType word[256];
+    HitMap hitmap[256];
+    Tables(){
+      for(int b = 0; b < 256; ++b){
+	WordType w = BAD;
+	if((b & 0xC0) == 0x00) w = DATA_LONG;
+	else if((b & 0xC0) == 0x40) w = DATA_SHORT;
+	else if((b & 0xE0) == 0xC0) w = REGION_HEADER;
+	else if((b & 0xF0) == 0xB0) w = CHIP_TRAILER;
+	else if(b == 0xFF) w = IDLE;
+	else if(b == 0xAA) w = EVENT_HEADER;
+	word[b] = w;
+	hitmap[b].n = 0;
+	for(int k = 0; k < 8; ++k)
+	  if(b >> k & 1)
+	    hitmap[b].bit[hitmap[b].n++] = k;
+      }
+    }
+  };
+  static const Tables &GetTables(){
+    static const Tables tab;
+    return tab;
+  }
+
+  static bool IsMarker(const uint8_t *p, uint8_t m){
+    return p[0] == m && p[1] == m && p[2] == m && p[3] == m;
+  }
+  // pixel address within the chip to column and row
+  void Push(uint32_t d){
+    m_x.push_back(uint16_t((d >> 9 & 0x3FE) | ((d ^ d >> 1) & 0x1)));
+    m_y.push_back(uint16_t(d >> 1 & 0x1FF));
+  }
+  bool Fail(const std::string &msg, size_t pos){
+    m_error = msg;
+    m_error_pos = pos;
+    return false;
+  }
+
+  std::vector<uint16_t> m_x;
+  std::vector<uint16_t> m_y;
+  std::string m_error;
+  size_t m_error_pos = 0;
+  uint32_t m_event_n = 0;
+  uint64_t m_time = 0;
+};
+
+#endif // ALPIDEDECODER_HH
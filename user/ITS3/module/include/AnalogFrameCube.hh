@@ -0,0 +1,105 @@
+#ifndef ANALOGFRAMECUBE_HH
+#define ANALOGFRAMECUBE_HH
+
+#include "eudaq/Event.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Frame-major storage of the samples of an analogue read-out (CE65, APTS,
+// OPAMP): all frames of an event are decoded once into one contiguous
+// array, frame i holding the value of every pixel at Frame(i)[pixel].
+// The per-event signal extraction then runs as plain loops over the pixels
+// of a few frames, which the compiler vectorises.
+template <typename T>
+class AnalogFrameCube{
+public:
+  AnalogFrameCube():m_n_frame(0), m_n_pixel(0){}
+
+  void Resize(size_t n_frame, size_t n_pixel){
+    m_n_frame = n_frame;
+    m_n_pixel = n_pixel;
+    m_data.resize(n_frame * n_pixel);
+  }
+
+  size_t NumFrames() const {return m_n_frame;}
+  size_t NumPixels() const {return m_n_pixel;}
+  T *Frame(size_t i) {return m_data.data() + i * m_n_pixel;}
+  const T *Frame(size_t i) const {return m_data.data() + i * m_n_pixel;}
+
+  // One block per frame, each pixel a 16-bit little endian word (CE65).
+  // Returns false if a block is too short for n_pixel.
+  bool DecodeBlocks(const eudaq::Event &ev, size_t n_pixel){
+    Resize(ev.GetNumBlock(), n_pixel);
+    for(size_t i = 0; i < m_n_frame; i++){
+      const std::vector<uint8_t> &block = ev.GetBlock(i);
+      if(block.size() < n_pixel * 2)
+	return false;
+      const uint8_t *in = block.data();
+      T *out = Frame(i);
+      for(size_t p = 0; p < n_pixel; p++)
+	out[p] = T(uint16_t(in[2 * p]) | uint16_t(in[2 * p + 1]) << 8);
+    }
+    return true;
+  }
+
+  // Fixed-size frames packed in one block, each decoded to n_pixel values by
+  // unpack(const uint8_t *frame, T *pixels) (APTS and OPAMP DAQ board).
+  template <typename F>
+  void DecodeFrames(const uint8_t *data, size_t n_frame, size_t frame_size, size_t n_pixel, F unpack){
+    Resize(n_frame, n_pixel);
+    for(size_t i = 0; i < m_n_frame; i++)
+      unpack(data + i * frame_size, Frame(i));
+  }
+
+  // Correlated double sampling: out[p] = Frame(signal)[p] - Frame(baseline)[p]
+  template <typename U>
+  void Difference(size_t signal, size_t baseline, U *out) const {
+    const T *s = Frame(signal);
+    const T *b = Frame(baseline);
+    for(size_t p = 0; p < m_n_pixel; p++)
+      out[p] = U(s[p] - b[p]);
+  }
+
+  // Frame in [first, last] holding the lowest baseline-subtracted value of
+  // any pixel; the first such frame is returned on ties.
+  size_t MinimumFrame(size_t baseline, size_t first, size_t last) const {
+    const T *b = Frame(baseline);
+    size_t imin = first;
+    int32_t vmin = INT32_MAX;
+    for(size_t i = first; i <= last; i++){
+      const T *f = Frame(i);
+      int32_t v = INT32_MAX;
+      for(size_t p = 0; p < m_n_pixel; p++)
+	v = std::min(v, int32_t(f[p]) - int32_t(b[p]));
+      if(v < vmin){
+	vmin = v;
+	imin = i;
+      }
+    }
+    return imin;
+  }
+
+  // Sum of the baseline-subtracted values over the frames [first, last)
+  void Sum(size_t baseline, size_t first, size_t last, float *out) const {
+    const T *b = Frame(baseline);
+    m_sum.assign(m_n_pixel, 0);
+    for(size_t i = first; i < last; i++){
+      const T *f = Frame(i);
+      for(size_t p = 0; p < m_n_pixel; p++)
+	m_sum[p] += int32_t(f[p]) - int32_t(b[p]);
+    }
+    for(size_t p = 0; p < m_n_pixel; p++)
+      out[p] = m_sum[p];
+  }
+
+private:
+  std::vector<T> m_data;
+  mutable std::vector<int32_t> m_sum;
+  size_t m_n_frame;
+  size_t m_n_pixel;
+};
+
+#endif // ANALOGFRAMECUBE_HH
@@ -1,6 +1,8 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "ALPIDEDecoder.hh"
 #include <iostream>
+#include <map>
 
 
 class ALPIDERawEvent2StdEventConverter:public eudaq::StdEventConverter{
@@ -9,10 +11,9 @@ class ALPIDERawEvent2StdEventConverter:public eudaq::StdEventConverter{
 private:
   void Dump(const std::vector<uint8_t> &data,size_t i) const;
   struct Config {
-    int device_n;
+    int device_n = -1; // decode all fallback (used in online monitor)
   };
-  Config& LoadConf(eudaq::ConfigSPC config_) const;
-  static std::map<eudaq::ConfigSPC,Config> confs;
+  const Config &LoadConf(eudaq::ConfigSPC config_) const;
 };
 
 #define REGISTER_CONVERTER(name) namespace{auto dummy##name=eudaq::Factory<eudaq::StdEventConverter>::Register<ALPIDERawEvent2StdEventConverter>(eudaq::cstr2hash(#name));}
@@ -37,14 +38,21 @@ REGISTER_CONVERTER(ALPIDE_plane_17)
 REGISTER_CONVERTER(ALPIDE_plane_18)
 REGISTER_CONVERTER(ALPIDE_plane_19)
 
-ALPIDERawEvent2StdEventConverter::Config& ALPIDERawEvent2StdEventConverter::LoadConf(eudaq::ConfigSPC conf_) const {
-  if(confs.find(conf_)!=confs.end()) return confs[conf_];
-  EUDAQ_DEBUG("Load configuration for ALPIDE");
+const ALPIDERawEvent2StdEventConverter::Config &ALPIDERawEvent2StdEventConverter::LoadConf(eudaq::ConfigSPC conf_) const {
+  // parsed once per section snapshot, which is shared until the
+  // configuration is modified; Corryvreckan converts the events of all
+  // planes on one thread, each plane with its own configuration
+  thread_local std::map<eudaq::ConfigurationSectionSPC,Config> confs;
+  eudaq::ConfigurationSectionSPC cur=conf_?conf_->Section():nullptr;
+  auto it=confs.find(cur);
+  if(it!=confs.end()) return it->second;
+  if(confs.size()>=64) confs.clear(); // snapshots of modified configurations
   Config conf;
-  conf.device_n = -1; // decode all fallback (used in online monitor)
+  static constexpr eudaq::ConfigurationSection::Key KEY_ID("identifier");
+  std::string id=cur?cur->Get(KEY_ID,""):""; // set by corry
+  EUDAQ_DEBUG("Load configuration for ALPIDE");
 
   // pass configuration via Corryvreckan EUDAQ2EventLoader
-  std::string id=conf_?conf_->Get("identifier",""):""; // set by corry
   if(id!="") {
     size_t p=id.find("ALPIDE_"); // TODO: no idea why the identifier is quoted in the config, may change in future?
     if(p==std::string::npos) {
@@ -56,99 +64,42 @@ ALPIDERawEvent2StdEventConverter::Config& ALPIDERawEvent2StdEventConverter::Load
       EUDAQ_DEBUG(" set device number `"+id+"` from Corryvreckan");
     }
   }
-  confs[conf_]=std::move(conf);
-  return confs[conf_];
+  // cached only once parsed, a malformed identifier throws again next time
+  return confs.emplace(cur,conf).first->second;
 }
 
-std::map<eudaq::ConfigSPC,ALPIDERawEvent2StdEventConverter::Config> ALPIDERawEvent2StdEventConverter::confs;
-
 bool ALPIDERawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEventSP out,eudaq::ConfigSPC conf_) const{
-  Config &conf=LoadConf(conf_);
+  const Config &conf=LoadConf(conf_);
   if(conf.device_n==-2) return false; // Corry event loader is looking for another plane
   auto rawev=std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
-  std::vector<uint8_t> data=rawev->GetBlock(0); // FIXME: copy?
   if(conf.device_n>=0 && conf.device_n!=rawev->GetDeviceN()) return false;
-  eudaq::StandardPlane plane(rawev->GetDeviceN(),"ITS3DAQ","ALPIDE");
-  plane.SetSizeZS(1024,512,0,1); // 0 hits so far + 1 frame
-  size_t i=0;
-  size_t n=data.size();
-  if (!(data[i]==0xAA && data[i+1]==0xAA && data[i+2]==0xAA && data[i+3]==0xAA)) {
-    EUDAQ_WARN("BAD DATA. Skipping raw event."); // TODO
+  const std::vector<uint8_t> &data=rawev->GetBlock(0);
+  // the hit buffers of the decoder keep their capacity between events
+  thread_local ALPIDEDecoder decoder;
+  if(!decoder.Decode(data.data(),data.size())) {
+    EUDAQ_WARN(decoder.Error());
+    if(data.size()>=4 && decoder.ErrorPos()>0) Dump(data,decoder.ErrorPos());
     return false;
   }
-  uint64_t tev=0;
-  uint32_t iev=0;
-  for (int j=0;j<4;++j) iev|=((uint32_t)data[i+4+j])<<(j*8);
-  for (int j=0;j<8;++j) tev|=((uint64_t)data[i+8+j])<<(j*8);
-  tev*=12500; // 80Mhz clks to 1ps
+  uint64_t tev=decoder.Time()*12500; // 80Mhz clks to 1ps
 
   // forcing corry to fall back on trigger IDs
   out->SetTimeBegin(0);
   out->SetTimeEnd(0);
-  out->SetTriggerN(iev);
+  out->SetTriggerN(decoder.EventN());
 
-  i+=16;
-  uint8_t reg;
-  if((data[i]&0xF0)==0xE0) {// chip empty frame
-    i+=4;
-  } else if((data[i]&0xF0)==0xA0) {// chip header
-    i+=2;
-    while(i<n-4) {
-      uint8_t data0=data[i];
-      if((data0&0xC0)==0x00) {// data long
-      	uint32_t d=reg<<14|(data0&0x3F)<<8|data[i+1];
-       	uint16_t x=d>>9&0x3FE|(d^d>>1)&0x1;
-       	uint16_t y=d>>1&0x1FF;
-       	plane.PushPixel(x,y,1,tev); // column, row, charge, time
-       	uint8_t data2=data[i+2];
-       	d+=1;
-       	while(data2) {
-       	  if(data2&1) {
-            x=d>>9&0x3FE|(d^d>>1)&0x1;
-            y=d>>1&0x1FF;
-            plane.PushPixel(x,y,1,tev); // column, row, charge, time
-          }
-          data2>>=1;
-          d+=1;
-        }
-        i+=3;
-        } else if((data0&0xC0)==0x40) {// data short
-          uint32_t d=reg<<14|(data0&0x3F)<<8|data[i+1];
-          uint16_t x=d>>9&0x3FE|(d^d>>1)&0x1;
-          uint16_t y=d>>1&0x1FF;
-          plane.PushPixel(x,y,1,tev); // column, row, charge, time
-          i+=2;
-        } else if((data0&0xE0)==0xC0) {// region header
-          reg=data0&0x1F;
-          i+=1;
-        } else if((data0&0xF0)==0xB0) {// chip trailer
-          i+=1;
-          i=(i+3)/4*4;
-          break;
-        } else if(data0==0xFF) {// IDLE (why?)
-          i+=1;
-        } else if (data0==0xAA) {
-          EUDAQ_WARN("BAD WORD. An event header now? Skipping raw event.");
-          Dump(data,i);
-          return false;
-        } else {
-          EUDAQ_WARN("BAD WORD. Skipping raw event.");
-          Dump(data,i);
-          return false;
-        }
-      }
-    }
-  else {
-    EUDAQ_WARN("BAD WORD. No event start? Skipping raw event.");
-    Dump(data,i);
-    return false;
-  }
-  if (!(data[i]==0xBB && data[i+1]==0xBB && data[i+2]==0xBB && data[i+3]==0xBB)) {
-    EUDAQ_WARN("BAD WORD. Bad/no event trailer? Skipping raw event.");
-    Dump(data,i);
-    return false;
-  }
-  out->AddPlane(plane);
+  size_t nhit=decoder.NumHits();
+  const uint16_t *x=decoder.X().data();
+  const uint16_t *y=decoder.Y().data();
+  // all hits share charge 1 and the event time
+  thread_local std::vector<uint8_t> charge;
+  thread_local std::vector<uint64_t> time;
+  if(charge.size()<nhit) charge.resize(nhit,1);
+  time.assign(nhit,tev);
+  eudaq::StandardPlane plane(rawev->GetDeviceN(),"ITS3DAQ","ALPIDE");
+  plane.SetSizeZS(ALPIDEDecoder::X_SIZE,ALPIDEDecoder::Y_SIZE,0,1); // filled below + 1 frame
+  plane.PushPixels(nhit,x,y,charge.data(),time.data()); // column, row, charge, time
+  out->AddPlane(std::move(plane));
   return true;
 }
 
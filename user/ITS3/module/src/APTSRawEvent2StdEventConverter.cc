@@ -10,6 +10,7 @@
 // ---------NOTE: Ignore the WARNING: "Unused configuration keys in section EventLoaderEUDAQ2:..."----------------
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "AnalogFrameCube.hh"
 #include <iostream>
 #include <vector>
 #include <cmath>
@@ -166,20 +167,13 @@ bool APTSRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
     return false;
   }
   
-  uint16_t baseline[npixels];
-  unscramble(data+conf.sample_baseline*frame_size_in_byte, baseline);
+  // decode every frame up to the last one the signal extraction may use
+  size_t n_frame=std::min<size_t>(n/frame_size_in_byte,std::max(conf.maximum_sampling_frame+conf.n_signal_samples_after_min,conf.sample_baseline)+1);
+  AnalogFrameCube<uint16_t> cube;
+  cube.DecodeFrames(data,n_frame,frame_size_in_byte,npixels,unscramble);
 
   // SAMPLING POINT (=minimum)
-  int imin=0;
-  float vmin=1e6;
-  for(int is=conf.minimum_sampling_frame;is!=conf.maximum_sampling_frame+1;++is) {
-    uint16_t adcs[npixels];
-    unscramble(data+is*frame_size_in_byte,adcs); 
-    for(int i=0;i<16;++i) {
-      float v=adcs[i]-baseline[i];
-      if(v<vmin) {vmin=v;imin=is;} //vmin = value in adc of lowest point, imin is number of samplingpoint corresponding to the minimum
-    }
-  }
+  int imin=cube.MinimumFrame(conf.sample_baseline,conf.minimum_sampling_frame,conf.maximum_sampling_frame); //imin is the number of the sampling point holding the lowest baseline-subtracted value
   // SIGNAL EXTRACTION (=integral)
   if(n/frame_size_in_byte<imin+conf.n_signal_samples_after_min) {
     EUDAQ_ERROR("Error: Targeted samples for signal extraction after minimum ("+std::to_string(imin+conf.n_signal_samples_after_min)+") exceeds total number of samples ("+std::to_string(n/frame_size_in_byte)+")");
@@ -198,14 +192,11 @@ bool APTSRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
     is_fin = 2*conf.sample_baseline-imin+conf.n_signal_samples_before_min+1;
   }
 
-  for(int is=is_in; is!=is_fin; ++is) {
-    uint16_t adcs[npixels];
-    unscramble(data+is*frame_size_in_byte,adcs);
-    for(int i=0;i!=npixels;++i) {
-      float v=adcs[i]-baseline[i];
-      signal[i]+=v;
-    }
+  if(is_in<0 || is_fin>static_cast<int>(n_frame)) {
+    EUDAQ_ERROR("Error: Targeted samples for signal extraction ("+std::to_string(is_in)+" to "+std::to_string(is_fin-1)+") outside of the decoded samples (0 to "+std::to_string(n_frame-1)+")");
+    return false;
   }
+  cube.Sum(conf.sample_baseline,is_in,is_fin,signal);
   
   for(int i=0;i!=npixels;++i) signal[i]/=(1+conf.n_signal_samples_before_min+conf.n_signal_samples_after_min);
   plane.SetSizeRaw(4,4);
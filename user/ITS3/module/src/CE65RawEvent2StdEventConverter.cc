@@ -1,6 +1,10 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
+#include "eudaq/CalibrationStore.hh"
+#include "AnalogFrameCube.hh"
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include <cmath>
 
@@ -25,15 +29,19 @@ class CE65RawEvent2StdEventConverter:public eudaq::StdEventConverter{
     int  N_SUBMATRIX;
     int* subEdge;
     int* subThr;
-    // calibration file
-    TH2* hPedestal;
-    TH2* hNoise;
+    // calibration file: pedestal and noise per pixel (index iy + ix * Y_MX_SIZE)
+    eudaq::CalibrationTable calibration;
     // Signal extraction
     int  N_FRAME;
     int  triggerFrame;
     int  samplingFrame;
     int  baselineFrame;
     std::string signalMethod;
+    // Per-pixel tables (index iy + ix * Y_MX_SIZE), filled once from the
+    // calibration maps or the sub-matrix settings
+    std::vector<float> pedestal;
+    std::vector<float> threshold;
+    std::vector<float> polarity;
   };
   static Config confLocal;
 
@@ -43,7 +51,8 @@ class CE65RawEvent2StdEventConverter:public eudaq::StdEventConverter{
   bool LoadConfiguration(eudaq::ConfigSPC conf) const;
   void PrintConfiguration() const;
   bool findSubEvent(eudaq::ConfigSPC conf) const;
-  short DecodeFrameData(eudaq::EventSPC rawev, int pixelID, short* frdata) const;
+  void UpdateFrameSettings(int nFrame) const;
+  void FillPixelTables() const;
 };
 
 // Definitions for static members
@@ -57,40 +66,52 @@ REGISTER_CONVERTER(CE65Raw)
 REGISTER_CONVERTER(ce65_producer)
 
 /**
- * @brief 
+ * @brief Follow the number of frames sent by the producer
  * 
- * @param rawev 
- * @param pixelID 
- * @param frdata 
- * @return ** short Signal raw amplitude by various definitons.
+ * @param nFrame 
  */
-short CE65RawEvent2StdEventConverter::DecodeFrameData(eudaq::EventSPC rawev, int pixelID, short* frdata) const{
-  // Frame consistency
-  if(rawev->GetNumBlock() != confLocal.N_FRAME){
-    std::cout << "[+] CE65 converter - updated frame settings." << std::endl;
-    confLocal.N_FRAME = rawev->GetNumBlock();
-    confLocal.baselineFrame = 0;
-    confLocal.triggerFrame = confLocal.N_FRAME / 2;
-    confLocal.samplingFrame = confLocal.N_FRAME -1;
-    confLocal.signalMethod = "default";
-    PrintConfiguration();
-  }
-  for(int i = 0; i < rawev->GetNumBlock(); i++){
-    std::vector<uint8_t> data = rawev->GetBlock(i);
-    uint8_t byteB = data[pixelID * sizeof(short) + 1];
-    uint8_t byteA = data[pixelID * sizeof(short)];
-    frdata[i] = short((byteB<<8)+byteA);
-  }
-  // Signal raw amplitude
-    // default method
-  short rawAmp = (frdata[rawev->GetNumBlock() - 1] - frdata[0]);
-  if(confLocal.signalMethod == "fix"){
-    rawAmp = (frdata[confLocal.samplingFrame] - frdata[confLocal.baselineFrame]);
-  }else if(confLocal.signalMethod != "default"){
-    std::cout << "[+] UNKOWN signal method, use <default> instead - CE65 converter" << std::endl;
-    confLocal.signalMethod = "default";
+void CE65RawEvent2StdEventConverter::UpdateFrameSettings(int nFrame) const{
+  std::cout << "[+] CE65 converter - updated frame settings." << std::endl;
+  confLocal.N_FRAME = nFrame;
+  confLocal.baselineFrame = 0;
+  confLocal.triggerFrame = confLocal.N_FRAME / 2;
+  confLocal.samplingFrame = confLocal.N_FRAME -1;
+  confLocal.signalMethod = "default";
+  PrintConfiguration();
+}
+
+/**
+ * @brief Resolve pedestal, threshold and polarity of every pixel
+ * 
+ * Done once after the configuration is loaded, so that the conversion does
+ * not look up the calibration histograms or the sub-matrix edges per pixel.
+ */
+void CE65RawEvent2StdEventConverter::FillPixelTables() const{
+  const int nPixel = X_MX_SIZE * Y_MX_SIZE;
+  confLocal.pedestal.assign(nPixel, 0);
+  confLocal.threshold.assign(nPixel, 0);
+  confLocal.polarity.assign(nPixel, 1);
+  for(int ix=0; ix < X_MX_SIZE; ix++){
+    int thr = 0;
+    int sub = 0;
+    for(int iSub = 0; iSub < confLocal.N_SUBMATRIX; iSub++){
+      if(ix < confLocal.subEdge[iSub]){
+        thr = confLocal.subThr[iSub];
+        sub = iSub;
+        break;
+    }}// Set threshold for this sub-matrix
+    for(int iy=0; iy < Y_MX_SIZE; iy++){
+      int iPixel = iy + ix * Y_MX_SIZE;
+      confLocal.threshold[iPixel] = thr;
+      if(!confLocal.flagSimpleCut){
+        float valNoise = confLocal.calibration.At(iPixel, 1);
+        confLocal.pedestal[iPixel] = confLocal.calibration.At(iPixel, 0);
+        confLocal.threshold[iPixel] = int(valNoise * confLocal.seedSNR);
+      }
+      // Signal Polarity in sub-matrix (+,+,-)
+      if(sub == 2) confLocal.polarity[iPixel] = -1;
+    }
   }
-  return rawAmp;
 }
 
 /**
@@ -130,17 +151,29 @@ bool CE65RawEvent2StdEventConverter::LoadCalibration(const std::string& path) co
     return false;
   }
   try{
-    // Multi-threading protection
-    ROOT::EnableImplicitMT();
-    ROOT::EnableThreadSafety();
-    TFile* f = TFile::Open(path.c_str(), "READ");
-    std::cout << "[+] CE65 - Input file : " << path.c_str() << std::endl;// DEBUG
-    confLocal.hPedestal = (TH2*)( f->Get("hPedestalpl1")->Clone("hPedestal"));
-    confLocal.hNoise = (TH2*)( f->Get("hnoisepl1")->Clone("hNoise"));
-    confLocal.hPedestal->SetDirectory(nullptr);
-    confLocal.hNoise->SetDirectory(nullptr);
+    // The maps are read from ROOT once, later processes map the cached table
+    confLocal.calibration = eudaq::CalibrationStore::Load(path, "CE65.PedestalNoise", 1, [](const std::string& p){
+      // Multi-threading protection
+      ROOT::EnableImplicitMT();
+      ROOT::EnableThreadSafety();
+      std::unique_ptr<TFile> f(TFile::Open(p.c_str(), "READ"));
+      std::cout << "[+] CE65 - Input file : " << p.c_str() << std::endl;// DEBUG
+      TH2* hPedestal = f ? (TH2*)f->Get("hPedestalpl1") : nullptr;
+      TH2* hNoise = f ? (TH2*)f->Get("hnoisepl1") : nullptr;
+      if(!hPedestal || !hNoise)
+        throw std::runtime_error("pedestal or noise map missing");
+      std::vector<float> table(2 * X_MX_SIZE * Y_MX_SIZE);
+      for(int ix=0; ix < X_MX_SIZE; ix++){
+        for(int iy=0; iy < Y_MX_SIZE; iy++){
+          int iPixel = iy + ix * Y_MX_SIZE;
+          table[2 * iPixel] = hPedestal->GetBinContent(ix+1, iy+1);
+          table[2 * iPixel + 1] = hNoise->GetBinContent(ix+1, iy+1);
+        }
+      }
+      f->Close();
+      return eudaq::CalibrationTable(2, std::move(table));
+    });
     std::cout << "> Pedestal & Noise map loaded."<< std::endl;// DEBUG
-    f->Close();
   }catch(std::exception& e){
     std::cout << "[+] CE65 - FAIL to read calibration file- " << path << std::endl;
     return false;
@@ -180,8 +213,7 @@ void CE65RawEvent2StdEventConverter::InitConfiguration() const{
   confLocal.flagMonitor = false;
 
   confLocal.seedSNR = 10;
-  confLocal.hPedestal = nullptr;
-  confLocal.hNoise = nullptr;
+  confLocal.calibration = eudaq::CalibrationTable();
 
   confLocal.N_FRAME = 8;
   confLocal.triggerFrame  = 4;
@@ -319,42 +351,59 @@ bool CE65RawEvent2StdEventConverter::Converting(eudaq::EventSPC in,eudaq::StdEve
     // TODO: more than 1 plane(CE65), by sub-event name
   LoadConfiguration(conf);
 
+  if(confLocal.threshold.empty()) FillPixelTables();
+
   auto rawev=std::dynamic_pointer_cast<const eudaq::RawEvent>(in);
   
   eudaq::StandardPlane plane(rawev->GetDeviceN(),"ITS3DAQ","CE65");
   plane.SetSizeZS(X_MX_SIZE, Y_MX_SIZE,0,1);
     // TODO: other information - event no., timestamp, trigger, ...
-  
-  // Frame <-> Block (from Producer)
-  for(int ix=0; ix < X_MX_SIZE; ix++){
-    int thr = 0;
-    int sub = 0;
-    for(int iSub = 0; iSub < confLocal.N_SUBMATRIX; iSub++){
-      if(ix < confLocal.subEdge[iSub]){
-        thr = confLocal.subThr[iSub];
-        sub = iSub;
-        break;
-    }}// Set threshold for this sub-matrix
-    for(int iy=0; iy < Y_MX_SIZE; iy++){
-      int iPixel = iy + ix * Y_MX_SIZE;
-      // raw amp: uint8 *2 -> uint16
-      short frdata[rawev->GetNumBlock()];
-      float raw = float(DecodeFrameData(rawev, iPixel, frdata));
-      float charge = raw; // Charge in ADC unit
-      if(!confLocal.flagSimpleCut){
-        float valNoise = confLocal.hNoise->GetBinContent(ix+1, iy+1);
-        float valPedestal = confLocal.hPedestal->GetBinContent(ix+1, iy+1);
-        charge = raw - valPedestal;
-        thr = valNoise * confLocal.seedSNR;
-      }
-      // Signal Polarity in sub-matrix (+,+,-)
-      if(sub == 2) charge = (-charge);
-      if(!confLocal.flagMonitor){
-        plane.PushPixel(ix, iy, charge);
-      }else if(std::abs(raw) > thr){
-        plane.PushPixel(ix, iy, 1);
-      }
-  }} // End - loop pixels
+
+  // Frame consistency
+  const int nFrame = rawev->GetNumBlock();
+  if(nFrame != confLocal.N_FRAME) UpdateFrameSettings(nFrame);
+  if(nFrame == 0) return false;
+  // Signal raw amplitude
+    // default method
+  int iSignal = nFrame - 1;
+  int iBaseline = 0;
+  if(confLocal.signalMethod == "fix"){
+    iSignal = confLocal.samplingFrame;
+    iBaseline = confLocal.baselineFrame;
+    if(iSignal < 0 || iSignal >= nFrame || iBaseline < 0 || iBaseline >= nFrame){
+      EUDAQ_ERROR("CE65: sampling_frame "+std::to_string(iSignal)+" or baseline_frame "+std::to_string(iBaseline)+" outside of the "+std::to_string(nFrame)+" frames");
+      return false;
+    }
+  }else if(confLocal.signalMethod != "default"){
+    std::cout << "[+] UNKOWN signal method, use <default> instead - CE65 converter" << std::endl;
+    confLocal.signalMethod = "default";
+  }
+
+  // Frame <-> Block (from Producer), raw amp: uint8 *2 -> uint16
+  const int nPixel = X_MX_SIZE * Y_MX_SIZE;
+  AnalogFrameCube<int16_t> cube;
+  if(!cube.DecodeBlocks(*rawev, nPixel)){
+    EUDAQ_ERROR("CE65: frame block shorter than "+std::to_string(nPixel)+" pixels");
+    return false;
+  }
+  std::vector<int16_t> raw(nPixel);
+  std::vector<float> charge(nPixel); // Charge in ADC unit
+  cube.Difference(iSignal, iBaseline, raw.data());
+  const float *pedestal = confLocal.pedestal.data();
+  const float *polarity = confLocal.polarity.data();
+  for(int i = 0; i < nPixel; i++)
+    charge[i] = (raw[i] - pedestal[i]) * polarity[i];
+
+  // Pixel index iy + ix * Y_MX_SIZE, the order of the former ix/iy loop
+  for(int iPixel = 0; iPixel < nPixel; iPixel++){
+    int ix = iPixel / Y_MX_SIZE;
+    int iy = iPixel % Y_MX_SIZE;
+    if(!confLocal.flagMonitor){
+      plane.PushPixel(ix, iy, charge[iPixel]);
+    }else if(std::abs(raw[iPixel]) > confLocal.threshold[iPixel]){
+      plane.PushPixel(ix, iy, 1);
+    }
+  } // End - loop pixels
   
   out->AddPlane(plane);
 
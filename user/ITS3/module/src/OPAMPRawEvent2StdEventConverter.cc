@@ -1,4 +1,5 @@
 #include "eudaq/RawEvent.hh"
+#include "AnalogFrameCube.hh"
 #include "eudaq/StdEventConverter.hh"
 #include <cmath>
 #include <iostream>
@@ -284,20 +285,13 @@ bool OPAMPRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,
     EUDAQ_ERROR("Error: Baseline sample number ("+std::to_string(conf.sample_baseline_opamp)+") exceeds total number of samples ("+std::to_string(n/frame_size_in_byte)+")");
     return false;
   }
-  uint16_t baseline[npixels];
-  unscramble(data+conf.sample_baseline_opamp*frame_size_in_byte, baseline);
+  // decode every frame up to the last one the signal extraction may use
+  size_t n_frame=std::min<size_t>(n/frame_size_in_byte,std::max(conf.last_sample_minimum_finder_opamp+conf.n_samples_after_min_signal_opamp,conf.sample_baseline_opamp)+1);
+  AnalogFrameCube<uint16_t> cube;
+  cube.DecodeFrames(data,n_frame,frame_size_in_byte,npixels,unscramble);
 
   // SAMPLING POINT (=minimum)
-  int imin=0;
-  float vmin=1e6;
-  for(int is=conf.first_sample_minimum_finder_opamp;is!=conf.last_sample_minimum_finder_opamp+1;++is) {
-    uint16_t adcs[npixels];
-    unscramble(data+is*frame_size_in_byte,adcs);
-    for(int i=0;i<npixels;++i) {
-      float v=adcs[i]-baseline[i];
-      if(v<vmin) {vmin=v;imin=is;} //vmin = value in adc of lowest point, imin is the number of sampling point corresponding to the minimum
-    }
-  }
+  int imin=cube.MinimumFrame(conf.sample_baseline_opamp,conf.first_sample_minimum_finder_opamp,conf.last_sample_minimum_finder_opamp); //imin is the number of the sampling point holding the lowest baseline-subtracted value
   // SIGNAL EXTRACTION (=integral)
   if(n/frame_size_in_byte<imin+conf.n_samples_after_min_signal_opamp) {
     EUDAQ_ERROR("Error: Targeted samples for signal extraction after minimum ("+std::to_string(imin+conf.n_samples_after_min_signal_opamp)+") exceeds total number of samples ("+std::to_string(n/frame_size_in_byte)+")");
@@ -315,14 +309,11 @@ bool OPAMPRawEvent2StdEventConverter::Converting(eudaq::EventSPC in,
     is_fin = 2*conf.sample_baseline_opamp-imin+conf.n_samples_before_min_signal_opamp+1;
   }
 
-  for(int is=is_in; is!=is_fin; ++is) {
-    uint16_t adcs[npixels];
-    unscramble(data+is*frame_size_in_byte,adcs);
-    for(int i=0;i!=npixels;++i) {
-      float v=adcs[i]-baseline[i];
-      signal[i]+=v;
-    }
+  if(is_in<0 || is_fin>static_cast<int>(n_frame)) {
+    EUDAQ_ERROR("Error: Targeted samples for signal extraction ("+std::to_string(is_in)+" to "+std::to_string(is_fin-1)+") outside of the decoded samples (0 to "+std::to_string(n_frame-1)+")");
+    return false;
   }
+  cube.Sum(conf.sample_baseline_opamp,is_in,is_fin,signal);
   for(int i=0;i!=npixels;++i) {
       signal[i] /= (1+conf.n_samples_before_min_signal_opamp+conf.n_samples_after_min_signal_opamp);
       signal[i] = signal[i] / (conf.gain[i] / conf.gain[ref_px_idx]); //signal with relative gain correction applied
@@ -0,0 +1,92 @@
+#ifndef CAENWAVEFORM_HH
+#define CAENWAVEFORM_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Features of a digitizer waveform. All values refer to the waveform
+// multiplied by its polarity, i.e. the signal is always positive.
+struct WaveformFeatures {
+    int polarity = 1;
+    // median of the samples
+    float baseline = 0;
+    float stddev = 0;
+    // highest sample, signed back with the polarity; 0 when there is no signal
+    float amplitude = 0;
+    size_t peak = 0;
+    // number of samples above the signal threshold
+    size_t tot = 0;
+};
+
+// Baseline and amplitude extraction of the CAEN DT5742/5748 waveforms:
+// min/max, mean and spread are single passes over the samples, the median
+// is an O(n) selection in a scratch buffer reused between waveforms.
+class CAENWaveform {
+    public:
+        // The producer sends each channel as a block of native floats
+        static void Decode(const std::vector<uint8_t> & block, std::vector<float> & wf) {
+            wf.resize(block.size() / sizeof(float));
+            if(!wf.empty()) {
+                std::memcpy(wf.data(), block.data(), wf.size() * sizeof(float));
+            }
+        }
+
+        WaveformFeatures Analyse(const std::vector<float> & wf) {
+            WaveformFeatures f;
+            const size_t n = wf.size();
+            if(n == 0) {
+                return f;
+            }
+            const float * v = wf.data();
+
+            float min = v[0];
+            float max = v[0];
+            double sum = 0;
+            for(size_t i = 0; i < n; ++i) {
+                min = std::min(min, v[i]);
+                max = std::max(max, v[i]);
+                sum += v[i];
+            }
+            f.polarity = (std::abs(min) > std::abs(max)) ? -1 : 1;
+            const double mean = sum / n;
+            double sum2 = 0;
+            for(size_t i = 0; i < n; ++i) {
+                sum2 += (v[i] - mean) * (v[i] - mean);
+            }
+            f.stddev = std::sqrt(sum2 / n);
+
+            // Median: the middle element, averaged with its lower neighbour
+            // for an even number of samples
+            _scratch.assign(v, v + n);
+            auto mid = _scratch.begin() + n / 2;
+            std::nth_element(_scratch.begin(), mid, _scratch.end());
+            double median = *mid;
+            if(n % 2 == 0) {
+                median = (median + *std::max_element(_scratch.begin(), mid)) / 2.0;
+            }
+            f.baseline = f.polarity * median;
+
+            const float top = (f.polarity > 0) ? max : -min;
+            f.peak = std::find(v, v + n, f.polarity > 0 ? max : min) - v;
+
+            // Assume 3 sigma to be signal
+            const double threshold = 3.0 * (f.baseline + f.stddev);
+            if(top > threshold) {
+                f.amplitude = top * f.polarity;
+                size_t tot = 0;
+                for(size_t i = 0; i < n; ++i) {
+                    tot += (v[i] * f.polarity > threshold);
+                }
+                f.tot = tot;
+            }
+            return f;
+        }
+
+    private:
+        std::vector<float> _scratch;
+};
+
+#endif // CAENWAVEFORM_HH
@@ -4,6 +4,8 @@
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
 
+#include "CAENWaveform.hh"
+
 #include <vector>
 #include <map>
 #include <array>
@@ -12,6 +14,7 @@
 #include <regex>
 #include <numeric>
 #include <cmath>
+#include <iterator>
 
 // Digitizer: { channel : [ (row, col), (row, col), ... ], 
 // Each channel can be bounded to several diodes/pixels
@@ -25,10 +28,6 @@ class CAENDT5748RawEvent2StdEventConverter: public eudaq::StdEventConverter {
     private:
         void Initialize(eudaq::EventSPC bore, eudaq::ConfigurationSPC conf) const;
         PixelMap GetDUTPixelMap(const std::string & dut_tag) const; 
-        // Helper functions
-        std::vector<float> uint8VectorToFloatVector(std::vector<uint8_t> data) const;
-        int PolarityWF(const std::vector<float> & wf) const;
-        float AmplitudeWF(const std::vector<float> & wf) const;
 
         static std::map<int, std::string> _name;
         // XXX -- NEEDED?
@@ -172,92 +171,6 @@ void CAENDT5748RawEvent2StdEventConverter::Initialize(eudaq::EventSPC bore, euda
     EUDAQ_DEBUG(" Initialize:: Channel list (internal-ids): [ " + oss.str() +" ]");
 }
 
-std::vector<float> CAENDT5748RawEvent2StdEventConverter::uint8VectorToFloatVector(std::vector<uint8_t> data) const {
-    // Everything in this function, except for this single line, was provided to me by ChatGPT. Amazing.
-    std::vector<float> result;
-    // size the result vector appropriately
-    result.resize(data.size() / sizeof(float)); 
-    // cast the pointer to float
-    float* resultPtr = reinterpret_cast<float*>(&result[0]);
-
-    // get a pointer to the data in the uint8_t vector
-    uint8_t* dataPtr = &data[0];
-
-    // get the size of the data in the uint8_t vector
-    size_t dataSize = data.size(); 
-
-    for (size_t i = 0; i < dataSize; i += sizeof(float)) {
-        // cast the value at dataPtr to float and store in result vector
-        *resultPtr = *reinterpret_cast<float*>(dataPtr); 
-        resultPtr++;
-        dataPtr += sizeof(float);
-    }
-
-    return result;
-}
-
-// FIXME -- Calculate it once: use a memoizer
-int CAENDT5748RawEvent2StdEventConverter::PolarityWF(const std::vector<float> & wf) const {
-    // Extract polarity -- XXX-- Just do it once ? -- then, TODO
-    auto itminmax = std::minmax_element(wf.begin(), wf.end());
-    const float min = *itminmax.first;
-    const float max = *itminmax.second;
-    if( std::abs(*itminmax.first) > std::abs(*itminmax.second) ) {
-        return -1;
-    }
-    return 1;
-}
-
-
-float CAENDT5748RawEvent2StdEventConverter::AmplitudeWF(const std::vector<float>& waveform) const {
-    // Rough estimation of the baseline using the median
-    // But first use the right polarity to be sure we sort properly
-    const int polarity = PolarityWF(waveform); 
-    std::vector<float> wf_abs(waveform);
-    for(float & v: wf_abs) {
-        v * polarity;
-    }
-    //
-    // All signals are now positives
-    // -----------------------------
-
-    // Sorted: smaller firts
-    std::sort(wf_abs.begin(), wf_abs.end());
-    const size_t wfsize = wf_abs.size();
-    if(wfsize == 0) {
-        return 0.0;
-    }
-
-    double baseline = 0;
-    if(wfsize % 2 == 0) {
-        // If even, we need to obtain the average of the two central values
-        baseline = (wf_abs[wfsize/2 - 1]+wf_abs[wfsize/2])/2.0;
-    } 
-    else {
-        baseline = wf_abs[wfsize/2];
-    }
-    // We need to evaluate a kind of sigma, to get an estimation
-    // if there is a signal there
-    const double wf_amplitude_max = wf_abs[wfsize-1];
-
-    // --> Calculate the deviation standard -- XXX - ?
-    const double mean = std::accumulate(wf_abs.begin(), wf_abs.end(),0.0)/wfsize;
-    auto sum_term = [mean](double init, double value)-> double { return init + (value - mean)*(value - mean); };
-    const double variance = std::accumulate(wf_abs.begin(), wf_abs.end(), 0.0, sum_term);
-    const double stddev = std::sqrt(variance/wfsize);
-    
-/*std::cout << " Baseline: " << baseline << " -- " << wf_amplitude_max 
-    << " 3sigma?" << 3.0*stddev << std::endl;*/
-    // Assume 3 sigma to be signal
-    if( wf_amplitude_max > 3.0*(baseline + stddev) ) {
-        return wf_amplitude_max*polarity;
-    }
-
-    return 0.0;
-}
-
-
-
 bool CAENDT5748RawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StdEventSP d2, eudaq::ConfigSPC conf) const {
 
     auto event = std::dynamic_pointer_cast<const eudaq::RawDataEvent>(d1);
@@ -294,6 +207,9 @@ bool CAENDT5748RawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq:
     }
 
     const std::string producer_name = _name[d1->GetDeviceN()];
+    // Buffers reused for all channels of the event
+    CAENWaveform wf_engine;
+    std::vector<float> raw_data;
     // Each DUT is a plane
     for(const auto & dutname_sensorid: _dut_names_id[dev_id]) {
         // XXX - Can we provide a dutname in the stdplane?? 
@@ -310,7 +226,7 @@ bool CAENDT5748RawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq:
         int pixid = 0;
         for(const auto & ch_rowcollist: _dut_channel_arrangement[dev_id][dutname_sensorid.second]) {
             const size_t n_block = ch_rowcollist.first;
-            std::vector<float> raw_data = uint8VectorToFloatVector(event->GetBlock(n_block));
+            CAENWaveform::Decode(event->GetBlock(n_block), raw_data);
             
             // XXX -- Make this sense? Just to avoid crashing... [PROV]
             if(raw_data.size() == 0)
@@ -324,9 +240,11 @@ bool CAENDT5748RawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq:
 
             // XXX -- Is this what we want? Or maybe extract the integral? 
             //        for sure we'd like to get the rise time as well?
-            float amplitude = AmplitudeWF(raw_data);
+            const float amplitude = wf_engine.Analyse(raw_data).amplitude;
 
-            std::vector<double> wf(raw_data.begin(), raw_data.end());
+            // The waveform is stored with the first pixel of the channel,
+            // the other pixels refer to it
+            const int ch_pixid = pixid;
             
 /*if(producer_name == "CAEN_IJS")
 {
@@ -341,7 +259,12 @@ std::cout << "Block id: " << ch_rowcollist.first << " pixid: " << pixid << ", pi
                 // Note the signature introduce x,y -> col, row. Opposite to which we store
                 plane.PushPixel(pixel[1], pixel[0], amplitude, uint32_t(0));
                 plane.SetPixelAuxInfo(pixid, dutname_sensorid.first+":CH"+std::to_string(ch_rowcollist.first)+":col"+std::to_string(pixel[1])+":row"+std::to_string(pixel[0]));
-                plane.SetWaveform(pixid, wf, _t0[dev_id], _dt[dev_id] );
+                if(pixid == ch_pixid) {
+                    plane.SetWaveform(pixid, std::vector<double>(raw_data.begin(), raw_data.end()), _t0[dev_id], _dt[dev_id] );
+                }
+                else {
+                    plane.SetWaveformReference(pixid, ch_pixid);
+                }
                 ++pixid;
             }
         }
@@ -5,6 +5,8 @@
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
 
+#include "CAENWaveform.hh"
+
 #include <vector>
 #include <map>
 #include <array>
@@ -53,6 +55,9 @@ class CAENDT5748RawEvent2TTreeEventConverter: public eudaq::TTreeEventConverter
         static std::map<int, std::map<int,int> > _npixels;
         // Human-readable name related with the internal DUT-id
         static std::map<int, std::map<std::string,int> > _dut_names_id;
+
+        // buffer of the "event" branch
+        mutable Int_t _event_id = 0;
 };
 
 namespace {
@@ -213,50 +218,7 @@ int CAENDT5748RawEvent2TTreeEventConverter::PolarityWF(const std::vector<float>
 
 
 float CAENDT5748RawEvent2TTreeEventConverter::AmplitudeWF(const std::vector<float>& waveform) const {
-    // Rough estimation of the baseline using the median
-    // But first use the right polarity to be sure we sort properly
-    const int polarity = PolarityWF(waveform); 
-    std::vector<float> wf_abs(waveform);
-    for(float & v: wf_abs) {
-        v * polarity;
-    }
-    //
-    // All signals are now positives
-    // -----------------------------
-
-    // Sorted: smaller firts
-    std::sort(wf_abs.begin(), wf_abs.end());
-    const size_t wfsize = wf_abs.size();
-    if(wfsize == 0) {
-        return 0.0;
-    }
-
-    double baseline = 0;
-    if(wfsize % 2 == 0) {
-        // If even, we need to obtain the average of the two central values
-        baseline = (wf_abs[wfsize/2 - 1]+wf_abs[wfsize/2])/2.0;
-    } 
-    else {
-        baseline = wf_abs[wfsize/2];
-    }
-    // We need to evaluate a kind of sigma, to get an estimation
-    // if there is a signal there
-    const double wf_amplitude_max = wf_abs[wfsize-1];
-
-    // --> Calculate the deviation standard -- XXX - ?
-    const double mean = std::accumulate(wf_abs.begin(), wf_abs.end(),0.0)/wfsize;
-    auto sum_term = [mean](double init, double value)-> double { return init + (value - mean)*(value - mean); };
-    const double variance = std::accumulate(wf_abs.begin(), wf_abs.end(), 0.0, sum_term);
-    const double stddev = std::sqrt(variance/wfsize);
-    
-/*std::cout << " Baseline: " << baseline << " -- " << wf_amplitude_max 
-    << " 3sigma?" << 3.0*stddev << std::endl;*/
-    // Assume 3 sigma to be signal
-    if( wf_amplitude_max > 3.0*(baseline + stddev) ) {
-        return wf_amplitude_max*polarity;
-    }
-
-    return 0.0;
+    return CAENWaveform().Analyse(waveform).amplitude;
 }
 
 
@@ -285,13 +247,8 @@ bool CAENDT5748RawEvent2TTreeEventConverter::Converting(eudaq::EventSPC d1, euda
         return false;
     }
 
-    int event_id = d1->GetEventN();
-    TString b_evt = "event";
-    if( d2->GetListOfBranches()->FindObject(b_evt) ) {
-        d2->SetBranchAddress(b_evt, &event_id);
-    } else {
-        d2->Branch(b_evt, &event_id, "event/I");
-    }
+    BindBranch(d2.get(), "event", &_event_id, "event/I");
+    _event_id = d1->GetEventN();
 
 
     const std::string producer_name = _name[d1->GetDeviceN()];
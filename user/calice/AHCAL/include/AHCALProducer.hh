@@ -2,6 +2,7 @@
 #define AHCALPRODUCER_HH
 
 #include "eudaq/Producer.hh"
+#include "AHCALReader.hh"
 
 #include <vector>
 #include <deque>
@@ -12,45 +13,11 @@
 
 namespace eudaq {
 
-   class AHCALProducer;
-
-   class AHCALReader {
-      public:
-         virtual void Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) = 0;
-         virtual void buildEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) {
-         }
-         virtual void OnStart(int runNo) {
-         }
-         virtual void OnStop(int waitQueueTimeS) {
-         }
-         virtual void OnConfigLED(std::string _fname) {
-         }
-
-         AHCALReader(AHCALProducer *r) :
-               _producer(r) {
-         }
-         virtual ~AHCALReader() {
-         }
+   class AHCALProducer: public eudaq::Producer, public AHCALReaderHost {
       public:
-         std::mutex _eventBuildingQueueMutex;
-
-      protected:
-
-         AHCALProducer * _producer;
-   };
-
-   class AHCALProducer: public eudaq::Producer {
-      public:
-
-         enum class EventBuildingMode {
-            ROC, TRIGGERID, BUILD_BXID_ALL, BUILD_BXID_VALIDATED
-         };
-         enum class EventNumbering {
-            TRIGGERID, TIMESTAMP
-         };
-
          AHCALProducer(const std::string & name, const std::string & runcontrol);
          void DoConfigure() override final;
+         void ReadConfiguration(const eudaq::Configuration &param); //settings only, no connection to the LDA
          void DoStartRun() override final;
          void DoStopRun() override final;
          void DoTerminate() override final;
@@ -61,39 +28,16 @@ namespace eudaq {
          void SetReader(AHCALReader *r) {
             _reader = r;
          }
-         bool OpenConnection(); //
-         void CloseConnection(); //
+         bool OpenConnection() override; //
+         void CloseConnection() override; //
          bool OpenConnection_unsafe(); //
          void CloseConnection_unsafe(); //
-         void SendCommand(const char *command, int size = 0);
+         void SendCommand(const char *command, int size = 0) override;
 
          void OpenRawFile(unsigned param, bool _writerawfilename_timestamp);
          void sendallevents(std::deque<eudaq::EventUP> &deqEvent, int minimumsize);
 
-         AHCALProducer::EventBuildingMode getEventMode() const;
-         AHCALProducer::EventNumbering getEventNumberingPreference() const;
-         int getLdaTrigidOffset() const;
-         int getLdaTrigidStartsFrom() const;
-         int getAhcalbxid0Offset() const;
-         int getAhcalbxidWidth() const;
-         int getInsertDummyPackets() const;
-         int getDebugKeepBuffered() const;
-         int getGenerateTriggerIDFrom() const;
-         int getColoredTerminalMessages() const;
-         int getIgnoreLdaTimestamps() const;
-
       private:
-         AHCALProducer::EventBuildingMode _eventBuildingMode;
-         AHCALProducer::EventNumbering _eventNumberingPreference;
-         int _LdaTrigidOffset; //LdaTrigidOffset to compensate trigger number differences between TLU (or other trigger number source) and LDA. Eudaq Event counting starts from this number and will be always subtracted from the eudaq event triggerid.
-         int _LdaTrigidStartsFrom;   // triggerID number of first valid event in case it doesn't start from 0
-         int _AHCALBXID0Offset; //offset from start acquisition Timestamp to BXID0 (in 25ns steps). Varies with AHCAL powerpulsing setting and DIF firmware
-         int _AHCALBXIDWidth; //length of the bxid in 25 ns steps
-         int _InsertDummyPackets; //1=Put dummy packets to maintain an uninterrupted sequence of TriggerIDs. 0=don't inset anything
-         int _DebugKeepBuffered; //1=keep events in buffer and don't send them to data collector
-         int _GenerateTriggerIDFrom; //sets from which triggerID number should be data generated (and filled with dummy triggers if necessary). Only works when insert_dummy_packets is enabled and in selected event building mode
-         int _ColoredTerminalMessages; //1 for colored error worning and info messages
-         int _IgnoreLdaTimestamps; //ignores the timestamp in the AHCAL LDA data stream
          int _StartWaitSeconds; //wait a fixed amount of seconds, befor the DoStartRun is executed
          int _runNo;
          int _eventNo; //last sent event - for checking of correct event numbers sequence during sending events
@@ -0,0 +1,88 @@
+#ifndef AHCALREADER_HH
+#define AHCALREADER_HH
+
+#include "eudaq/Event.hh"
+#include "eudaq/Configuration.hh"
+#include "LdaStream.hh"
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace eudaq {
+
+   // What a reader needs from its owner: the event building settings and the
+   // connection to the LDA. Implemented by the AHCALProducer, and by
+   // AHCALReplay without any connection.
+   class AHCALReaderHost {
+      public:
+         enum class EventBuildingMode {
+            ROC, TRIGGERID, BUILD_BXID_ALL, BUILD_BXID_VALIDATED
+         };
+         enum class EventNumbering {
+            TRIGGERID, TIMESTAMP
+         };
+
+         AHCALReaderHost();
+         virtual ~AHCALReaderHost() {
+         }
+         void ReadReaderSettings(const eudaq::Configuration &param); //event building settings only
+
+         virtual bool OpenConnection() = 0;
+         virtual void CloseConnection() = 0;
+         virtual void SendCommand(const char *command, int size = 0) = 0;
+
+         EventBuildingMode getEventMode() const;
+         EventNumbering getEventNumberingPreference() const;
+         int getLdaTrigidOffset() const;
+         int getLdaTrigidStartsFrom() const;
+         int getAhcalbxid0Offset() const;
+         int getAhcalbxidWidth() const;
+         int getInsertDummyPackets() const;
+         int getDebugKeepBuffered() const;
+         int getGenerateTriggerIDFrom() const;
+         int getColoredTerminalMessages() const;
+         int getIgnoreLdaTimestamps() const;
+
+      protected:
+         EventBuildingMode _eventBuildingMode;
+         EventNumbering _eventNumberingPreference;
+         int _LdaTrigidOffset; //LdaTrigidOffset to compensate trigger number differences between TLU (or other trigger number source) and LDA. Eudaq Event counting starts from this number and will be always subtracted from the eudaq event triggerid.
+         int _LdaTrigidStartsFrom;   // triggerID number of first valid event in case it doesn't start from 0
+         int _AHCALBXID0Offset; //offset from start acquisition Timestamp to BXID0 (in 25ns steps). Varies with AHCAL powerpulsing setting and DIF firmware
+         int _AHCALBXIDWidth; //length of the bxid in 25 ns steps
+         int _InsertDummyPackets; //1=Put dummy packets to maintain an uninterrupted sequence of TriggerIDs. 0=don't inset anything
+         int _DebugKeepBuffered; //1=keep events in buffer and don't send them to data collector
+         int _GenerateTriggerIDFrom; //sets from which triggerID number should be data generated (and filled with dummy triggers if necessary). Only works when insert_dummy_packets is enabled and in selected event building mode
+         int _ColoredTerminalMessages; //1 for colored error worning and info messages
+         int _IgnoreLdaTimestamps; //ignores the timestamp in the AHCAL LDA data stream
+   };
+
+   class AHCALReader {
+      public:
+         virtual void Read(LdaStream & buf, std::deque<eudaq::EventUP> & deqEvent) = 0;
+         virtual void buildEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) {
+         }
+         virtual void OnStart(int runNo) {
+         }
+         virtual void OnStop(int waitQueueTimeS) {
+         }
+         virtual void OnConfigLED(std::string _fname) {
+         }
+
+         AHCALReader(AHCALReaderHost *r) :
+               _producer(r) {
+         }
+         virtual ~AHCALReader() {
+         }
+      public:
+         std::mutex _eventBuildingQueueMutex;
+
+      protected:
+
+         AHCALReaderHost * _producer;
+   };
+
+}
+
+#endif // AHCALREADER_HH
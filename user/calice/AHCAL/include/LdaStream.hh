@@ -0,0 +1,66 @@
+#ifndef LDASTREAM_HH
+#define LDASTREAM_HH
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace eudaq {
+
+   // Contiguous buffer of the byte stream received from the LDA. Data are
+   // read from the socket directly into the free space at the back and
+   // consumed from the front. The unread bytes are moved to the start of the
+   // storage only when the space at the back runs short, so each LDA packet
+   // stays contiguous and is framed and decoded in place.
+   class LdaStream {
+      public:
+         LdaStream(size_t capacity = 1 << 20) :
+               _buf(capacity), _begin(0), _end(0) {
+         }
+         size_t size() const {
+            return _end - _begin;
+         }
+         bool empty() const {
+            return _end == _begin;
+         }
+         const char *data() const {
+            return _buf.data() + _begin;
+         }
+         char operator[](size_t i) const {
+            return _buf[_begin + i];
+         }
+         // at least n bytes of free space to be filled and then committed
+         char *prepare(size_t n) {
+            if (_buf.size() - _end < n) {
+               if (_begin) {
+                  std::memmove(_buf.data(), _buf.data() + _begin, _end - _begin);
+                  _end -= _begin;
+                  _begin = 0;
+               }
+               if (_buf.size() - _end < n) _buf.resize(std::max(2 * _buf.size(), _end + n));
+            }
+            return _buf.data() + _end;
+         }
+         void commit(size_t n) {
+            _end += n;
+         }
+         void append(const char *data, size_t n) {
+            std::memcpy(prepare(n), data, n);
+            commit(n);
+         }
+         void consume(size_t n) {
+            _begin += std::min(n, size());
+            if (_begin == _end) _begin = _end = 0;
+         }
+         void clear() {
+            _begin = _end = 0;
+         }
+      private:
+         std::vector<char> _buf;
+         size_t _begin;
+         size_t _end;
+   };
+
+}
+
+#endif // LDASTREAM_HH
@@ -1,7 +1,7 @@
 #ifndef SCREADER_HH
 #define SCREADER_HH
 
-#include "AHCALProducer.hh"
+#include "AHCALReader.hh"
 #include "eudaq/RawEvent.hh"
 
 #include <deque>
@@ -10,18 +10,19 @@ namespace eudaq {
 
    class ScReader: public AHCALReader {
       public:
-         virtual void Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) override;
+         virtual void Read(LdaStream & buf, std::deque<eudaq::EventUP> & deqEvent) override;
          virtual void OnStart(int runNo) override;
+         void ResetRun(int runNo); //state of a new run, without connecting to the LDA
          virtual void OnStop(int waitQueueTimeS) override;
          virtual void OnConfigLED(std::string _fname) override; //chose configuration file for LED runs
          virtual void buildEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) override;
 
          virtual std::deque<eudaq::RawEvent *> NewEvent_createRawDataEvent(std::deque<eudaq::RawEvent *> deqEvent, bool tempcome, int LdaRawcycle, bool newForced);
-         virtual void readTemperature(std::deque<char>& buf);
+         virtual void readTemperature(LdaStream& buf);
 
          void appendOtherInfo(eudaq::RawEvent * ev);
 
-         ScReader(AHCALProducer *r); //:
+         ScReader(AHCALReaderHost *r); //:
 //               AHCALReader(r),
 //                     _runNo(-1),
 //                     _buffer_inside_acquisition(false),
@@ -73,7 +74,23 @@ namespace eudaq {
             SLOWCONTROL = (unsigned int) 0x0002,
          };
          enum {
-            e_sizeLdaHeader = 10 // 8bytes + 0xcdcd
+            e_sizeLdaHeader = 10, // 8bytes + 0xcdcd
+            e_nChannels = 36,
+            e_minipacketWords = 5 + 2 * e_nChannels // cycle, bxid, memory cell, chip id, channels, TDCs, ADCs
+         };
+
+         // minipackets of one readout cycle, e_minipacketWords ints each, in the order of arrival
+         struct AsicCycle {
+               std::vector<int> words;
+               size_t size() const {
+                  return words.size() / e_minipacketWords;
+               }
+               const int *packet(size_t i) const {
+                  return words.data() + i * e_minipacketWords;
+               }
+               int bxid(size_t i) const {
+                  return words[i * e_minipacketWords + 1];
+               }
          };
          enum BufferProcessigExceptions {
             ERR_INCOMPLETE_INFO_CYCLE,
@@ -90,6 +107,7 @@ namespace eudaq {
          void buildValidatedBXIDEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll);
          void insertDummyEvent(std::deque<eudaq::EventUP> &EventQueue, int eventNumber, int triggerid, bool triggeridFlag);
          void prepareEudaqRawPacket(eudaq::RawEvent * ev);
+         void addMinipacket(eudaq::RawEvent * ev, const AsicCycle &cycle, size_t i);
 
          static const unsigned char C_TSTYPE_START_ACQ = 0x01;
          static const unsigned char C_TSTYPE_STOP_ACQ = 0x02;
@@ -101,8 +119,8 @@ namespace eudaq {
          static const unsigned int C_TS_IGNORE_ROC_JUMPS_UP_TO = 20;
          static const uint64_t C_MILLISECOND_TICS = 40000; //how many clock cycles make a millisecond
 
-         void readAHCALData(std::deque<char> &buf, std::map<int, std::vector<std::vector<int> > > &AHCALData);
-         void readLDATimestamp(std::deque<char> &buf, std::map<int, LDATimeData> &LDATimestamps);
+         void readAHCALData(LdaStream &buf, std::map<int, AsicCycle> &AHCALData);
+         void readLDATimestamp(LdaStream &buf, std::map<int, LDATimeData> &LDATimestamps);
 
          UnfinishedPacketStates _unfinishedPacketState;
 
@@ -124,7 +142,7 @@ namespace eudaq {
 
          std::map<int, LDATimeData> _LDATimestampData;          //maps READOUTCYCLE to LDA timestamps for that cycle (comes asynchronously with the data and tends to arrive before the ASIC packets)
 
-         std::map<int, std::vector<std::vector<int> > > _LDAAsicData;              //maps readoutcycle to vector of "infodata"
+         std::map<int, AsicCycle> _LDAAsicData;              //maps readoutcycle to its "infodata" minipackets
 
          RunTimeStatistics _RunTimesStatistics;
    }
@@ -44,17 +44,6 @@ namespace eudaq {
                _terminated(false),
                _BORE_sent(false),
                _reader(NULL),
-               _ColoredTerminalMessages(1),
-               _IgnoreLdaTimestamps(0),
-               _eventBuildingMode(EventBuildingMode::ROC),
-               _eventNumberingPreference(EventNumbering::TRIGGERID),
-               _AHCALBXID0Offset(0),
-               _AHCALBXIDWidth(0),
-               _DebugKeepBuffered(0),
-               _GenerateTriggerIDFrom(0),
-               _InsertDummyPackets(0),
-               _LdaTrigidOffset(0),
-               _LdaTrigidStartsFrom(0),
                _port(5622),
                _waitmsFile(0),
                _waitsecondsForQueuedEvents(2),
@@ -71,6 +60,24 @@ namespace eudaq {
    void AHCALProducer::DoConfigure() {
       const eudaq::Configuration &param = *GetConfiguration();
       std::cout << " START AHCAL CONFIGURATION " << std::endl;
+      ReadConfiguration(param);
+
+      string reader = param.Get("Reader", "");
+      if (!_reader) {
+         SetReader(new ScReader(this));
+      }
+      //      if (_reader != nullptr)
+      //         SetReader(std::unique_ptr<ScReader>(new ScReader(this))); // in sc dif ID is not specified
+
+      _reader->OnConfigLED(_fileLEDsettings); //newLED
+
+      //_configured = true;
+
+      std::cout << " END AHCAL congfiguration " << std::endl;
+
+   }
+
+   void AHCALProducer::ReadConfiguration(const eudaq::Configuration &param) {
       // run rype: LED run or normal run ""
       _fileLEDsettings = param.Get("FileLEDsettings", "");
 
@@ -88,44 +95,10 @@ namespace eudaq {
       _port = param.Get("Port", 9011);
       _ipAddress = param.Get("IPAddress", "127.0.0.1");
 
-      string reader = param.Get("Reader", "");
-      if (!_reader) {
-         SetReader(new ScReader(this));
-      }
-      //      if (_reader != nullptr)
-      //         SetReader(std::unique_ptr<ScReader>(new ScReader(this))); // in sc dif ID is not specified
-
-      _reader->OnConfigLED(_fileLEDsettings); //newLED
-
       _redirectedInputFileName = param.Get("RedirectInputFromFile", "");
-      _ColoredTerminalMessages = param.Get("ColoredTerminalMessages", 1);
-      _LdaTrigidOffset = param.Get("LdaTrigidOffset", 0);
-      _LdaTrigidStartsFrom = param.Get("LdaTrigidStartsFrom", 0);
-      _AHCALBXID0Offset = param.Get("AHCALBXID0Offset", 2123); //default for mini-LDA, new DIF and no powerpulsing
-      _AHCALBXIDWidth = param.Get("AHCALBXIDWidth", 160); //4us Testbeam mode is default
-      _GenerateTriggerIDFrom = param.Get("GenerateTriggerIDFrom", 0);
-      _IgnoreLdaTimestamps = param.Get("IgnoreLdaTimestamps", 0);
       _StartWaitSeconds = param.Get("StartWaitSeconds", 0);
 
-      _InsertDummyPackets = param.Get("InsertDummyPackets", 0);
-      _DebugKeepBuffered = param.Get("DebugKeepBuffered", 0);
-
-      string eventBuildingMode = param.Get("EventBuildingMode", "ROC");
-      if (!eventBuildingMode.compare("ROC")) _eventBuildingMode = AHCALProducer::EventBuildingMode::ROC;
-      if (!eventBuildingMode.compare("TRIGGERID")) _eventBuildingMode = AHCALProducer::EventBuildingMode::TRIGGERID;
-      if (!eventBuildingMode.compare("BUILD_BXID_ALL")) _eventBuildingMode = AHCALProducer::EventBuildingMode::BUILD_BXID_ALL;
-      if (!eventBuildingMode.compare("BUILD_BXID_VALIDATED")) _eventBuildingMode = AHCALProducer::EventBuildingMode::BUILD_BXID_VALIDATED;
-      std::cout << "Creating events in \"" << eventBuildingMode << "\" mode" << std::endl;
-
-      string eventNumberingMode = param.Get("EventNumberingPreference", "TRIGGERID");
-      if (!eventNumberingMode.compare("TRIGGERID")) _eventNumberingPreference = AHCALProducer::EventNumbering::TRIGGERID;
-      if (!eventNumberingMode.compare("TIMESTAMP")) _eventNumberingPreference = AHCALProducer::EventNumbering::TIMESTAMP;
-      std::cout << "Preferring event numbering type: \"" << eventNumberingMode << "\"" << std::endl;
-
-      //_configured = true;
-
-      std::cout << " END AHCAL congfiguration " << std::endl;
-
+      ReadReaderSettings(param);
    }
 
    void AHCALProducer::DoStartRun() {
@@ -335,14 +308,12 @@ namespace eudaq {
    void AHCALProducer::Exec() {
       std::cout << " Main loop " << std::endl;
       StartCommandReceiver();
-      deque<char> bufRead;
+      LdaStream bufRead;
       // deque for events: add one event when new acqId is arrived: to be determined in reader
 //      deque<eudaq::RawDataEvent *> deqEvent2;
       std::deque<eudaq::EventUP> deqEvent;
 
-      const int bufsize = 4 * 1024;
-      // copy to C array, then to vector
-      char buf[bufsize]; //buffer to read from TCP socket
+      const int bufsize = 64 * 1024; //read from the TCP socket directly into the stream buffer
 
       while (!_terminated) {
          // wait until configured and connected
@@ -355,15 +326,14 @@ namespace eudaq {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             continue;
          }
+         char *buf = bufRead.prepare(bufsize);
          size = ::read(_fd, buf, bufsize);
          //std::cout << "DEBUG: producer Exec(): read" << size << " bytes" << std::endl;
          if (size > 0) {
             //_last_readout_time = std::time(NULL);
             if (_writeRaw && _rawFile.is_open())
                _rawFile.write(buf, size);
-            // C array to vector
-            copy(buf, buf + size, back_inserter(bufRead));
-            //bufRead.insert(bufRead.end(), buf, buf + size);
+            bufRead.commit(size);
             if (_reader)
                _reader->Read(bufRead, deqEvent);
             // send events : remain the last event
@@ -394,54 +364,5 @@ namespace eudaq {
       }
    }
 
-   AHCALProducer::EventBuildingMode AHCALProducer::getEventMode() const {
-      return _eventBuildingMode;
-   }
-
-   int AHCALProducer::getLdaTrigidOffset() const {
-      return _LdaTrigidOffset;
-   }
-   int AHCALProducer::getLdaTrigidStartsFrom() const {
-      return _LdaTrigidStartsFrom;
-   }
-
-   int AHCALProducer::getAhcalbxid0Offset() const {
-      return _AHCALBXID0Offset;
-   }
-
-   int AHCALProducer::getAhcalbxidWidth() const {
-      return _AHCALBXIDWidth;
-   }
-
-   int AHCALProducer::getInsertDummyPackets() const
-   {
-      return _InsertDummyPackets;
-   }
-
-   int AHCALProducer::getDebugKeepBuffered() const
-   {
-      return _DebugKeepBuffered;
-   }
-
-   int AHCALProducer::getGenerateTriggerIDFrom() const
-   {
-      return _GenerateTriggerIDFrom;
-   }
-
-   AHCALProducer::EventNumbering AHCALProducer::getEventNumberingPreference() const
-   {
-      return _eventNumberingPreference;
-   }
-
-   int AHCALProducer::getColoredTerminalMessages() const
-   {
-      return _ColoredTerminalMessages;
-   }
-
-   int AHCALProducer::getIgnoreLdaTimestamps() const
-   {
-      return _IgnoreLdaTimestamps;
-   }
-
 }	//end namespace eudaq
 
@@ -0,0 +1,97 @@
+// AHCALReader.cc
+#include "AHCALReader.hh"
+
+#include <iostream>
+
+namespace eudaq {
+
+   AHCALReaderHost::AHCALReaderHost() :
+         _eventBuildingMode(EventBuildingMode::ROC),
+               _eventNumberingPreference(EventNumbering::TRIGGERID),
+               _LdaTrigidOffset(0),
+               _LdaTrigidStartsFrom(0),
+               _AHCALBXID0Offset(0),
+               _AHCALBXIDWidth(0),
+               _InsertDummyPackets(0),
+               _DebugKeepBuffered(0),
+               _GenerateTriggerIDFrom(0),
+               _ColoredTerminalMessages(1),
+               _IgnoreLdaTimestamps(0)
+   {
+   }
+
+   void AHCALReaderHost::ReadReaderSettings(const eudaq::Configuration &param) {
+      _ColoredTerminalMessages = param.Get("ColoredTerminalMessages", 1);
+      _LdaTrigidOffset = param.Get("LdaTrigidOffset", 0);
+      _LdaTrigidStartsFrom = param.Get("LdaTrigidStartsFrom", 0);
+      _AHCALBXID0Offset = param.Get("AHCALBXID0Offset", 2123); //default for mini-LDA, new DIF and no powerpulsing
+      _AHCALBXIDWidth = param.Get("AHCALBXIDWidth", 160); //4us Testbeam mode is default
+      _GenerateTriggerIDFrom = param.Get("GenerateTriggerIDFrom", 0);
+      _IgnoreLdaTimestamps = param.Get("IgnoreLdaTimestamps", 0);
+
+      _InsertDummyPackets = param.Get("InsertDummyPackets", 0);
+      _DebugKeepBuffered = param.Get("DebugKeepBuffered", 0);
+
+      std::string eventBuildingMode = param.Get("EventBuildingMode", "ROC");
+      if (!eventBuildingMode.compare("ROC")) _eventBuildingMode = EventBuildingMode::ROC;
+      if (!eventBuildingMode.compare("TRIGGERID")) _eventBuildingMode = EventBuildingMode::TRIGGERID;
+      if (!eventBuildingMode.compare("BUILD_BXID_ALL")) _eventBuildingMode = EventBuildingMode::BUILD_BXID_ALL;
+      if (!eventBuildingMode.compare("BUILD_BXID_VALIDATED")) _eventBuildingMode = EventBuildingMode::BUILD_BXID_VALIDATED;
+      std::cout << "Creating events in \"" << eventBuildingMode << "\" mode" << std::endl;
+
+      std::string eventNumberingMode = param.Get("EventNumberingPreference", "TRIGGERID");
+      if (!eventNumberingMode.compare("TRIGGERID")) _eventNumberingPreference = EventNumbering::TRIGGERID;
+      if (!eventNumberingMode.compare("TIMESTAMP")) _eventNumberingPreference = EventNumbering::TIMESTAMP;
+      std::cout << "Preferring event numbering type: \"" << eventNumberingMode << "\"" << std::endl;
+   }
+
+   AHCALReaderHost::EventBuildingMode AHCALReaderHost::getEventMode() const {
+      return _eventBuildingMode;
+   }
+
+   int AHCALReaderHost::getLdaTrigidOffset() const {
+      return _LdaTrigidOffset;
+   }
+   int AHCALReaderHost::getLdaTrigidStartsFrom() const {
+      return _LdaTrigidStartsFrom;
+   }
+
+   int AHCALReaderHost::getAhcalbxid0Offset() const {
+      return _AHCALBXID0Offset;
+   }
+
+   int AHCALReaderHost::getAhcalbxidWidth() const {
+      return _AHCALBXIDWidth;
+   }
+
+   int AHCALReaderHost::getInsertDummyPackets() const
+   {
+      return _InsertDummyPackets;
+   }
+
+   int AHCALReaderHost::getDebugKeepBuffered() const
+   {
+      return _DebugKeepBuffered;
+   }
+
+   int AHCALReaderHost::getGenerateTriggerIDFrom() const
+   {
+      return _GenerateTriggerIDFrom;
+   }
+
+   AHCALReaderHost::EventNumbering AHCALReaderHost::getEventNumberingPreference() const
+   {
+      return _eventNumberingPreference;
+   }
+
+   int AHCALReaderHost::getColoredTerminalMessages() const
+   {
+      return _ColoredTerminalMessages;
+   }
+
+   int AHCALReaderHost::getIgnoreLdaTimestamps() const
+   {
+      return _IgnoreLdaTimestamps;
+   }
+
+}	//end namespace eudaq
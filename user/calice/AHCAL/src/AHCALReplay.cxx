@@ -0,0 +1,141 @@
+// AHCALReplay.cxx
+//
+// Replays a raw LDA stream, as written by the AHCALProducer with
+// WriteRawOutput=1, through a local TCP socket into the ScReader and reports
+// the sustained parsing and event building rate. No LDA, RunControl or
+// DataCollector is needed; the built events are counted and dropped.
+
+#include "AHCALReader.hh"
+#include "ScReader.hh"
+
+#include "eudaq/Configuration.hh"
+#include "eudaq/Logger.hh"
+#include "eudaq/OptionParser.hh"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+
+   // the event building settings of the producer, without an LDA to talk to
+   class ReplayHost: public eudaq::AHCALReaderHost {
+      public:
+         bool OpenConnection() override {
+            return true;
+         }
+         void CloseConnection() override {
+         }
+         void SendCommand(const char * /*command*/, int /*size*/ = 0) override {
+         }
+   };
+
+   // plays the LDA: sends the whole stream once to each of the n connections
+   void ServeStream(int listenfd, const std::vector<char> &stream, int n) {
+      for (int i = 0; i < n; ++i) {
+         int fd = accept(listenfd, NULL, NULL);
+         if (fd < 0) return;
+         size_t pos = 0;
+         while (pos < stream.size()) {
+            ssize_t w = write(fd, stream.data() + pos, stream.size() - pos);
+            if (w <= 0) break;
+            pos += w;
+         }
+         close(fd);
+      }
+   }
+
+}
+
+int main(int /*argc*/, const char ** argv) {
+   eudaq::OptionParser op("AHCAL LDA stream replay", "1.0", "Replays a raw LDA stream through a local socket into the ScReader");
+   eudaq::Option<std::string> file(op, "f", "file", "", "path", "raw LDA stream written by the AHCALProducer");
+   eudaq::Option<std::string> conf(op, "c", "config", "", "path", "configuration file with the AHCALProducer settings");
+   eudaq::Option<std::string> section(op, "s", "section", "Producer.Calice1", "section", "section of the configuration file");
+   eudaq::Option<int> loops(op, "n", "loops", 10, "number", "how many times the stream is replayed");
+   eudaq::Option<int> port(op, "p", "port", 5623, "port", "local port of the replayed LDA");
+   eudaq::Option<int> readsize(op, "b", "read-size", 64 * 1024, "bytes", "bytes requested per read from the socket");
+   eudaq::Option<std::string> level(op, "l", "log-level", "NONE", "level", "The minimum level for displaying log messages locally");
+   try {
+      op.Parse(argv);
+      EUDAQ_LOG_LEVEL(level.Value());
+      std::ifstream in(file.Value(), std::ios::binary);
+      if (!in) {
+         std::cerr << "unable to open the raw stream: " << file.Value() << std::endl;
+         return 1;
+      }
+      std::vector<char> stream((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+      eudaq::Configuration param;
+      if (!conf.Value().empty()) {
+         std::ifstream cf(conf.Value());
+         param = eudaq::Configuration(cf, section.Value());
+      }
+      ReplayHost host;
+      host.ReadReaderSettings(param);
+      eudaq::ScReader reader(&host);
+
+      int listenfd = socket(AF_INET, SOCK_STREAM, 0);
+      int on = 1;
+      setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      struct sockaddr_in addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port.Value());
+      addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+      if (bind(listenfd, (struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(listenfd, 1) != 0) {
+         std::cerr << "unable to listen on port " << port.Value() << std::endl;
+         return 1;
+      }
+      std::thread lda(ServeStream, listenfd, std::cref(stream), loops.Value());
+
+      uint64_t bytes = 0, events = 0;
+      std::chrono::steady_clock::duration parsing(0);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < loops.Value(); ++i) {
+         int fd = socket(AF_INET, SOCK_STREAM, 0);
+         if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+            std::cerr << "unable to connect to the replayed LDA" << std::endl;
+            return 1;
+         }
+         reader.ResetRun(i);
+         eudaq::LdaStream buf;
+         std::deque<eudaq::EventUP> deqEvent;
+         for (;;) {
+            ssize_t size = ::read(fd, buf.prepare(readsize.Value()), readsize.Value());
+            if (size <= 0) break;
+            buf.commit(size);
+            bytes += size;
+            auto t0 = std::chrono::steady_clock::now();
+            reader.Read(buf, deqEvent);
+            parsing += std::chrono::steady_clock::now() - t0;
+            events += deqEvent.size();
+            deqEvent.clear();
+         }
+         close(fd);
+         auto t0 = std::chrono::steady_clock::now();
+         reader.buildEvents(deqEvent, true);
+         parsing += std::chrono::steady_clock::now() - t0;
+         events += deqEvent.size();
+      }
+      double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      double parse = std::chrono::duration<double>(parsing).count();
+      lda.join();
+      close(listenfd);
+
+      std::cout << "Replayed " << bytes << " bytes in " << loops.Value() << " runs, " << events << " events built" << std::endl;
+      std::cout << "Wall time:    " << wall << " s, " << bytes / wall / 1e6 << " MB/s, " << events / wall << " events/s" << std::endl;
+      std::cout << "Parsing time: " << parse << " s, " << bytes / parse / 1e6 << " MB/s, " << events / parse << " events/s" << std::endl;
+   } catch (...) {
+      return op.HandleMainException();
+   }
+   return 0;
+}
@@ -1,7 +1,6 @@
 // ScReader.cc
 #include "eudaq/Event.hh"
 #include "ScReader.hh"
-#include "AHCALProducer.hh"
 
 #include "eudaq/Logger.hh"
 
@@ -15,7 +14,7 @@ using namespace std;
 
 namespace eudaq {
 
-   ScReader::ScReader(AHCALProducer *r) :
+   ScReader::ScReader(AHCALReaderHost *r) :
          AHCALReader(r),
                _runNo(-1),
                _buffer_inside_acquisition(false),
@@ -31,6 +30,25 @@ namespace eudaq {
    }
 
    void ScReader::OnStart(int runNo) {
+      ResetRun(runNo);
+      // set the connection and send "start runNo"
+      std::cout << "opening connection" << std::endl;
+      _producer->OpenConnection();
+      std::cout << "connection opened" << std::endl;
+      // using characters to send the run number
+      ostringstream os;
+      os << "RUN_START"; //newLED
+      // os << "START"; //newLED
+      os.width(8);
+      os.fill('0');
+      os << runNo;
+      os << "\r\n";
+      std::cout << "Sending command" << std::endl;
+      _producer->SendCommand(os.str().c_str());
+      std::cout << "command sent" << std::endl;
+   }
+
+   void ScReader::ResetRun(int runNo) {
       _runNo = runNo;
       _cycleNo = -1;
       _trigID = _producer->getLdaTrigidStartsFrom() - 1;
@@ -41,29 +59,14 @@ namespace eudaq {
       _RunTimesStatistics.clear();
       _unfinishedPacketState = UnfinishedPacketStates::DONE;
       switch (_producer->getEventMode()) {
-         case AHCALProducer::EventBuildingMode::TRIGGERID:
+         case AHCALReaderHost::EventBuildingMode::TRIGGERID:
             _lastBuiltEventNr = _producer->getGenerateTriggerIDFrom() - 1;
             break;
-         case AHCALProducer::EventBuildingMode::ROC:
+         case AHCALReaderHost::EventBuildingMode::ROC:
             default:
             _lastBuiltEventNr = -1;
             break;
       }
-      // set the connection and send "start runNo"
-      std::cout << "opening connection" << std::endl;
-      _producer->OpenConnection();
-      std::cout << "connection opened" << std::endl;
-      // using characters to send the run number
-      ostringstream os;
-      os << "RUN_START"; //newLED
-      // os << "START"; //newLED
-      os.width(8);
-      os.fill('0');
-      os << runNo;
-      os << "\r\n";
-      std::cout << "Sending command" << std::endl;
-      _producer->SendCommand(os.str().c_str());
-      std::cout << "command sent" << std::endl;
       _buffer_inside_acquisition = false;
    }
 
@@ -126,7 +129,7 @@ namespace eudaq {
       //    usleep(000);
    }
 
-   void ScReader::Read(std::deque<char> & buf, std::deque<eudaq::EventUP> & deqEvent) {
+   void ScReader::Read(LdaStream & buf, std::deque<eudaq::EventUP> & deqEvent) {
       static const unsigned char magic_sc[2] = { 0xac, 0xdc };    // find slow control info
       static const unsigned char magic_led[2] = { 0xda, 0xc1 };    // find LED voltages info
       static const unsigned char magic_data[2] = { 0xcd, 0xcd };    // find data
@@ -166,7 +169,7 @@ namespace eudaq {
                         EUDAQ_EXTRA(" Layer=" + to_string(ledId) + " Voltage=" + to_string(ledV) + " on/off=" + to_string(ledOnOff));
                      }
                      // buf.pop_front();
-                     buf.erase(buf.begin(), buf.begin() + ibuf - 1);	//LED info from buffer already saved, therefore can be deleted from buffer.
+                     buf.consume(ibuf - 1);	//LED info from buffer already saved, therefore can be deleted from buffer.
                      continue;
                   } else {	//unknown data
                      std::cout << "ERROR: unknown data (LED)" << std::endl;
@@ -203,7 +206,7 @@ namespace eudaq {
                         ibuf++;
                      }
                      //buf.pop_front();
-                     buf.erase(buf.begin(), buf.begin() + ibuf - 1);            //Slowcontrol data saved, therefore can be deleted from buffer.
+                     if (ibuf) buf.consume(ibuf - 1);            //Slowcontrol data saved, therefore can be deleted from buffer.
                      continue;
                   } else {  //unknown data
                      std::cout << "ERROR: unknown data (Slowcontrol) " << to_hex(buf[0]) << " " << to_hex(buf[1])
@@ -218,7 +221,7 @@ namespace eudaq {
                   break;//data packet will be processed outside this while loop
                }
                std::cout << "!" << to_hex(buf[0], 2);
-               buf.pop_front();            //when nothing match, throw away
+               buf.consume(1);            //when nothing match, throw away
             }
 
             if (buf.size() <= e_sizeLdaHeader) throw BufferProcessigExceptions::OK_ALL_READ; // all data read
@@ -255,13 +258,15 @@ namespace eudaq {
             length = (((unsigned char) buf[3] << 8) + (unsigned char) buf[2]);      //*2;
             unsigned int LDA_Header_cycle = (unsigned char) buf[4];      //from LDA packet header - 8 bits only!
             unsigned char status = buf[9];
-            bool TempFlag = (status == 0xa0 && buf[10] == 0x41 && buf[11] == 0x43 && buf[12] == 0x7a && buf[13] == 0);
-            bool TimestampFlag = (status == 0x08 && buf[10] == 0x45 && buf[11] == 0x4D && buf[12] == 0x49 && buf[13] == 0x54);
 
             if (buf.size() <= e_sizeLdaHeader + length) {
 //               std::cout << "DEBUG: not enough space in the buffer: " << buf.size() << ", required" << to_string(e_sizeLdaHeader + length) << std::endl;
                throw BufferProcessigExceptions::OK_NEED_MORE_DATA;      //not enough data in the buffer
             }
+            //the whole packet is in the buffer from here on, the packet type is read in place
+            const char *pkt = buf.data();
+            bool TempFlag = (status == 0xa0 && length >= 4 && pkt[10] == 0x41 && pkt[11] == 0x43 && pkt[12] == 0x7a && pkt[13] == 0);
+            bool TimestampFlag = (status == 0x08 && length >= 4 && pkt[10] == 0x45 && pkt[11] == 0x4D && pkt[12] == 0x49 && pkt[13] == 0x54);
 
 //            uint16_t rawTrigID = 0;
 
@@ -359,20 +364,20 @@ namespace eudaq {
                }
                if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
                std::cout << std::endl;
-               buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+               buf.consume(length + e_sizeLdaHeader);
                continue;
             }
 
-            deque<char>::iterator it = buf.begin() + e_sizeLdaHeader;
+            const char *it = pkt + e_sizeLdaHeader;
 
             // ASIC DATA 0x4341 0x4148
-            if ((it[0] == C_PKTHDR_ASICDATA[0]) && (it[1] == C_PKTHDR_ASICDATA[1])
+            if ((length >= 4) && (it[0] == C_PKTHDR_ASICDATA[0]) && (it[1] == C_PKTHDR_ASICDATA[1])
                   && (it[2] == C_PKTHDR_ASICDATA[2]) && (it[3] == C_PKTHDR_ASICDATA[3])) {
                //std::cout << "DEBUG: Analyzing AHCAL data, ROC " << LDA_Header_cycle << std::endl;
                readAHCALData(buf, _LDAAsicData);
             } else {
                cout << "ScReader: header invalid. Received" << to_hex(it[0]) << " " << to_hex(it[1]) << " " << to_hex(it[2]) << " " << to_hex(it[3]) << " " << endl;
-               buf.pop_front();
+               buf.consume(1);
             }
 
 //            if (cycleData[0] != 0 && cycleData[2] != 0 && cycleData[4] != 0) {
@@ -444,16 +449,16 @@ namespace eudaq {
       if (_producer->getDebugKeepBuffered()) return;
       std::lock_guard<std::mutex> lock(_eventBuildingQueueMutex); //minimal lock for pushing new event
       switch (_producer->getEventMode()) {
-         case AHCALProducer::EventBuildingMode::ROC:
+         case AHCALReaderHost::EventBuildingMode::ROC:
             buildROCEvents(EventQueue, dumpAll);
             break;
-         case AHCALProducer::EventBuildingMode::TRIGGERID:
+         case AHCALReaderHost::EventBuildingMode::TRIGGERID:
             buildTRIGIDEvents(EventQueue, dumpAll);
             break;
-         case AHCALProducer::EventBuildingMode::BUILD_BXID_ALL:
+         case AHCALReaderHost::EventBuildingMode::BUILD_BXID_ALL:
             buildBXIDEvents(EventQueue, dumpAll);
             break;
-         case AHCALProducer::EventBuildingMode::BUILD_BXID_VALIDATED:
+         case AHCALReaderHost::EventBuildingMode::BUILD_BXID_VALIDATED:
             buildValidatedBXIDEvents(EventQueue, dumpAll);
             break;
          default:
@@ -508,28 +513,42 @@ namespace eudaq {
       appendOtherInfo(ev);
    }
 
+   void ScReader::addMinipacket(eudaq::RawEvent * ev, const AsicCycle &cycle, size_t i) {
+      ev->AddBlock(ev->NumBlocks(), cycle.packet(i), e_minipacketWords * sizeof(int));
+   }
+
+   namespace {
+      //minipacket indices of a readout cycle sorted by BXID, in the order of arrival within the same BXID
+      template<typename Cycle>
+      std::vector<std::pair<int, uint32_t> > sortByBxid(const Cycle &cycle) {
+         std::vector<std::pair<int, uint32_t> > order(cycle.size());
+         for (size_t i = 0; i < cycle.size(); ++i)
+            order[i] = std::make_pair(cycle.bxid(i), (uint32_t) i);
+         std::sort(order.begin(), order.end());
+         return order;
+      }
+
+      struct TriggerBxid {
+            int bxid; //calculated from the trigger timestamp
+            int triggerId;
+            uint64_t timestamp;
+      };
+   }
+
    void ScReader::buildValidatedBXIDEvents(std::deque<eudaq::EventUP> &EventQueue, bool dumpAll) {
       int keptEventCount = dumpAll ? 0 : 3; //how many ROCs to keep in the data maps
       //      keptEventCount = 100000;
       while (_LDAAsicData.size() > keptEventCount) { //at least 2 finished ROC
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
-         //create a table with BXIDs
-         std::map<int, std::vector<std::vector<int> > > bxids;
+         const AsicCycle &data = _LDAAsicData.begin()->second;
+         //data from the readoutcycle sorted by BXID.
+         std::vector<std::pair<int, uint32_t> > bxids = sortByBxid(data);
          //std::cout << "processing readout cycle " << roc << std::endl;
 
-         //data from the readoutcycle to be sorted by BXID.
-         for (std::vector<int> &dit : data) { // = data.begin(); dit != data.end(); ++dit
-            int bxid = (int) dit[1];
-            //std::cout << "bxid " << (int) dit[1] << "\t chipid: " << (int) dit[3] << std::endl;
-            std::vector<std::vector<int> >& sameBxidPackets = bxids.insert( { bxid, std::vector<std::vector<int> >() }).first->second;
-            sameBxidPackets.push_back(std::move(dit));
-         }
-
          uint64_t startTS = 0LLU;
          uint64_t stopTS = 0LLU;
-         //get the list of bxid for the triggerIDs timestamps
-         std::multimap<int, std::tuple<int, uint64_t> > triggerBxids; //calculated_bxid, triggerid, timestamp
+         //get the list of bxid for the triggerIDs timestamps, sorted by bxid below
+         std::vector<TriggerBxid> triggerBxids;
          if (_LDATimestampData.count(roc)) {
             //get the start of acquisition timestamp
             startTS = _LDATimestampData[roc].TS_Start;
@@ -551,7 +570,7 @@ namespace eudaq {
                int bxid = ((int64_t) trigTS - (int64_t) startTS - (int64_t) _producer->getAhcalbxid0Offset()) / _producer->getAhcalbxidWidth();
                //if ((bxid < 0) || (bxid > 4096)) std::cout << "\033[34mWARNING EB: calculated trigger bxid not in range: " << bxid << " in ROC " << roc << "\033[0m" << std::endl;
                int triggerId = _LDATimestampData[roc].TriggerIDs[i];
-               triggerBxids.insert( { bxid, std::tuple<int, uint64_t>(triggerId, trigTS) });
+               triggerBxids.push_back( { bxid, triggerId, trigTS });
                //std::pair std::pair<int, uint64_t>(triggerId, trigTS);
                //std::cout << "Trigger info BXID=" << bxid << "\tTrigID=" << triggerId << std::endl;
             }
@@ -563,17 +582,23 @@ namespace eudaq {
             if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
          }
 
+         std::stable_sort(triggerBxids.begin(), triggerBxids.end(), [](const TriggerBxid &a, const TriggerBxid &b) {return a.bxid < b.bxid;});
+
          //iterate over bxids from single ROC
-         for (std::pair<const int, std::vector<std::vector<int> > > & sameBxidPackets : bxids) {
-            //std::cout << "bxid: " << sameBxidPackets.first << "\tsize: " << sameBxidPackets.second.size() << std::endl;
-            int bxid = sameBxidPackets.first;
+         for (size_t first = 0, last = 0; first < bxids.size(); first = last) {
+            int bxid = bxids[first].first;
+            while (last < bxids.size() && bxids[last].first == bxid)
+               ++last;
+            //std::cout << "bxid: " << bxid << "\tsize: " << (last - first) << std::endl;
 
             //there might be more external triggerIDs within one BXID, therefore we iterate over everything within the bxid
-            for (std::multimap<int, std::tuple<int, uint64_t> >::iterator trigIt = triggerBxids.find(bxid); trigIt != triggerBxids.end(); trigIt = triggerBxids.find(bxid)) {
+            auto trigRange = std::equal_range(triggerBxids.begin(), triggerBxids.end(), TriggerBxid { bxid, 0, 0 },
+                  [](const TriggerBxid &a, const TriggerBxid &b) {return a.bxid < b.bxid;});
+            for (auto trigIt = trigRange.first; trigIt != trigRange.second; ++trigIt) {
                _RunTimesStatistics.builtBXIDs++;
 
                //trigger ID within the ROC is found at this place
-               int rawTrigId = std::get<0>(trigIt->second);
+               int rawTrigId = trigIt->triggerId;
                while ((++_lastBuiltEventNr < (rawTrigId - _producer->getLdaTrigidOffset()))
                      && (_producer->getInsertDummyPackets())) {
                   //std::cout << "WARNING EB: inserting a dummy trigger: " << _lastBuiltEventNr << ", because " << _LDATimestampData[roc].TriggerIDs[i] << " is next" << std::endl;
@@ -596,39 +621,25 @@ namespace eudaq {
                cycledata.push_back((uint32_t) (startTS >> 32));
                cycledata.push_back((uint32_t) (stopTS));
                cycledata.push_back((uint32_t) (stopTS >> 32));
-               cycledata.push_back((uint32_t) (std::get<1>(trigIt->second)));
-               cycledata.push_back((uint32_t) (std::get<1>(trigIt->second) >> 32));
+               cycledata.push_back((uint32_t) (trigIt->timestamp));
+               cycledata.push_back((uint32_t) (trigIt->timestamp >> 32));
                nev_raw->AppendBlock(6, cycledata);
 
 
                switch (_producer->getEventNumberingPreference()) {
-                  case AHCALProducer::EventNumbering::TRIGGERID:
+                  case AHCALReaderHost::EventNumbering::TRIGGERID:
                      nev->SetFlagBit(eudaq::Event::Flags::FLAG_TRIG);
                      nev->ClearFlagBit(eudaq::Event::Flags::FLAG_TIME);
                      break;
-                  case AHCALProducer::EventNumbering::TIMESTAMP:
+                  case AHCALReaderHost::EventNumbering::TIMESTAMP:
                      default:
                      nev->SetFlagBit(eudaq::Event::Flags::FLAG_TIME);
                      nev->ClearFlagBit(eudaq::Event::Flags::FLAG_TRIG);
                      break;
                }
-               for (auto & minipacket : sameBxidPackets.second) {
-                  if (minipacket.size()) {
-                     if (triggerBxids.count(bxid) > 1) {
-                        std::cout <<
-                              nev_raw->AddBlock(nev_raw->NumBlocks(), minipacket);
-                     } else {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(minipacket));
-                     }
-                  }
-               }
+               for (size_t i = first; i < last; ++i)
+                  addMinipacket(nev_raw, data, bxids[i].second);
                EventQueue.push_back(std::move(nev));
-               triggerBxids.erase(trigIt);
-            }
-
-            if (!triggerBxids.count(sameBxidPackets.first)) {
-               //no matching trigger validation information. Move on to another trigger
-               continue;
             }
          }
          _LDAAsicData.erase(_LDAAsicData.begin());
@@ -640,20 +651,12 @@ namespace eudaq {
 //      keptEventCount = 100000;
       while (_LDAAsicData.size() > keptEventCount) { //at least 2 finished ROC
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+         const AsicCycle &data = _LDAAsicData.begin()->second;
 
-         //create a table with BXIDs
-         std::map<int, std::vector<std::vector<int> > > bxids;
+         //data from the readoutcycle sorted by BXID.
+         std::vector<std::pair<int, uint32_t> > bxids = sortByBxid(data);
          //std::cout << "processing readout cycle " << roc << std::endl;
 
-         //data from the readoutcycle to be sorted by BXID.
-         for (std::vector<int> &dit : data) { // = data.begin(); dit != data.end(); ++dit
-            int bxid = (int) dit[1];
-            //std::cout << "bxid " << (int) dit[1] << "\t chipid: " << (int) dit[3] << std::endl;
-            std::vector<std::vector<int> >& sameBxidPackets = bxids.insert( { bxid, std::vector<std::vector<int> >() }).first->second;
-            sameBxidPackets.push_back(std::move(dit));
-         }
-
          //get the start of acquisition timestamp
          uint64_t startTS = 0LLU;
          uint64_t stopTS = 0LLU;
@@ -678,10 +681,12 @@ namespace eudaq {
          }
          //----------------------------------------------------------
 
-         for (std::pair<const int, std::vector<std::vector<int> > > & sameBxidPackets : bxids) {
-            int bxid = sameBxidPackets.first;
+         for (size_t first = 0, last = 0; first < bxids.size(); first = last) {
+            int bxid = bxids[first].first;
+            while (last < bxids.size() && bxids[last].first == bxid)
+               ++last;
             _RunTimesStatistics.builtBXIDs++;
-            //std::cout << "bxid: " << sameBxidPackets.first << "\tsize: " << sameBxidPackets.second.size() << std::endl;
+            //std::cout << "bxid: " << bxid << "\tsize: " << (last - first) << std::endl;
             ++_lastBuiltEventNr;
             eudaq::EventUP nev = eudaq::Event::MakeUnique("CaliceObject");
             eudaq::RawEvent *nev_raw = dynamic_cast<RawEvent*>(nev.get());
@@ -711,11 +716,8 @@ namespace eudaq {
                uint64_t ts_end = startTS + _producer->getAhcalbxid0Offset() + (bxid + 1) * _producer->getAhcalbxidWidth() + 1;
 	       nev->SetTimestamp(ts_beg, ts_end, false);
             }
-            for (auto & minipacket : sameBxidPackets.second) {
-               if (minipacket.size()) {
-                  nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(minipacket));
-               }
-            }
+            for (size_t i = first; i < last; ++i)
+               addMinipacket(nev_raw, data, bxids[i].second);
             EventQueue.push_back(std::move(nev));
          }
          _LDAAsicData.erase(_LDAAsicData.begin());
@@ -733,18 +735,15 @@ namespace eudaq {
          while ((++_lastBuiltEventNr < _LDAAsicData.begin()->first) && _producer->getInsertDummyPackets())
             insertDummyEvent(EventQueue, _lastBuiltEventNr, -1, false);
          int roc = _LDAAsicData.begin()->first; //_LDAAsicData.begin()->first;
-         std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+         const AsicCycle &data = _LDAAsicData.begin()->second;
          eudaq::EventUP nev = eudaq::Event::MakeUnique("CaliceObject");
          eudaq::RawEvent *nev_raw = dynamic_cast<RawEvent*>(nev.get());
          prepareEudaqRawPacket(nev_raw);
          nev->SetTag("ROC", roc);
 
 //         nev->SetEventN(roc);
-         for (std::vector<std::vector<int> >::iterator idata = data.begin(); idata != data.end(); ++idata) {
-            if (idata->size()) {
-               nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(*idata));
-            }
-         }
+         for (size_t i = 0; i < data.size(); ++i)
+            addMinipacket(nev_raw, data, i);
          //nev->Print(std::cout, 0);
          if (_LDATimestampData.count(roc) && (!_producer->getIgnoreLdaTimestamps())) {
             nev->SetTag("ROCStartTS", _LDATimestampData[roc].TS_Start);
@@ -820,19 +819,19 @@ namespace eudaq {
                }
                int trigid = _LDATimestampData[roc].TriggerIDs[i];
 
-               std::vector<std::vector<int> > &data = _LDAAsicData.begin()->second;
+               const AsicCycle &data = _LDAAsicData.begin()->second;
                eudaq::EventUP nev = eudaq::Event::MakeUnique("CaliceObject");
                eudaq::RawEvent *nev_raw = dynamic_cast<RawEvent*>(nev.get());
                prepareEudaqRawPacket(nev_raw);
                switch (_producer->getEventNumberingPreference()) {
-	       case AHCALProducer::EventNumbering::TIMESTAMP:{
+	       case AHCALReaderHost::EventNumbering::TIMESTAMP:{
 		 nev->SetTriggerN(trigid - _producer->getLdaTrigidOffset(), false);
 		 uint64_t ts_beg = _LDATimestampData[roc].TS_Triggers[i] - _producer->getAhcalbxidWidth();
 		 uint64_t ts_end =_LDATimestampData[roc].TS_Triggers[i] + _producer->getAhcalbxidWidth();
 		 nev->SetTimestamp(ts_beg, ts_end, true);//false?
 		 break;
 	       }
-	       case AHCALProducer::EventNumbering::TRIGGERID:
+	       case AHCALReaderHost::EventNumbering::TRIGGERID:
 	       default:
 		 nev->SetTriggerN(trigid - _producer->getLdaTrigidOffset(), true);
 		 if (!_producer->getIgnoreLdaTimestamps()) {
@@ -844,24 +843,9 @@ namespace eudaq {
                }
                nev->SetTag("ROC", roc);
                nev->SetTag("ROCStartTS", _LDATimestampData[roc].TS_Start);
-               //copy the ahcal data
-               if (i == (_LDATimestampData[roc].TS_Triggers.size() - 1)) {
-                  //the last triggerID in the vector
-                  //std::cout << "DEBUG EB: ScReader::buildTRIGIDEvents: moving data for trigger " << trigid << std::endl;
-                  for (std::vector<std::vector<int> >::iterator idata = data.begin(); idata != data.end(); ++idata) {
-                     if (idata->size()) {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), std::move(*idata));
-                     }
-                  }
-               } else {
-                  //only copy the last vector, because it might be copied again
-                  //std::cout << "DEBUG EB: ScReader::buildTRIGIDEvents: copying data for trigger " << trigid << std::endl;
-                  for (std::vector<std::vector<int> >::const_iterator idata = data.begin(); idata != data.end(); ++idata) {
-                     if (idata->size()) {
-                        nev_raw->AddBlock(nev_raw->NumBlocks(), *idata);
-                     }
-                  }
-               }
+               //copy the ahcal data, all triggers of the ROC get the same data
+               for (size_t ip = 0; ip < data.size(); ++ip)
+                  addMinipacket(nev_raw, data, ip);
 
                //copy the cycledata
                std::vector<uint32_t> cycledata;
@@ -902,17 +886,17 @@ namespace eudaq {
       EventQueue.push_back(std::move(nev));
    }
 
-   void ScReader::readTemperature(std::deque<char> &buf) {
+   void ScReader::readTemperature(LdaStream &buf) {
       int lda = buf[6];
       int port = buf[7];
       short data = ((unsigned char) buf[23] << 8) + (unsigned char) buf[22];
       //std::cout << "DEBUG reading Temperature, length=" << length << " lda=" << lda << " port=" << port << std::endl;
       //std::cout << "DEBUG: temp LDA:" << lda << " PORT:" << port << " Temp" << data << std::endl;
       _vecTemp.push_back(make_pair(make_pair(lda, port), data));
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
-   void ScReader::readAHCALData(std::deque<char> &buf, std::map<int, std::vector<std::vector<int> > >& AHCALData) {
+   void ScReader::readAHCALData(LdaStream &buf, std::map<int, AsicCycle>& AHCALData) {
 //AHCALData[_cycleNo];
       unsigned int LDA_Header_cycle = (unsigned char) buf[4]; //from LDA packet header - 8 bits only!
       int8_t cycle_difference = LDA_Header_cycle - (_cycleNo & 0xFF);
@@ -938,15 +922,16 @@ namespace eudaq {
       }
 
 //data from the readoutcycle.
-      std::vector<std::vector<int> >& readoutCycle = AHCALData.insert( { _cycleNo, std::vector<std::vector<int> >() }).first->second;
+      std::vector<int>& readoutCycle = AHCALData[_cycleNo].words;
 
-      deque<char>::iterator it = buf.begin() + e_sizeLdaHeader;
+      const unsigned char *pkt = reinterpret_cast<const unsigned char *>(buf.data());
+      const unsigned char *it = pkt + e_sizeLdaHeader;
 
 // footer check: ABAB
-      if ((unsigned char) it[length - 2] != 0xab || (unsigned char) it[length - 1] != 0xab) {
-         cout << "Footer abab invalid:" << (unsigned int) (unsigned char) it[length - 2] << " " << (unsigned int) (unsigned char) it[length - 1] << endl;
-         EUDAQ_WARN("Footer abab invalid:" + to_string((unsigned int )(unsigned char )it[length - 2]) + " " +
-               to_string((unsigned int )(unsigned char )it[length - 1]));
+      if (it[length - 2] != 0xab || it[length - 1] != 0xab) {
+         cout << "Footer abab invalid:" << (unsigned int) it[length - 2] << " " << (unsigned int) it[length - 1] << endl;
+         EUDAQ_WARN("Footer abab invalid:" + to_string((unsigned int )it[length - 2]) + " " +
+               to_string((unsigned int )it[length - 1]));
       }
       if ((length - 12) % 146) {
 //we check, that the data packets from DIF have proper sizes. The RAW packet size can be checked
@@ -954,60 +939,49 @@ namespace eudaq {
          EUDAQ_ERROR("Wrong LDA packet length = " + to_string(length) + "in Run=" + to_string(_runNo) + " ,cycle= " + to_string(_cycleNo));
          std::cout << "Wrong LDA packet length = " << length << "in Run=" << _runNo << " ,cycle= " << _cycleNo << std::endl;
 //         ev->SetTag("DAQquality", 0);
-         buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+         buf.consume(length + e_sizeLdaHeader);
          return;
       }
 
-      int chipId = (unsigned char) it[length - 3] * 256 + (unsigned char) it[length - 4];
+      int chipId = it[length - 3] * 256 + it[length - 4];
 
-      const int NChannel = 36;
+      const int NChannel = e_nChannels;
       int nscai = (length - 8) / (NChannel * 4 + 2);
 
       it += 8;
 
+      //the minipackets are decoded in place into the flat array of the readout cycle
+      readoutCycle.reserve(readoutCycle.size() + nscai * e_minipacketWords);
       for (short tr = 0; tr < nscai; tr++) {
 // binary data: 128 words
-         vector<unsigned short> adc, tdc;
-
-         for (int np = 0; np < NChannel; np++) {
-            unsigned short tdc_value = (unsigned char) it[np * 2] + ((unsigned char) it[np * 2 + 1] << 8);
-            unsigned short adc_value =
-                  (unsigned char) it[np * 2 + NChannel * 2] + ((unsigned char) it[np * 2 + 1 + NChannel * 2] << 8);
-            tdc.push_back(tdc_value);
-            adc.push_back(adc_value);
-         }
-
-         it += NChannel * 4;
-
          int bxididx = e_sizeLdaHeader + length - 4 - (nscai - tr) * 2;
-         int bxid = (unsigned char) buf[bxididx + 1] * 256 + (unsigned char) buf[bxididx];
+         int bxid = pkt[bxididx + 1] * 256 + pkt[bxididx];
          if (bxid > 4096) {
             std::cout << "ERROR: processing too high BXID: " << bxid << std::endl;
             EUDAQ_WARN(" bxid = " + to_string(bxid));
          }
-         vector<int> infodata;
-         infodata.push_back((int) _cycleNo);
-         infodata.push_back(bxid);
-         infodata.push_back(nscai - tr - 1); // memory cell is inverted
-         infodata.push_back(chipId); //TODO add LDA number and port number in the higher bytes of the int
-         infodata.push_back(NChannel);
-
-         for (int n = 0; n < NChannel; n++)
-            infodata.push_back(tdc[NChannel - n - 1]); //channel ordering was inverted, now is correct
-
-         for (int n = 0; n < NChannel; n++)
-            infodata.push_back(adc[NChannel - n - 1]);
-
-//if (infodata.size() > 0) ev->AddBlock(ev->NumBlocks(), infodata); //add event (consisting from all information from single BXID (= 1 memory cell) from 1 ASIC)
-         if (infodata.size() > 0) {
-            readoutCycle.push_back(std::move(infodata));
-//            std::cout << ".";
+         size_t base = readoutCycle.size();
+         readoutCycle.resize(base + e_minipacketWords);
+         int *infodata = readoutCycle.data() + base;
+         infodata[0] = (int) _cycleNo;
+         infodata[1] = bxid;
+         infodata[2] = nscai - tr - 1; // memory cell is inverted
+         infodata[3] = chipId; //TODO add LDA number and port number in the higher bytes of the int
+         infodata[4] = NChannel;
+
+         //channel ordering was inverted, now is correct
+         for (int n = 0; n < NChannel; n++) {
+            int np = NChannel - n - 1;
+            infodata[5 + n] = (unsigned short) (it[np * 2] + (it[np * 2 + 1] << 8)); //TDC
+            infodata[5 + NChannel + n] = (unsigned short) (it[np * 2 + NChannel * 2] + (it[np * 2 + 1 + NChannel * 2] << 8)); //ADC
          }
+
+         it += NChannel * 4;
       }
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
-   void ScReader::readLDATimestamp(std::deque<char> &buf, std::map<int, LDATimeData>& LDATimestamps) {
+   void ScReader::readLDATimestamp(LdaStream &buf, std::map<int, LDATimeData>& LDATimestamps) {
       unsigned char TStype = buf[14]; //type of timestamp (only for Timestamp packets)
       unsigned int LDA_Header_cycle = (unsigned char) buf[4]; //from LDA packet header - 8 bits only!
       unsigned int LDA_cycle = _cycleNo; //copy from the global readout cycle.
@@ -1020,7 +994,7 @@ namespace eudaq {
          LDA_Header_cycle--;
          _RunTimesStatistics.triggers_outside_roc++;
          //uncomment if want to ignore trigger information from outside of ROC
-         //buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+         //buf.consume(length + e_sizeLdaHeader);
          //return;
       }
 
@@ -1088,7 +1062,7 @@ namespace eudaq {
             }
             _buffer_inside_acquisition = true;
             currentROCData.TS_Start = timestamp;
-            buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+            buf.consume(length + e_sizeLdaHeader);
             return;
          }
 
@@ -1112,7 +1086,7 @@ namespace eudaq {
             }
             _buffer_inside_acquisition = false;
             currentROCData.TS_Stop = timestamp;
-            buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+            buf.consume(length + e_sizeLdaHeader);
             return;
          }
 
@@ -1143,7 +1117,7 @@ namespace eudaq {
                   if (_producer->getColoredTerminalMessages()) std::cout << "\033[0m";
                   EUDAQ_ERROR("Unexpected TriggerID in run " + to_string(_runNo) + ". ROC=" + to_string(_cycleNo) + ", Expected TrigID=" +
                         to_string(_trigID + 1) + ", received:" + to_string(rawTrigID) + ". SKipping");
-                  buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+                  buf.consume(length + e_sizeLdaHeader);
                   return;
                }
             } else { //the difference is 1
@@ -1157,7 +1131,7 @@ namespace eudaq {
             currentROCData.TS_Triggers.push_back(timestamp);
          }
       }
-      buf.erase(buf.begin(), buf.begin() + length + e_sizeLdaHeader);
+      buf.consume(length + e_sizeLdaHeader);
    }
 
    void ScReader::printLDAROCInfo(std::ostream &out) {
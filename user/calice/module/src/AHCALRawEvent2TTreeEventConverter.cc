@@ -5,6 +5,15 @@ class AHCALRawEvent2TTreeEventConverter: public eudaq::TTreeEventConverter{
 public:
   bool Converting(eudaq::EventSPC d1, eudaq::TTreeEventSP d2, eudaq::ConfigSPC conf) const override;
   static const uint32_t m_id_factory = eudaq::cstr2hash("CaliceObject");
+private:
+  // two leaves per branch, read in this order
+  struct Pair {
+    uint8_t first = 0;
+    uint8_t second = 0;
+  };
+  mutable Pair m_xy;
+  mutable Pair m_za;
+  mutable Pair m_bc;
  };
 
 namespace{
@@ -22,24 +31,15 @@ bool AHCALRawEvent2TTreeEventConverter::Converting(eudaq::EventSPC d1, eudaq::TT
     std::vector<uint8_t> block = ev->GetBlock(block_n);
     //    if(block.size() < 2)      EUDAQ_THROW("Unknown data");
     if(block.size() > 2)  {  
-      uint8_t x_pixel = block[0];
-      uint8_t y_pixel = block[1];
-      uint8_t z_pixel = block[2];
-      uint8_t a_pixel = block[3];
-      uint8_t b_pixel = block[4];
-      uint8_t c_pixel = block[5];
-      TString temp = "block";
-      TString tempz = "blockz";
-      TString tempb = "blockb"; 
-      if (d2->GetListOfBranches()->FindObject(temp))  d2->SetBranchAddress(temp,&x_pixel);
-      else
-      d2->Branch(temp,&x_pixel,"x_pixel/b:y_pixel/b");
-      if (d2->GetListOfBranches()->FindObject(tempz))  d2->SetBranchAddress(tempz,&z_pixel);
-    else
-      d2->Branch(tempz,&z_pixel,"z_pixel/b:a_pixel/b");
-    if (d2->GetListOfBranches()->FindObject(tempb))  d2->SetBranchAddress(tempb,&b_pixel);
-    else
-      d2->Branch(tempb,&b_pixel,"b_pixel/b:c_pixel/b");
+      BindBranch(d2.get(), "block", &m_xy, "x_pixel/b:y_pixel/b");
+      BindBranch(d2.get(), "blockz", &m_za, "z_pixel/b:a_pixel/b");
+      BindBranch(d2.get(), "blockb", &m_bc, "b_pixel/b:c_pixel/b");
+      m_xy.first = block[0];
+      m_xy.second = block[1];
+      m_za.first = block[2];
+      m_za.second = block[3];
+      m_bc.first = block[4];
+      m_bc.second = block[5];
     }  else { 
       //      std::cout << " Can't convert a block of Size " << block.size() << std::endl;
     }
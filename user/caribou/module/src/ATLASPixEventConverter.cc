@@ -98,7 +98,7 @@ bool ATLASPixEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Stan
     plane.SetPixel(0, col, row, tot, timestamp * 1000);
 
     // Add the plane to the StandardEvent
-    d2->AddPlane(plane);
+    d2->AddPlane(std::move(plane));
 
     // Store time in picoseconds
     d2->SetTimeBegin(timestamp * 1000);
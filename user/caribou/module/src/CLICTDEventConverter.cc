@@ -234,6 +234,8 @@ bool CLICTDEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standa
   eudaq::StandardPlane plane(0, "Caribou", "CLICTD");
 
   plane.SetSizeZS(128, 128, 0);
+  // up to eight sub-pixels per pixel readout
+  plane.Reserve(8 * data.size());
   for(const auto& px : data) {
     auto pixel = dynamic_cast<caribou::CLICTDPixelReadout*>(px.second.get());
 
@@ -293,7 +295,7 @@ bool CLICTDEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standa
   }
 
   // Add the plane to the StandardEvent
-  d2->AddPlane(plane);
+  d2->AddPlane(std::move(plane));
 
   // Store frame begin and end in picoseconds
   d2->SetTimeBegin(shutter_open * 1000);
@@ -190,6 +190,7 @@ void CMSPixelBaseConverter::GetSinglePlane(eudaq::StandardEventSP d2, unsigned p
   } else {
     plane.SetSizeZS(8 * ROC_NUMCOLS, 2 * ROC_NUMROWS, 0);
   }
+  plane.Reserve(evt->pixels.size());
 
   // Iterate over all pixels and place them in the module plane:
   for (std::vector<pxar::pixel>::iterator it = evt->pixels.begin();
@@ -205,7 +206,7 @@ void CMSPixelBaseConverter::GetSinglePlane(eudaq::StandardEventSP d2, unsigned p
   }
 
   // Add plane to the output event:
-  d2->AddPlane(plane);
+  d2->AddPlane(std::move(plane));
 }
 
 void CMSPixelBaseConverter::GetMultiPlanes(eudaq::StandardEventSP d2, unsigned plane_id, pxar::Event *evt) const {
@@ -237,6 +238,6 @@ void CMSPixelBaseConverter::GetMultiPlanes(eudaq::StandardEventSP d2, unsigned p
     }
 
     // Add plane to the output event:
-    d2->AddPlane(plane);
+    d2->AddPlane(std::move(plane));
   }
 }
@@ -255,6 +255,7 @@ bool ETROCRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StdE
             //plane.SetSizeZS(16, 16, 0, 3, --< Not needed, probably with 3 is enough 
             //        StandardPlane::FLAG_DIFFCOORDS | StandardPlane::FLAG_ACCUMULATE );
             if( eas.find(etroc_id) != eas.end() ) {
+                plane.Reserve(eas[etroc_id].size());
                 for(size_t i = 0; i < eas[etroc_id].size(); ++i) {
                     // XXX --- IT doens't work using the frame... why??
                     // l1counter should be there because data is therea
@@ -264,7 +265,7 @@ bool ETROCRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StdE
                     plane.SetPixelAuxInfo(i, std::to_string(toas[etroc_id][i])+":"+std::to_string(cals[etroc_id][i]));
                 }
             }
-            d2->AddPlane(plane);
+            d2->AddPlane(std::move(plane));
 	}
         // --- XXX DEBUG --- REMOVE 
 	/* 
@@ -0,0 +1,282 @@
+#include "eudaq/OptionParser.hh"
+#include "eudaq/FileReader.hh"
+#include "eudaq/Event.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+// Plays the NI crate of an EUDET-type telescope on localhost, so that the
+// NiProducer can be run and benchmarked without the hardware. It answers
+// the configuration protocol ("conf", "star", "stop") on the config port and,
+// while a run is active, sends the two Mimosa26 frames of each trigger on the
+// data port, either replayed from a raw file of the NiProducer or generated.
+
+namespace{
+  struct NiFrames {
+    std::vector<uint8_t> data0;
+    std::vector<uint8_t> data1;
+  };
+
+  void PutLittle16(std::vector<uint8_t> &v, uint16_t x){
+    v.push_back(x & 0xff);
+    v.push_back(x >> 8);
+  }
+
+  void PutLittle32(std::vector<uint8_t> &v, uint32_t x){
+    PutLittle16(v, x & 0xffff);
+    PutLittle16(v, x >> 16);
+  }
+
+  // frame header, then per plane: frame counter, length twice, the hit words
+  // and the trailer, as decoded by the NiRawEvent2StdEventConverter
+  std::vector<uint8_t> MakeFrame(uint32_t planes, uint32_t hits, uint16_t pivot,
+				 uint32_t fcnt, std::mt19937 &rnd){
+    std::vector<uint8_t> v;
+    PutLittle32(v, 0x55555555);
+    PutLittle16(v, pivot);
+    PutLittle16(v, 0);
+    for(uint32_t p = 0; p < planes; p++){
+      PutLittle32(v, fcnt);
+      PutLittle16(v, hits);
+      PutLittle16(v, hits);
+      for(uint32_t h = 0; h < hits; h++){
+	PutLittle16(v, (rnd() % 576) << 4 | 1);
+	PutLittle16(v, (rnd() % 1152) << 2);
+      }
+      PutLittle32(v, 0xaaaaaaaa);
+      PutLittle32(v, 0x55555555);
+    }
+    return v;
+  }
+
+  void ReadRecorded(std::string path, std::vector<NiFrames> &pool){
+    std::string type = path.substr(path.find_last_of(".") + 1);
+    if(type == "raw")
+      type = "native";
+    auto reader = eudaq::Factory<eudaq::FileReader>::MakeUnique(eudaq::str2hash(type), path);
+    if(!reader)
+      EUDAQ_THROW("Unable to read " + path);
+    while(auto ev = reader->GetNextEvent()){
+      std::vector<eudaq::EventSPC> evs{ev};
+      for(uint32_t i = 0; i < ev->GetNumSubEvent(); i++)
+	evs.push_back(ev->GetSubEvent(i));
+      for(auto &e: evs){
+	if(e->GetDescription() != "NiRawDataEvent" || e->NumBlocks() < 2)
+	  continue;
+	pool.push_back(NiFrames{e->GetBlock(0), e->GetBlock(1)});
+      }
+    }
+  }
+
+  bool RecvAll(int fd, char *buf, size_t len){
+    while(len > 0){
+      ssize_t n = recv(fd, buf, len, MSG_WAITALL);
+      if(n <= 0)
+	return false;
+      buf += n;
+      len -= n;
+    }
+    return true;
+  }
+
+  bool WritevAll(int fd, iovec *iov, int n){
+    while(n > 0){
+      ssize_t w = writev(fd, iov, n);
+      if(w < 0)
+	return false;
+      while(n > 0 && size_t(w) >= iov->iov_len){
+	w -= iov->iov_len;
+	++iov;
+	--n;
+      }
+      if(n > 0){
+	iov->iov_base = (char *)iov->iov_base + w;
+	iov->iov_len -= w;
+      }
+    }
+    return true;
+  }
+
+  int Listen(uint16_t port){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0){
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+}
+
+int main(int /*argc*/, const char **argv) {
+  eudaq::OptionParser op("EUDAQ NI crate emulator", "2.1",
+			 "Serves recorded or generated Mimosa26 frames to the NiProducer on localhost");
+  eudaq::Option<std::string> file_input(op, "i", "input", "", "string",
+					"raw file of the NiProducer to replay, generated frames if empty");
+  eudaq::Option<uint32_t> nframes(op, "N", "frames", 1000, "uint32_t", "number of generated triggers");
+  eudaq::Option<uint32_t> nhits(op, "H", "hits", 20, "uint32_t", "hits per plane and frame of generated triggers");
+  eudaq::Option<uint32_t> nplanes(op, "P", "planes", 6, "uint32_t", "number of planes of generated triggers");
+  eudaq::Option<uint16_t> port_conf(op, "c", "config-port", 49248, "uint16_t", "port of the config socket");
+  eudaq::Option<uint16_t> port_data(op, "d", "data-port", 49250, "uint16_t", "port of the data transport socket");
+  eudaq::Option<double> rate(op, "r", "rate", 0, "Hz", "trigger rate, as fast as the producer reads if 0");
+  eudaq::Option<uint64_t> ntriggers(op, "n", "triggers", 0, "uint64_t", "stop sending after this number of triggers per run, 0 for no limit");
+  eudaq::OptionFlag keep_id(op, "k", "keep-trigger-id", "send the recorded trigger IDs instead of counting from 0 in each run");
+
+  try{
+    op.Parse(argv);
+  }
+  catch(...){
+    return op.HandleMainException();
+  }
+
+  std::vector<NiFrames> pool;
+  if(!file_input.Value().empty()){
+    try{
+      ReadRecorded(file_input.Value(), pool);
+    }
+    catch(...){
+      return op.HandleMainException();
+    }
+    std::cout << "Replaying " << pool.size() << " triggers from " << file_input.Value() << std::endl;
+  }
+  else{
+    std::mt19937 rnd(1);
+    for(uint32_t i = 0; i < nframes.Value(); i++){
+      uint16_t pivot = rnd() % 9216;
+      pool.push_back(NiFrames{MakeFrame(nplanes.Value(), nhits.Value(), pivot, 2 * i, rnd),
+			      MakeFrame(nplanes.Value(), nhits.Value(), pivot, 2 * i + 1, rnd)});
+    }
+    std::cout << "Generated " << pool.size() << " triggers with " << nhits.Value()
+	      << " hits per plane and frame" << std::endl;
+  }
+  for(auto &f: pool){
+    if(f.data0.size() < 8 || f.data0.size() > 0xffff || f.data1.size() > 0xffff){
+      std::cerr << "Triggers must have frames of 8 to 65535 bytes" << std::endl;
+      return 1;
+    }
+  }
+  if(pool.empty()){
+    std::cerr << "No triggers to send" << std::endl;
+    return 1;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+  int lfd_conf = Listen(port_conf.Value());
+  int lfd_data = Listen(port_data.Value());
+  if(lfd_conf < 0 || lfd_data < 0){
+    std::cerr << "Unable to listen on ports " << port_conf.Value() << " and "
+	      << port_data.Value() << std::endl;
+    return 1;
+  }
+
+  while(true){
+    std::cout << "Waiting for the NiProducer on ports " << port_conf.Value() << " and "
+	      << port_data.Value() << std::endl;
+    int fd_conf = accept(lfd_conf, nullptr, nullptr);
+    int fd_data = accept(lfd_data, nullptr, nullptr);
+    if(fd_conf < 0 || fd_data < 0)
+      break;
+    int on = 1;
+    setsockopt(fd_data, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    std::cout << "NiProducer connected" << std::endl;
+
+    std::atomic<bool> connected(true);
+    std::atomic<bool> running(false);
+    std::atomic<uint32_t> runs(0);
+    std::thread config([&](){
+	char cmd[5];
+	while(RecvAll(fd_conf, cmd, sizeof(cmd))){
+	  std::string c(cmd, 4);
+	  if(c == "conf"){
+	    char param[10];
+	    if(!RecvAll(fd_conf, param, sizeof(param)))
+	      break;
+	    // length and four bytes of error flags, all clear
+	    const char reply[6] = {0, 4, 0, 0, 0, 0};
+	    send(fd_conf, reply, sizeof(reply), 0);
+	    std::cout << "Configured" << std::endl;
+	  }
+	  else if(c == "star"){
+	    runs++;
+	    running = true;
+	  }
+	  else if(c == "stop")
+	    running = false;
+	  else
+	    std::cerr << "Unknown command " << c << std::endl;
+	}
+	running = false;
+	connected = false;
+      });
+
+    uint32_t run_seen = 0;
+    uint64_t sent = 0;
+    uint64_t bytes = 0;
+    bool reported = true;
+    auto tp_start = std::chrono::steady_clock::now();
+    while(connected){
+      if(run_seen != runs){
+	run_seen = runs;
+	sent = 0;
+	bytes = 0;
+	reported = false;
+	tp_start = std::chrono::steady_clock::now();
+      }
+      if(!running || (ntriggers.Value() && sent >= ntriggers.Value())){
+	if(!reported){
+	  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp_start).count();
+	  std::cout << "Run " << run_seen << ": " << sent << " triggers, " << bytes / 1e6 << " MB in "
+		    << s << " s, " << sent / s << " triggers/s, " << bytes / s / 1e6 << " MB/s" << std::endl;
+	  reported = true;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	continue;
+      }
+      if(rate.Value() > 0){
+	auto due = tp_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	  std::chrono::duration<double>(sent / rate.Value()));
+	std::this_thread::sleep_until(due);
+      }
+      NiFrames &f = pool[sent % pool.size()];
+      uint8_t head0[2] = {uint8_t(f.data0.size() >> 8), uint8_t(f.data0.size())};
+      uint8_t head1[2] = {uint8_t(f.data1.size() >> 8), uint8_t(f.data1.size())};
+      uint8_t trigger[2] = {f.data0[6], f.data0[7]};
+      if(!keep_id.IsSet()){
+	trigger[0] = sent & 0xff;
+	trigger[1] = (sent >> 8) & 0x7f;
+      }
+      iovec iov[6] = {{head0, 2}, {f.data0.data(), 6}, {trigger, 2},
+		      {f.data0.data() + 8, f.data0.size() - 8},
+		      {head1, 2}, {f.data1.data(), f.data1.size()}};
+      if(!WritevAll(fd_data, iov, 6))
+	break;
+      sent++;
+      bytes += f.data0.size() + f.data1.size() + 4;
+    }
+    close(fd_data);
+    shutdown(fd_conf, SHUT_RDWR);
+    config.join();
+    close(fd_conf);
+    std::cout << "NiProducer disconnected" << std::endl;
+  }
+  return 0;
+}
@@ -32,6 +32,10 @@ class NiController {
   bool DataTransportClientSocket_Select();
   unsigned int DataTransportClientSocket_ReadLength();
   std::vector<unsigned char> DataTransportClientSocket_ReadData(int datalength);
+  // Reads the two Mimosa26 frames of one trigger straight into the given
+  // vectors, which are resized and can be reused or moved into an event.
+  void DataTransportClientSocket_ReadFrames(std::vector<unsigned char> &frame0,
+                                            std::vector<unsigned char> &frame1);
   void ConfigClientSocket_Open(const std::string& addr, uint16_t port);
   void ConfigClientSocket_Close();
   bool ConfigClientSocket_Select();
@@ -41,12 +45,12 @@ class NiController {
   std::vector<unsigned char> ConfigClientSocket_ReadData(int datalength);
 
 private:
+  static void RecvAll(SOCKET sock, char *buf, size_t len, const char *what);
   sockaddr_in m_config;
   sockaddr_in m_datatransport;
   SOCKET m_sock_config;
   SOCKET m_sock_datatransport;
-  char m_buffer_data[7000];
-  char m_buffer_length[7000];
+  char m_buffer_length[2];
 };
 
 #endif
@@ -15,6 +15,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #define NI_CLOSE_SOCKET(x) close(x)
 #else
 
@@ -121,59 +122,15 @@ bool NiController::ConfigClientSocket_Select(){
 
 unsigned int
 NiController::ConfigClientSocket_ReadLength() {
-  unsigned int datalengthTmp;
-  unsigned int datalength;
-  int i;
-  bool dbg = false;
-  int numbytes;
-  if ((numbytes = recv(m_sock_config, m_buffer_length, 2, 0)) == -1) {
-    perror("recv()");
-    EUDAQ_THROW("DataTransportSocket: Read length error ");
-  } else {
-    datalengthTmp = 0;
-    datalengthTmp = 0xFF & m_buffer_length[0];
-    datalengthTmp <<= 8;
-    datalengthTmp += 0xFF & m_buffer_length[1];
-    datalength = datalengthTmp;
-  }
-  return datalength;
+  RecvAll(m_sock_config, m_buffer_length, 2, "ConfigSocket: Read length error ");
+  return (0xFF & m_buffer_length[0]) << 8 | (0xFF & m_buffer_length[1]);
 }
 
 std::vector<unsigned char>
 NiController::ConfigClientSocket_ReadData(int datalength) {
   std::vector<unsigned char> ConfigData(datalength);
-  unsigned int stored_bytes;
-  unsigned int read_bytes_left;
-  unsigned int i;
-  bool dbg = false;
-
-  stored_bytes = 0;
-  read_bytes_left = datalength;
-  int numbytes;
-  while (read_bytes_left > 0) {
-    if ((numbytes = recv(m_sock_config, m_buffer_data, read_bytes_left, 0)) == -1) {
-      perror("recv()");	    
-      EUDAQ_THROW("|==ConfigClientSocket_ReadLength==| Read data error ");
-    } else {
-      if (dbg)
-        printf("|==ConfigClientSocket_ReadLength==|    numbytes=%u \n",
-               static_cast<uint32_t>(numbytes));
-      read_bytes_left = read_bytes_left - numbytes;
-      for (int k = 0; k < numbytes; k++) {
-        ConfigData[stored_bytes] = m_buffer_data[k];
-        stored_bytes++;
-      }
-      i = 0;
-      if (dbg) {
-        while ((int)i < numbytes) {
-          printf(" 0x%x \n", 0xFF & m_buffer_data[i]);
-          i++;
-        }
-      }
-    }
-  }
-  if (dbg)
-    printf("\n");
+  RecvAll(m_sock_config, (char *)ConfigData.data(), datalength,
+          "|==ConfigClientSocket_ReadLength==| Read data error ");
   return ConfigData;
 }
 
@@ -214,59 +171,77 @@ void NiController::DatatransportClientSocket_Open(const std::string& addr, uint1
 
 unsigned int
 NiController::DataTransportClientSocket_ReadLength() {
-  unsigned int datalengthTmp;
-  unsigned int datalength;
-  int numbytes;
-  if ((numbytes = recv(m_sock_datatransport, m_buffer_length, 2, 0)) == -1) {
-    perror("recv()");
-    EUDAQ_THROW("DataTransportSocket: Read length error ");
-  } else {
-    datalengthTmp = 0;
-    datalengthTmp = 0xFF & m_buffer_length[0];
-    datalengthTmp <<= 8;
-    datalengthTmp += 0xFF & m_buffer_length[1];
-    datalength = datalengthTmp;
-
-  }
-  return datalength;
+  RecvAll(m_sock_datatransport, m_buffer_length, 2, "DataTransportSocket: Read length error ");
+  return (0xFF & m_buffer_length[0]) << 8 | (0xFF & m_buffer_length[1]);
 }
 
 std::vector<unsigned char>
 NiController::DataTransportClientSocket_ReadData(int datalength) {
   std::vector<unsigned char> mimosa_data(datalength);
-  unsigned int stored_bytes;
-  unsigned int read_bytes_left;
-  unsigned int i;
-  bool dbg = false;
+  RecvAll(m_sock_datatransport, (char *)mimosa_data.data(), datalength,
+          "DataTransportSocket: Read data error ");
+  return mimosa_data;
+}
 
-  stored_bytes = 0;
-  read_bytes_left = datalength;
-  int numbytes;
-  while (read_bytes_left > 0) {
-    if ((numbytes = recv(m_sock_datatransport, m_buffer_data, read_bytes_left, 0)) == -1) {
-      perror("recv()");
+void NiController::DataTransportClientSocket_ReadFrames(std::vector<unsigned char> &frame0,
+                                                        std::vector<unsigned char> &frame1) {
+  frame0.resize(DataTransportClientSocket_ReadLength());
+#ifndef WIN32
+  // the first frame and the length of the second one in a single call
+  iovec iov[2];
+  iov[0].iov_base = frame0.data();
+  iov[0].iov_len = frame0.size();
+  iov[1].iov_base = m_buffer_length;
+  iov[1].iov_len = 2;
+  size_t left = frame0.size() + 2;
+  iovec *cur = iov;
+  int ncur = 2;
+  while (left > 0) {
+    ssize_t numbytes = readv(m_sock_datatransport, cur, ncur);
+    if (numbytes == -1 && errno == EINTR)
+      continue;
+    if (numbytes <= 0) {
+      perror("readv()");
       EUDAQ_THROW("DataTransportSocket: Read data error ");
-    } else {
-      if (dbg)
-        printf("|==DataTransportClientSocket_ReadData==|    numbytes=%u \n",
-               static_cast<uint32_t>(numbytes));
-      read_bytes_left = read_bytes_left - numbytes;
-      for (int k = 0; k < numbytes; k++) {
-        mimosa_data[stored_bytes] = m_buffer_data[k];
-        stored_bytes++;
-      }
-      i = 0;
-      if (dbg) {
-        while ((int)i < numbytes) {
-          printf(" 0x%x%x", 0xFF & m_buffer_data[i], 0xFF & m_buffer_data[i + 1]);
-          i = i + 2;
-        }
-      }
+    }
+    left -= numbytes;
+    while (ncur > 0 && size_t(numbytes) >= cur->iov_len) {
+      numbytes -= cur->iov_len;
+      ++cur;
+      --ncur;
+    }
+    if (ncur > 0) {
+      cur->iov_base = (char *)cur->iov_base + numbytes;
+      cur->iov_len -= numbytes;
     }
   }
-  if (dbg)
-    printf("\n");
-  return mimosa_data;
+  frame1.resize((0xFF & m_buffer_length[0]) << 8 | (0xFF & m_buffer_length[1]));
+#else
+  RecvAll(m_sock_datatransport, (char *)frame0.data(), frame0.size(),
+          "DataTransportSocket: Read data error ");
+  frame1.resize(DataTransportClientSocket_ReadLength());
+#endif
+  RecvAll(m_sock_datatransport, (char *)frame1.data(), frame1.size(),
+          "DataTransportSocket: Read data error ");
+}
+
+void NiController::RecvAll(SOCKET sock, char *buf, size_t len, const char *what) {
+#ifndef WIN32
+  const int flags = MSG_WAITALL;
+#else
+  const int flags = 0;
+#endif
+  while (len > 0) {
+    int numbytes = recv(sock, buf, static_cast<int>(len), flags);
+    if (numbytes == -1 && errno == EINTR)
+      continue;
+    if (numbytes <= 0) {
+      perror("recv()");
+      EUDAQ_THROW(what);
+    }
+    buf += numbytes;
+    len -= numbytes;
+  }
 }
 
 void NiController::DatatransportClientSocket_Close() {
@@ -0,0 +1,160 @@
+#ifndef MIMOSA26DECODER_HH
+#define MIMOSA26DECODER_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Decoder of the two zero-suppressed Mimosa26 frames of a NiRawDataEvent:
+//   frame header (4) | pivot pixel (2, LE) | TLU trigger ID (2, LE)
+//   per board: frame counter (4) | length twice (2+2, in 32 bit words)
+//              data words | trailer (8)
+// Each data word holds two 16 bit words, a row word with the number of
+// states in its low nibble followed by the state words, each one a column
+// with up to three more hit pixels to its right. The pivot split is
+// resolved to a row once per event, and each state word is expanded by a
+// dispatch on its pixel count. Hits go to per-board, per-frame buffers
+// which keep their capacity from one event to the next.
+class Mimosa26Decoder{
+public:
+  static const uint32_t X_SIZE = 1152;
+  static const uint32_t Y_SIZE = 576;
+  static const uint32_t PIVOT_PIXEL_OFFSET = 64;
+
+  struct Frame{
+    size_t n = 0;
+    std::vector<uint16_t> x;
+    std::vector<uint16_t> y;
+    std::vector<uint8_t> pivot;
+  };
+
+  // Decode the two frames of one event. With use_all_hits the pixels are
+  // assigned to the frames instead of being split at the pivot row.
+  // Returns false if the event is too short to hold a board.
+  bool Decode(const uint8_t *d0, size_t n0, const uint8_t *d1, size_t n1,
+	      bool use_all_hits = false){
+    m_boards = 0;
+    m_max_hits = 0;
+    m_warnings.clear();
+    if(n0 < 20 || n1 < 20)
+      return false;
+    m_pivot = Little16(d0 + 4);
+    m_tluid = Little16(d0 + 6);
+    m_pivot_pixel = (9216 + m_pivot + PIVOT_PIXEL_OFFSET) % 9216;
+    const uint32_t pivot_row = m_pivot_pixel / 16;
+    size_t it0 = 8;
+    size_t it1 = 8;
+    while(it0 + 8 <= n0 && it1 + 8 <= n1){
+      size_t len0 = BoardLength(d0 + it0, "first");
+      size_t len1 = BoardLength(d1 + it1, "second");
+      if(len0 * 4 + 12 > n0 - it0){
+	m_warnings.push_back("Bad length in first frame, len0 * 4 + 12 > data0.end()-it0 ("+
+			     std::to_string(len0 * 4 + 12)+" > "+ std::to_string(n0 - it0)+")");
+	break;
+      }
+      if(len1 * 4 + 12 > n1 - it1){
+	m_warnings.push_back("Bad length in second frame,  len1 * 4 + 12 > data1.end()-it1 ("+
+			     std::to_string(len1 * 4 + 12)+" > "+ std::to_string(n1 - it1)+")");
+	break;
+      }
+      if(m_frames.size() < 2 * (m_boards + 1))
+	m_frames.resize(2 * (m_boards + 1));
+      DecodeFrame(m_frames[2 * m_boards], d0 + it0 + 8, len0 * 2,
+		  use_all_hits ? 1 : 2, pivot_row);
+      DecodeFrame(m_frames[2 * m_boards + 1], d1 + it1 + 8, len1 * 2,
+		  use_all_hits ? 0 : 2, pivot_row);
+      ++m_boards;
+      size_t next0 = it0 + (len0 + 4) * 4;
+      size_t next1 = it1 + (len1 + 4) * 4;
+      if(next0 >= n0 || next1 >= n1)
+	break;
+      it0 = next0;
+      it1 = next1;
+    }
+    if(m_ones.size() < m_max_hits)
+      m_ones.resize(m_max_hits, 1);
+    return true;
+  }
+
+  size_t NumBoards() const {return m_boards;}
+  // frame 0 or 1 of a board
+  const Frame &GetFrame(size_t board, uint32_t frame) const {return m_frames[2 * board + frame];}
+  // the pixel value of all hits, valid for the largest frame of the event
+  const uint8_t *Ones() const {return m_ones.data();}
+  uint16_t Pivot() const {return m_pivot;}
+  uint32_t PivotPixel() const {return m_pivot_pixel;}
+  uint16_t TluId() const {return m_tluid;}
+  const std::vector<std::string> &Warnings() const {return m_warnings;}
+
+private:
+  static uint16_t Little16(const uint8_t *p){
+    return uint16_t(p[0] | p[1] << 8);
+  }
+
+  // the two length fields of a board should agree, the larger one is used
+  size_t BoardLength(const uint8_t *p, const char *which){
+    uint16_t len = Little16(p + 4);
+    uint16_t len_h = Little16(p + 6);
+    if(len != len_h){
+      m_warnings.push_back(std::string("Mismatched lengths decoding ") + which + " frame (" +
+			   std::to_string(len) + ", " + std::to_string(len_h) + ")");
+      len = std::max(len, len_h);
+    }
+    return len;
+  }
+
+  // fixed_pivot is 0 or 1 for a constant pivot flag, 2 to split at pivot_row
+  void DecodeFrame(Frame &f, const uint8_t *d, size_t nwords, uint32_t fixed_pivot,
+		   uint32_t pivot_row){
+    // a state word gives at most four pixels
+    if(f.x.size() < nwords * 4){
+      f.x.resize(nwords * 4);
+      f.y.resize(nwords * 4);
+      f.pivot.resize(nwords * 4);
+    }
+    uint16_t *x = f.x.data();
+    uint16_t *y = f.y.data();
+    uint8_t *pv = f.pivot.data();
+    size_t n = 0;
+    for(size_t i = 0; i + 1 < nwords; ++i){
+      uint16_t w = Little16(d + 2 * i);
+      uint16_t numstates = w & 0x000f;
+      uint16_t row = w >> 4 & 0x7ff;
+      if(i + 1 + numstates > nwords)
+	break;
+      uint8_t pivot = fixed_pivot < 2 ? uint8_t(fixed_pivot) : uint8_t(row >= pivot_row);
+      for(uint16_t s = 0; s < numstates; ++s){
+	uint16_t v = Little16(d + 2 * ++i);
+	uint16_t column = v >> 2 & 0x7ff;
+	switch(v & 3){
+	case 3:
+	  x[n] = column; y[n] = row; pv[n++] = pivot; ++column;
+	  // fall through
+	case 2:
+	  x[n] = column; y[n] = row; pv[n++] = pivot; ++column;
+	  // fall through
+	case 1:
+	  x[n] = column; y[n] = row; pv[n++] = pivot; ++column;
+	  // fall through
+	default:
+	  x[n] = column; y[n] = row; pv[n++] = pivot;
+	}
+      }
+    }
+    f.n = n;
+    m_max_hits = std::max(m_max_hits, n);
+  }
+
+  std::vector<Frame> m_frames;
+  std::vector<uint8_t> m_ones;
+  std::vector<std::string> m_warnings;
+  size_t m_boards = 0;
+  size_t m_max_hits = 0;
+  uint16_t m_pivot = 0;
+  uint16_t m_tluid = 0;
+  uint32_t m_pivot_pixel = 0;
+};
+
+#endif // MIMOSA26DECODER_HH
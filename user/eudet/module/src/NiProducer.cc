@@ -1,9 +1,15 @@
 #include "NiController.hh"
 #include "eudaq/Producer.hh"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 class NiProducer : public eudaq::Producer {
 public:
@@ -19,9 +25,28 @@ class NiProducer : public eudaq::Producer {
 
   static const uint32_t m_id_factory = eudaq::cstr2hash("NiProducer");
 private:
-  bool m_running;
+  // the two Mimosa26 frames of one trigger
+  struct NiFrames {
+    std::vector<uint8_t> data0;
+    std::vector<uint8_t> data1;
+  };
+  void ReadLoop();
+  void SendFrames(NiFrames &frames);
+
+  std::atomic<bool> m_running;
   std::shared_ptr<NiController> ni_control;
   std::vector<uint8_t> m_conf_parameters;
+  uint32_t m_tg_h17;
+  uint16_t m_last_tg_l15;
+
+  // frames read ahead by the reader thread while the previous events are sent
+  size_t m_queue_size;
+  std::atomic<bool> m_reading;
+  std::exception_ptr m_read_error;
+  std::deque<NiFrames> m_queue;
+  std::mutex m_mx_queue;
+  std::condition_variable m_cv_not_empty;
+  std::condition_variable m_cv_not_full;
 };
 
 namespace{
@@ -30,58 +55,115 @@ namespace{
 }
 
 NiProducer::NiProducer(const std::string name, const std::string &runcontrol)
-  : eudaq::Producer(name, runcontrol), m_running(false){
-  m_running = false;
+  : eudaq::Producer(name, runcontrol), m_running(false), m_tg_h17(0), m_last_tg_l15(0),
+    m_queue_size(0), m_reading(false){
 }
 
 NiProducer::~NiProducer(){
   m_running = false;
 }
 
+void NiProducer::SendFrames(NiFrames &frames){
+  auto evup = eudaq::Event::MakeUnique("NiRawDataEvent");
+  if(frames.data0.size()>8){
+    uint16_t tg_l15 = 0x7fff & (frames.data0[6] + (frames.data0[7]<<8));
+    if(tg_l15 < m_last_tg_l15 && m_last_tg_l15>0x6000 && tg_l15<0x2000){
+      m_tg_h17++;
+      EUDAQ_INFO("increase high 17bits of trigger number, last_tg_l15("+ 
+		 std::to_string(m_last_tg_l15)+") tg_l15("+ 
+		 std::to_string(tg_l15)+")" );
+    }
+    uint32_t tg_n = (m_tg_h17<<15) + tg_l15;
+    evup->SetTriggerN(tg_n);
+    m_last_tg_l15 = tg_l15;
+  }
+  evup->AddBlock(0, std::move(frames.data0));
+  evup->AddBlock(1, std::move(frames.data1));
+  evup->AddBlock(2, m_conf_parameters);
+  SendEvent(std::move(evup));
+}
+
+void NiProducer::ReadLoop(){
+  try{
+    while(m_running){
+      if(!ni_control->DataTransportClientSocket_Select()){
+	continue;
+      }
+      NiFrames frames;
+      ni_control->DataTransportClientSocket_ReadFrames(frames.data0, frames.data1);
+      std::unique_lock<std::mutex> lk(m_mx_queue);
+      // a stopped consumer does not drain the queue any more
+      m_cv_not_full.wait(lk, [this]{return m_queue.size() < m_queue_size || !m_running;});
+      m_queue.push_back(std::move(frames));
+      m_cv_not_empty.notify_all();
+    }
+  }
+  catch(...){
+    m_read_error = std::current_exception();
+  }
+  std::unique_lock<std::mutex> lk(m_mx_queue);
+  m_reading = false;
+  m_cv_not_empty.notify_all();
+}
+
 void NiProducer::RunLoop(){
-  uint32_t tg_h17 = 0;
-  uint16_t last_tg_l15 = 0;
-  while(m_running){
-    if(!ni_control->DataTransportClientSocket_Select()){
-      continue;
+  m_tg_h17 = 0;
+  m_last_tg_l15 = 0;
+  if(m_queue_size){
+    m_reading = true;
+    std::thread reader(&NiProducer::ReadLoop, this);
+    std::unique_lock<std::mutex> lk(m_mx_queue);
+    try{
+      while(true){
+	m_cv_not_empty.wait(lk, [this]{return !m_queue.empty() || !m_reading;});
+	if(m_queue.empty())
+	  break;
+	NiFrames frames = std::move(m_queue.front());
+	m_queue.pop_front();
+	m_cv_not_full.notify_all();
+	lk.unlock();
+	SendFrames(frames);
+	lk.lock();
+      }
+    }
+    catch(...){
+      // stop the reader before the exception leaves with the thread joinable
+      m_running = false;
+      if(!lk.owns_lock())
+	lk.lock();
+      m_queue.clear();
+      m_cv_not_full.notify_all();
+      lk.unlock();
+      reader.join();
+      m_read_error = nullptr;
+      throw;
     }
-    auto evup = eudaq::Event::MakeUnique("NiRawDataEvent");
-    uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_0(datalength1);
-    mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-    uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-    std::vector<uint8_t> mimosa_data_1(datalength2);
-    mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
-    if(mimosa_data_0.size()>8){
-      uint16_t tg_l15 = 0x7fff & (mimosa_data_0[6] + (mimosa_data_0[7]<<8));
-      if(tg_l15 < last_tg_l15 && last_tg_l15>0x6000 && tg_l15<0x2000){
-	tg_h17++;
-	EUDAQ_INFO("increase high 17bits of trigger number, last_tg_l15("+ 
-		   std::to_string(last_tg_l15)+") tg_l15("+ 
-		   std::to_string(tg_l15)+")" );
+    lk.unlock();
+    reader.join();
+    if(m_read_error){
+      std::exception_ptr e = m_read_error;
+      m_read_error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+  else{
+    while(m_running){
+      if(!ni_control->DataTransportClientSocket_Select()){
+	continue;
       }
-      uint32_t tg_n = (tg_h17<<15) + tg_l15;
-      evup->SetTriggerN(tg_n);
-      last_tg_l15 = tg_l15;
+      NiFrames frames;
+      ni_control->DataTransportClientSocket_ReadFrames(frames.data0, frames.data1);
+      SendFrames(frames);
     }
-    
-    evup->AddBlock(0, mimosa_data_0);
-    evup->AddBlock(1, mimosa_data_1);
-    evup->AddBlock(2, m_conf_parameters);
-    SendEvent(std::move(evup));
   }
   
   std::chrono::milliseconds ms_dump(1000);
   auto tp_beg = std::chrono::steady_clock::now();
   auto tp_end = tp_beg + ms_dump;
+  NiFrames dump;
   while(1){
     if(ni_control->DataTransportClientSocket_Select()){
-      uint32_t datalength1 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_0(datalength1);
-      mimosa_data_0 = ni_control->DataTransportClientSocket_ReadData(datalength1);
-      uint32_t datalength2 = ni_control->DataTransportClientSocket_ReadLength();
-      std::vector<uint8_t> mimosa_data_1(datalength2);
-      mimosa_data_1 = ni_control->DataTransportClientSocket_ReadData(datalength2);
+      ni_control->DataTransportClientSocket_ReadFrames(dump.data0, dump.data1);
     }
     auto tp_now = std::chrono::steady_clock::now();
     if(tp_now>tp_end){
@@ -110,6 +192,7 @@ void NiProducer::DoConfigure(){
   uint32_t Det = conf->Get("Det", 255); //But it is a "MIMOSA26" string in conf file??"
   uint32_t NiVersion = conf->Get("NiVersion", 1);
   uint32_t FPGADownload = conf->Get("FPGADownload", 1);
+  m_queue_size = conf->Get("NiReadQueueSize", 0);
   uint32_t NumBoards = conf->Get("NumBoards", 6);
   std::vector<uint32_t> MimosaID(6);
   std::vector<uint32_t> MimosaEn(6,0);
@@ -3,14 +3,11 @@
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
 
-#define PIVOTPIXELOFFSET 64
+#include "Mimosa26Decoder.hh"
 
 class NiRawEvent2StdEventConverter: public eudaq::StdEventConverter{
-  typedef std::vector<uint8_t>::const_iterator datait;
 public:
   bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
-  void DecodeFrame(eudaq::StandardPlane& plane, const uint32_t fm_n,
-           const uint8_t *const d, const size_t l32, bool fix_pivot = false) const;
   static const uint32_t m_id_factory = eudaq::cstr2hash("NiRawDataEvent");
 };
 
@@ -21,7 +18,6 @@ namespace{
 
 bool NiRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const{
 
-  static const std::vector<uint32_t> m_ids = {0, 1, 2, 3, 4, 5};
   //TODO: number of telescope plane may be less than 6. Decode additional tags
   auto ev = std::dynamic_pointer_cast<const eudaq::RawEvent>(d1);
   if(!ev)
@@ -39,119 +35,33 @@ bool NiRawEvent2StdEventConverter::Converting(eudaq::EventSPC d1, eudaq::Standar
     d2->SetTimestamp(d1->GetTimestampBegin(), d1->GetTimestampEnd(), d1->IsFlagTimestamp());
   }
 
-  auto &rawev = *ev;
-  if (rawev.NumBlocks() < 2 || rawev.GetBlock(0).size() < 20 ||
-      rawev.GetBlock(1).size() < 20) {
-    EUDAQ_WARN("Ignoring bad event " + std::to_string(rawev.GetEventNumber()));
+  auto use_all_hits = (conf != nullptr ? bool(conf->Get("use_all_hits",0)) : false);
+  // the hit buffers of the decoder keep their capacity between events
+  thread_local Mimosa26Decoder decoder;
+  bool good = false;
+  if(ev->NumBlocks() >= 2){
+    const std::vector<uint8_t> &data0 = ev->GetBlock(0);
+    const std::vector<uint8_t> &data1 = ev->GetBlock(1);
+    good = decoder.Decode(data0.data(), data0.size(), data1.data(), data1.size(), use_all_hits);
+  }
+  if(!good){
+    EUDAQ_WARN("Ignoring bad event " + std::to_string(ev->GetEventNumber()));
     return false;
   }
-  auto use_all_hits = (conf != nullptr ? bool(conf->Get("use_all_hits",0)) : false);
-
-  const std::vector<uint8_t> &data0 = rawev.GetBlock(0);
-  const std::vector<uint8_t> &data1 = rawev.GetBlock(1);
-  uint32_t header0 = eudaq::getlittleendian<uint32_t>(&data0[0]);
-  uint32_t header1 = eudaq::getlittleendian<uint32_t>(&data1[0]);
-  uint16_t pivot = eudaq::getlittleendian<uint16_t>(&data0[4]);
-  uint16_t tluid = eudaq::getlittleendian<uint16_t>(&data0[6]);
-  datait it0 = data0.begin() + 8;
-  datait it1 = data1.begin() + 8;
-  uint32_t board = 0;
-  while (it0 < data0.end() && it1 < data1.end()) {
-    uint32_t id = m_ids[board];
-    uint32_t fcnt0 =  eudaq::getlittleendian<uint32_t>(&(*(it0)));
-    uint32_t fcnt1 =  eudaq::getlittleendian<uint32_t>(&(*(it1)));
-    uint16_t len0 = eudaq::getlittleendian<uint16_t>(&(*(it0+4)));
-    uint16_t len0_h = eudaq::getlittleendian<uint16_t>(&(*(it0+6)));
-    uint16_t len1 = eudaq::getlittleendian<uint16_t>(&(*(it1+4)));
-    uint16_t len1_h = eudaq::getlittleendian<uint16_t>(&(*(it1+6)));
-    if (len0!= len0_h) {
-      EUDAQ_WARN("Mismatched lengths decoding first frame (" +
-		 std::to_string(len0) + ", " + std::to_string(len0_h) +
-		 ")");
-      len0 = std::max(len0, len0_h);
-    }
-    if (len1 != len1_h) {
-      EUDAQ_WARN("Mismatched lengths decoding second frame (" +
-		 std::to_string(len1) + ", " + std::to_string(len1_h) +
-		 ")");
-      len1 = std::max(len1, len1_h);
-    }
+  for(auto &w: decoder.Warnings())
+    EUDAQ_WARN(w);
 
-    if (len0 * 4 + 12 > data0.end()-it0) {
-      EUDAQ_WARN("Bad length in first frame, len0 * 4 + 12 > data0.end()-it0 ("+
-		 std::to_string(len0 * 4 + 12)+" > "+ std::to_string(data0.end()-it0)+
-		 ")");
-      break;
-    }
-
-    if (len1 * 4 + 12 > data1.end() - it1) {
-      EUDAQ_WARN("Bad length in second frame,  len1 * 4 + 12 > data1.end()-it1 ("+
-		 std::to_string(len1 * 4 + 12)+" > "+ std::to_string(data1.end()-it1)+
-		 ")");
-      break;
-    }
-
-    eudaq::StandardPlane plane(id, "NI", "MIMOSA26");
-    plane.SetSizeZS(1152, 576, 0, 2, eudaq::StandardPlane::FLAG_WITHPIVOT |
+  for(size_t board = 0; board < decoder.NumBoards(); ++board){
+    eudaq::StandardPlane plane(board, "NI", "MIMOSA26");
+    plane.SetSizeZS(Mimosa26Decoder::X_SIZE, Mimosa26Decoder::Y_SIZE, 0, 2,
+		    eudaq::StandardPlane::FLAG_WITHPIVOT |
 		    eudaq::StandardPlane::FLAG_DIFFCOORDS);
-    plane.SetPivotPixel((9216 + pivot + PIVOTPIXELOFFSET) % 9216);
-    DecodeFrame(plane, 0, &it0[8], len0, use_all_hits);
-    DecodeFrame(plane, 1, &it1[8], len1, use_all_hits);
-    d2->AddPlane(plane);
-
-    bool advance_one_block_0 = false;
-    bool advance_one_block_1 = false;
-    if (it0 < data0.end() - (len0 + 4) * 4) {
-      advance_one_block_0 = true;
-    }
-    if (it1 < data1.end() - (len1 + 4) * 4) {
-      advance_one_block_1 = true;
+    plane.SetPivotPixel(decoder.PivotPixel());
+    for(uint32_t fm = 0; fm < 2; ++fm){
+      const Mimosa26Decoder::Frame &f = decoder.GetFrame(board, fm);
+      plane.PushPixels(f.n, f.x.data(), f.y.data(), decoder.Ones(), nullptr, fm, f.pivot.data());
     }
-
-    bool dbg = true;
-    if (advance_one_block_0 && advance_one_block_1) {
-      it0 = it0 + (len0 + 4) * 4;
-      if (it0 <= data0.end()){
-	header0 = eudaq::getlittleendian<uint32_t>(&(*(it0-4)));
-      }
-
-      it1 = it1 + (len1 + 4) * 4;
-      if (it1 <= data1.end()){
-	header1 = eudaq::getlittleendian<uint32_t>(&(*(it1-4)));
-      }
-    } else {
-      // EUDAQ_WARN("break the block");
-      break;
-    }
-    ++board;
+    d2->AddPlane(std::move(plane));
   }
   return true;
 }
-
-void NiRawEvent2StdEventConverter::DecodeFrame(eudaq::StandardPlane& plane, const uint32_t fm_n,
-                           const uint8_t *const d, const size_t l32, bool fix_pivot) const{
-  std::vector<uint16_t> vec;
-  for (size_t i = 0; i < l32; ++i) {
-    vec.push_back(eudaq::getlittleendian<uint16_t>(d+i*4));
-    vec.push_back(eudaq::getlittleendian<uint16_t>(d+i*4+2));
-  }
-
-  size_t lvec = vec.size();
-  for (size_t i = 0; i+1 < lvec; ++i) {
-    uint16_t numstates = vec[i] & 0x000f;
-    uint16_t row = vec[i] >> 4 & 0x7ff;
-    if (i+1+numstates > lvec){ //offset+ [row] + [column......]
-      break;
-    }
-    bool pivot = (fix_pivot ? 1-fm_n : (row >= (plane.PivotPixel() / 16)));
-    for (uint16_t s = 0; s < numstates; ++s) {
-      uint16_t v = vec.at(++i);
-      uint16_t column = v >> 2 & 0x7ff;
-      uint16_t num = v & 3;
-      for (uint16_t j = 0; j < num + 1; ++j) {
-        plane.PushPixel(column + j, row, 1,0, pivot, fm_n);
-      }
-    }
-  }
-
-}
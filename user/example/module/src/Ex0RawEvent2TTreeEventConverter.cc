@@ -5,6 +5,12 @@ class Ex0RawEvent2TTreeEventConverter: public eudaq::TTreeEventConverter{
 public:
   bool Converting(eudaq::EventSPC d1, eudaq::TTreeEventSP d2, eudaq::ConfigSPC conf) const override;
   static const uint32_t m_id_factory = eudaq::cstr2hash("Ex0Raw");
+private:
+  // the branch reads the fields in this order
+  mutable struct {
+    uint8_t x_pixel = 0;
+    uint8_t y_pixel = 0;
+  } m_block;
 };
 
 namespace{
@@ -29,10 +35,9 @@ bool Ex0RawEvent2TTreeEventConverter::Converting(eudaq::EventSPC d1, eudaq::TTre
     std::vector<uint8_t> hitxv;
     if(hit.size() != x_pixel*y_pixel)
       EUDAQ_THROW("Unknown data");
-    TString temp = "block"; 
-    if (d2->GetListOfBranches()->FindObject(temp))  d2->SetBranchAddress(temp,&x_pixel);
-    else
-      d2->Branch(temp,&x_pixel,"x_pixel/b:y_pixel/b");
+    BindBranch(d2.get(), "block", &m_block, "x_pixel/b:y_pixel/b");
+    m_block.x_pixel = x_pixel;
+    m_block.y_pixel = y_pixel;
   }
   return true;
 }
@@ -0,0 +1,421 @@
+#ifndef ITSRESYNCHRONISER_H
+#define ITSRESYNCHRONISER_H
+
+#include "eudaq/Event.hh"
+#include "eudaq/StandardEvent.hh"
+#include "eudaq/StdEventConverter.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+/* Resynchronisation of the ITkStrip test beam data.
+
+The ABCStar read-out (ITS_ABC_DUT, ITS_ABC_Timing) can slip against the
+trigger stream of the DAQ (ITS_TTC_*, telescope, TLU, reference plane). The
+BCID recorded by the ABCStar (tags DUT.RAWBCID, TIMING.RAWBCID) and by the
+TTC (TTC_DUT.BCID, TTC_TIMING.BCID) are compared event by event: runs of
+events with a constant 3-bit BCID difference are taken as in sync, and the
+ABCStar sub-events are re-paired with the DAQ sub-events accordingly.
+
+Everything works on streams: only a sliding window of BCIDs and events is
+kept and an event is written as soon as the block it belongs to is
+confirmed, so the memory does not grow with the length of the run.
+*/
+
+namespace ItsResync {
+
+  // BCID tag value of an event without the measurement
+  const uint32_t NO_BCID = 1000;
+
+  // Events evt1 ... evt1+length-1 of stream 1 pair with evt2 ... of stream 2
+  struct MatchBlock {
+    uint64_t evt1;
+    uint64_t evt2;
+    uint64_t length;
+  };
+
+  // Pairs the ABCStar BCIDs (stream 1) with the DAQ BCIDs (stream 2) of
+  // the same events. At each position the longest run starting within range
+  // events of either stream is taken, runs shorter than min_length are
+  // skipped. A search is only done once the window holds range/2 +
+  // max_length events beyond the position, so runs longer than max_length
+  // are confirmed in pieces.
+  class BcidMatcher {
+  public:
+    BcidMatcher(uint32_t range = 50, uint32_t min_length = 4, uint32_t max_length = 1024)
+      :m_range(range), m_min_length(min_length), m_max_length(max_length){
+      Reset();
+    }
+
+    void Reset(){
+      m_v1.clear();
+      m_v2.clear();
+      m_blocks.clear();
+      m_base = 0;
+      m_num1 = 0;
+      m_num2 = 0;
+      m_diff = 0;
+      m_phase = 0;
+      m_n_synced = 0;
+      m_n_in_sync = 0;
+      m_n_dropped1 = 0;
+      m_n_dropped2 = 0;
+      m_n_resync = 0;
+      m_n_phase = 0;
+      m_n_pushed = 0;
+    }
+
+    void Push(uint32_t bcid1, uint32_t bcid2){
+      if(m_n_pushed == 0)
+	m_phase = (bcid1 - bcid2) & 0x7;
+      m_v1.push_back(bcid1);
+      m_v2.push_back(bcid2);
+      m_n_pushed++;
+    }
+
+    // Confirms blocks as far as the buffered BCIDs allow, final at the end
+    // of the stream
+    void Process(bool final){
+      const uint64_t n = End();
+      while(m_num1 < n && m_num2 < n){
+	if(!final && std::max(m_num1, m_num2) + m_range / 2 + 1 + m_max_length > n)
+	  break;
+	MatchBlock best;
+	uint32_t diff = 0;
+	FindMax(best, diff);
+	if(best.length < m_min_length){
+	  m_num1++;
+	  m_num2++;
+	  continue;
+	}
+	if(int64_t(best.evt1) - int64_t(best.evt2) != m_diff){
+	  m_n_resync++;
+	  m_diff = int64_t(best.evt1) - int64_t(best.evt2);
+	}
+	if(diff != m_phase){
+	  m_phase = diff;
+	  m_n_phase++;
+	}
+	m_n_dropped1 += best.evt1 - m_num1;
+	m_n_dropped2 += best.evt2 - m_num2;
+	m_num1 = best.evt1 + best.length;
+	m_num2 = best.evt2 + best.length;
+	m_n_synced += best.length;
+	if(best.evt1 == best.evt2)
+	  m_n_in_sync += best.length;
+	m_blocks.push_back(best);
+      }
+      // the search only looks forward from the current positions
+      uint64_t low = std::min(m_num1, m_num2);
+      while(m_base < low && !m_v1.empty()){
+	m_v1.pop_front();
+	m_v2.pop_front();
+	m_base++;
+      }
+    }
+
+    // confirmed blocks, in order, to be consumed by the caller
+    std::deque<MatchBlock> &Blocks() {return m_blocks;}
+    uint64_t Position1() const {return m_num1;}
+    uint64_t Position2() const {return m_num2;}
+
+    uint64_t NumPushed() const {return m_n_pushed;}
+    uint64_t NumSynced() const {return m_n_synced;}
+    // synced events paired with themselves, i.e. never out of sync
+    uint64_t NumInSync() const {return m_n_in_sync;}
+    uint64_t NumDropped1() const {return m_n_dropped1;}
+    uint64_t NumDropped2() const {return m_n_dropped2;}
+    uint64_t NumResyncs() const {return m_n_resync;}
+    uint64_t NumPhaseChanges() const {return m_n_phase;}
+
+  private:
+    uint64_t End() const {return m_base + m_v1.size();}
+    uint32_t V1(uint64_t i) const {return m_v1[i - m_base];}
+    uint32_t V2(uint64_t i) const {return m_v2[i - m_base];}
+
+    // length of the run of constant BCID difference starting at o1/o2,
+    // the first pair is not checked for a missing BCID (see FindMax)
+    uint64_t Rle(uint64_t o1, uint64_t o2, uint32_t &diff) const {
+      const uint64_t n = End();
+      diff = (V1(o1) - V2(o2)) & 0x7;
+      uint64_t len = 1;
+      while(o1 + len < n && o2 + len < n && len < m_max_length){
+	uint32_t b1 = V1(o1 + len);
+	uint32_t b2 = V2(o2 + len);
+	if(b1 == NO_BCID || b2 == NO_BCID || ((b1 - b2) & 0x7) != diff)
+	  break;
+	len++;
+      }
+      return len;
+    }
+
+    // Longest run starting at a shift of up to range/2 events of either
+    // stream; a longer run behind the current best one is ignored. Only the
+    // shifted candidates skip a missing BCID, as the offline tool always did.
+    void FindMax(MatchBlock &best, uint32_t &diff) const {
+      const uint64_t n = End();
+      best.evt1 = m_num1;
+      best.evt2 = m_num2;
+      best.length = Rle(m_num1, m_num2, diff);
+      for(uint32_t count = 0; count <= m_range; count++){
+	uint64_t o1 = m_num1 + ((count % 2) ? 1 + count / 2 : 0);
+	uint64_t o2 = m_num2 + ((count % 2) ? 0 : 1 + count / 2);
+	if(o1 >= n || o2 >= n)
+	  continue;
+	if(V1(o1) == NO_BCID || V2(o2) == NO_BCID)
+	  continue;
+	uint32_t d = 0;
+	uint64_t len = Rle(o1, o2, d);
+	if(len > best.length &&
+	   (best.length < 2 || o1 < best.evt1 + best.length || o2 < best.evt2 + best.length)){
+	  best.evt1 = o1;
+	  best.evt2 = o2;
+	  best.length = len;
+	  diff = d;
+	}
+      }
+    }
+
+    uint32_t m_range;
+    uint32_t m_min_length;
+    uint32_t m_max_length;
+    std::deque<uint32_t> m_v1;
+    std::deque<uint32_t> m_v2;
+    uint64_t m_base;
+    std::deque<MatchBlock> m_blocks;
+    uint64_t m_num1;
+    uint64_t m_num2;
+    int64_t m_diff;
+    uint32_t m_phase;
+    uint64_t m_n_synced;
+    uint64_t m_n_in_sync;
+    uint64_t m_n_dropped1;
+    uint64_t m_n_dropped2;
+    uint64_t m_n_resync;
+    uint64_t m_n_phase;
+    uint64_t m_n_pushed;
+  };
+
+  // Builds the resynchronised events ("syncEvent") from a stream of events
+  // holding the sub-events of all devices. Events are indexed in the order
+  // they are pushed and handed to the sink in order of the DAQ event.
+  class Resynchroniser {
+  public:
+    enum Planes {BOTH, DUT, TIMING};
+    using Sink = std::function<void(eudaq::EventSP)>;
+
+    Resynchroniser(Planes planes, Sink sink, uint32_t range = 50)
+      :m_planes(planes), m_sink(sink), m_dut(range), m_timing(range){
+      Reset();
+    }
+
+    void Reset(){
+      m_dut.Reset();
+      m_timing.Reset();
+      m_events.clear();
+      m_base = 0;
+      m_n_lost = 0;
+      m_n_out = 0;
+    }
+
+    void Push(eudaq::EventSPC ev){
+      auto evstd = eudaq::StandardEvent::MakeShared();
+      // only the ITS sub-events carry the BCID tags
+      if(ev->IsFlagPacket()){
+	for(auto &subev: ev->GetSubEvents())
+	  if(subev->GetDescription().compare(0, 4, "ITS_") == 0)
+	    eudaq::StdEventConverter::Convert(subev, evstd, nullptr);
+      }
+      else
+	eudaq::StdEventConverter::Convert(ev, evstd, nullptr);
+      uint32_t dut = evstd->GetTag("DUT.RAWBCID", NO_BCID);
+      uint32_t dut_daq = evstd->GetTag("TTC_DUT.BCID", NO_BCID);
+      uint32_t timing = evstd->GetTag("TIMING.RAWBCID", NO_BCID);
+      uint32_t timing_daq = evstd->GetTag("TTC_TIMING.BCID", NO_BCID);
+      bool lost = false;
+      if(UseDut()){
+	m_dut.Push(dut, dut_daq);
+	lost |= (dut == NO_BCID || dut_daq == NO_BCID);
+      }
+      if(UseTiming()){
+	m_timing.Push(timing, timing_daq);
+	lost |= (timing == NO_BCID || timing_daq == NO_BCID);
+      }
+      m_n_lost += lost;
+      m_events.push_back(ev);
+      if(UseDut())
+	m_dut.Process(false);
+      if(UseTiming())
+	m_timing.Process(false);
+      Build();
+    }
+
+    // end of the stream, writes the remaining confirmed events
+    void Finish(){
+      if(UseDut())
+	m_dut.Process(true);
+      if(UseTiming())
+	m_timing.Process(true);
+      Build();
+      m_base += m_events.size();
+      m_events.clear();
+    }
+
+    uint64_t NumIn() const {return m_base + m_events.size();}
+    uint64_t NumOut() const {return m_n_out;}
+    uint64_t NumLost() const {return m_n_lost;}
+    const BcidMatcher &DutMatcher() const {return m_dut;}
+    const BcidMatcher &TimingMatcher() const {return m_timing;}
+
+    void Print(std::ostream &os) const {
+      const double n_in = NumIn() ? double(NumIn()) : 1.0;
+      if(UseDut())
+	PrintPlane(os, "DUT", m_dut);
+      if(UseTiming())
+	PrintPlane(os, "Timing", m_timing);
+      os << "Total events: " << NumIn() << " Number of lost events: " << m_n_lost
+	 << ", Efficiency: " << std::setprecision(9) << (NumIn() - m_n_lost) / n_in * 100.0
+	 << "%  -- Events written: " << m_n_out << " with efficiency: "
+	 << m_n_out / n_in * 100.0 << "%\n";
+    }
+
+  private:
+    bool UseDut() const {return m_planes != TIMING;}
+    bool UseTiming() const {return m_planes != DUT;}
+
+    static void PrintPlane(std::ostream &os, const std::string &name, const BcidMatcher &m){
+      const double n = m.NumPushed() ? double(m.NumPushed()) : 1.0;
+      os << name << ": " << m.NumSynced() << " events in sync, efficiency "
+	 << std::setprecision(9) << m.NumSynced() / n * 100.0
+	 << "% --- In sync to start with: " << m.NumInSync() << " evts, efficiency: "
+	 << m.NumInSync() / n * 100.0 << "% --- Resyncs: " << m.NumResyncs()
+	 << ", phase changes: " << m.NumPhaseChanges() << ", dropped: "
+	 << m.NumDropped1() << "/" << m.NumDropped2() << "\n";
+    }
+
+    static eudaq::EventSPC Find(const eudaq::EventSPC &ev, const std::string &dsp){
+      if(!ev)
+	return nullptr;
+      for(auto &subev: ev->GetSubEvents())
+	if(subev->GetDescription() == dsp)
+	  return subev;
+      return nullptr;
+    }
+
+    eudaq::EventSPC Get(uint64_t i) const {
+      if(i < m_base || i >= m_base + m_events.size())
+	return nullptr;
+      return m_events[i - m_base];
+    }
+
+    // DAQ event daq with the ABCStar sub-events of the events abc_dut and
+    // abc_timing
+    void Emit(uint64_t daq, uint64_t abc_dut, uint64_t abc_timing){
+      static const std::string dsp_abc_timing("ITS_ABC_Timing");
+      static const std::string dsp_abc_dut("ITS_ABC_DUT");
+      static const std::string dsp_ttc_timing("ITS_TTC_Timing");
+      static const std::string dsp_ttc_dut("ITS_TTC_DUT");
+      static const std::string dsp_tel("NiRawDataEvent");
+      static const std::string dsp_tlu("TluRawDataEvent");
+      static const std::string dsp_ref("USBPIXI4");
+
+      auto ev_daq = Get(daq);
+      std::vector<eudaq::EventSPC> subevs;
+      if(UseTiming()){
+	subevs.push_back(Find(Get(abc_timing), dsp_abc_timing));
+	subevs.push_back(Find(ev_daq, dsp_ttc_timing));
+      }
+      if(UseDut()){
+	subevs.push_back(Find(Get(abc_dut), dsp_abc_dut));
+	subevs.push_back(Find(ev_daq, dsp_ttc_dut));
+      }
+      subevs.push_back(Find(ev_daq, dsp_tel));
+      auto ev_tlu = Find(ev_daq, dsp_tlu);
+      subevs.push_back(ev_tlu);
+      subevs.push_back(Find(ev_daq, dsp_ref));
+      uint32_t trigger_n = ev_tlu ? ev_tlu->GetTriggerN() : (ev_daq ? ev_daq->GetTriggerN() : 0);
+
+      auto ev_sync = eudaq::Event::MakeShared("syncEvent");
+      ev_sync->SetFlagPacket();
+      for(auto &subev: subevs){
+	if(!subev)
+	  continue;
+	std::const_pointer_cast<eudaq::Event>(subev)->SetTriggerN(trigger_n);
+	ev_sync->AddSubEvent(subev);
+      }
+      ev_sync->SetTriggerN(trigger_n);
+      ev_sync->SetEventN(m_n_out);
+      m_n_out++;
+      if(m_sink)
+	m_sink(ev_sync);
+    }
+
+    void Build(){
+      auto &bd = m_dut.Blocks();
+      auto &bt = m_timing.Blocks();
+      if(m_planes == DUT || m_planes == TIMING){
+	auto &blocks = (m_planes == DUT) ? bd : bt;
+	for(auto &b: blocks)
+	  for(uint64_t k = 0; k < b.length; k++)
+	    Emit(b.evt2 + k, b.evt1 + k, b.evt1 + k);
+	blocks.clear();
+      }
+      else{
+	// DAQ events synced in both planes
+	while(!bd.empty() && !bt.empty()){
+	  const MatchBlock &p = bd.front();
+	  const MatchBlock &q = bt.front();
+	  uint64_t lo = std::max(p.evt2, q.evt2);
+	  uint64_t end_p = p.evt2 + p.length;
+	  uint64_t end_q = q.evt2 + q.length;
+	  uint64_t hi = std::min(end_p, end_q);
+	  for(uint64_t d = lo; d < hi; d++)
+	    Emit(d, p.evt1 + (d - p.evt2), q.evt1 + (d - q.evt2));
+	  if(end_p <= end_q)
+	    bd.pop_front();
+	  if(end_q <= end_p)
+	    bt.pop_front();
+	}
+	// blocks the other plane can no longer overlap with
+	while(!bd.empty() && bd.front().evt2 + bd.front().length <= m_timing.Position2())
+	  bd.pop_front();
+	while(!bt.empty() && bt.front().evt2 + bt.front().length <= m_dut.Position2())
+	  bt.pop_front();
+      }
+      // events still needed by a matcher or a pending block
+      uint64_t low = m_base + m_events.size();
+      if(UseDut())
+	low = std::min(low, Lowest(m_dut));
+      if(UseTiming())
+	low = std::min(low, Lowest(m_timing));
+      while(m_base < low && !m_events.empty()){
+	m_events.pop_front();
+	m_base++;
+      }
+    }
+
+    static uint64_t Lowest(BcidMatcher &m){
+      uint64_t low = std::min(m.Position1(), m.Position2());
+      if(!m.Blocks().empty())
+	low = std::min(low, std::min(m.Blocks().front().evt1, m.Blocks().front().evt2));
+      return low;
+    }
+
+    Planes m_planes;
+    Sink m_sink;
+    BcidMatcher m_dut;
+    BcidMatcher m_timing;
+    std::deque<eudaq::EventSPC> m_events;
+    uint64_t m_base;
+    uint64_t m_n_lost;
+    uint64_t m_n_out;
+  };
+
+}
+
+#endif // ITSRESYNCHRONISER_H
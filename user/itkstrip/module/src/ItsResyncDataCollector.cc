@@ -0,0 +1,118 @@
+#include "eudaq/DataCollector.hh"
+
+#include "ItsResynchroniser.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+// Online version of euCliReSynchroniser: the events of the producers are
+// built by event ID, the built events are resynchronised on the fly and
+// written as soon as their block is in sync.
+//
+// Configuration:
+//   ITS_RESYNC_PLANES = both | dut | timing   (default both)
+//   ITS_RESYNC_RANGE  = search range in events (default 50)
+class ItsResyncDataCollector:public eudaq::DataCollector{
+public:
+  using eudaq::DataCollector::DataCollector;
+  void DoConfigure() override;
+  void DoStartRun() override;
+  void DoStopRun() override;
+  void DoConnect(eudaq::ConnectionSPC id) override;
+  void DoDisconnect(eudaq::ConnectionSPC id) override;
+  void DoReceive(eudaq::ConnectionSPC id, eudaq::EventSP ev) override;
+  static const uint32_t m_id_factory = eudaq::cstr2hash("ItsResyncDataCollector");
+
+private:
+  std::map<std::string, std::deque<eudaq::EventSPC>> m_que_event;
+  std::unique_ptr<ItsResync::Resynchroniser> m_resync;
+  ItsResync::Resynchroniser::Planes m_planes = ItsResync::Resynchroniser::BOTH;
+  uint32_t m_range = 50;
+  std::mutex m_mtx_map;
+};
+
+namespace{
+  auto dummy0 = eudaq::Factory<eudaq::DataCollector>::
+    Register<ItsResyncDataCollector, const std::string&, const std::string&>
+    (ItsResyncDataCollector::m_id_factory);
+}
+
+void ItsResyncDataCollector::DoConfigure(){
+  auto conf = GetConfiguration();
+  if(conf){
+    std::string planes = conf->Get("ITS_RESYNC_PLANES", "both");
+    if(planes == "dut")
+      m_planes = ItsResync::Resynchroniser::DUT;
+    else if(planes == "timing")
+      m_planes = ItsResync::Resynchroniser::TIMING;
+    else
+      m_planes = ItsResync::Resynchroniser::BOTH;
+    m_range = conf->Get("ITS_RESYNC_RANGE", 50);
+  }
+}
+
+void ItsResyncDataCollector::DoStartRun(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  for(auto &que :m_que_event){
+    que.second.clear();
+  }
+  m_resync.reset(new ItsResync::Resynchroniser(m_planes, [this](eudaq::EventSP ev){
+	WriteEvent(ev);
+      }, m_range));
+}
+
+void ItsResyncDataCollector::DoStopRun(){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  if(!m_resync)
+    return;
+  m_resync->Finish();
+  std::ostringstream os;
+  m_resync->Print(os);
+  EUDAQ_INFO(os.str());
+}
+
+void ItsResyncDataCollector::DoConnect(eudaq::ConnectionSPC id){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  std::string pdc_name = id->GetName();
+  if(m_que_event.find(pdc_name) != m_que_event.end())
+    EUDAQ_THROW("DataCollector::Doconnect, multiple producers are sharing a same name");
+  m_que_event[pdc_name];
+}
+
+void ItsResyncDataCollector::DoDisconnect(eudaq::ConnectionSPC id){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  std::string pdc_name = id->GetName();
+  if(m_que_event.find(pdc_name) == m_que_event.end())
+    EUDAQ_THROW("DataCollector::DisDoconnect, the disconnecting producer was not existing in list");
+  EUDAQ_WARN("Producer."+pdc_name+" is disconnected, the remaining events are erased. ("+std::to_string(m_que_event[pdc_name].size())+ " Events)");
+  m_que_event.erase(pdc_name);
+}
+
+void ItsResyncDataCollector::DoReceive(eudaq::ConnectionSPC id, eudaq::EventSP ev){
+  std::unique_lock<std::mutex> lk(m_mtx_map);
+  std::string pdc_name = id->GetName();
+  m_que_event[pdc_name].push_back(std::move(ev));
+  for(auto &que :m_que_event){
+    if(que.second.empty())
+      return;
+  }
+  auto ev_wrap = eudaq::Event::MakeShared("EventIDSyncOnline");
+  ev_wrap->SetFlagPacket();
+  uint32_t ev_c = m_que_event.begin()->second.front()->GetEventN();
+  bool match = true;
+  for(auto &que :m_que_event){
+    if(ev_c != que.second.front()->GetEventN())
+      match = false;
+    ev_wrap->AddSubEvent(que.second.front());
+    que.second.pop_front();
+  }
+  if(!match){
+    EUDAQ_WARN("EventNumbers are Mismatched");
+  }
+  ev_wrap->SetEventN(ev_c);
+  if(m_resync)
+    m_resync->Push(ev_wrap);
+}
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <cstdint>
 
+#include "FEI4RecordDecoder.hh"
+
 namespace eudaq {
 
 template<typename T>
@@ -35,7 +37,10 @@ struct APIXPix {
 
 std::vector<int> getChannels(std::vector<unsigned char> const & data);
 std::vector<APIXPix> decodeFEI4DataGen2(std::vector<unsigned char> const & data);
-std::vector<APIXPix> decodeFEI4Data(std::vector<unsigned char> const & data);
+// Gen3 stream: the channel (front end) in the upper byte of the records, a
+// trigger word resets the data header count of all channels. The ToT of
+// the hits is code + 1, lv1 is clamped to 0..15.
+void decodeFEI4Data(const uint8_t *data, size_t size, FEI4Hits &hits);
 
 }
 
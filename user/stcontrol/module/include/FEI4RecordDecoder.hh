@@ -0,0 +1,117 @@
+#ifndef FEI4RECORDDECODER_HH
+#define FEI4RECORDDECODER_HH
+
+#include "ATLASFE4IInterpreter.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+inline uint32_t FEI4Little32(const uint8_t *p){
+  return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+// Hits of one FE-I4 record stream as columns. tot is the translated ToT
+// (code + 1), lv1 the number of data headers before the hit minus one and
+// channel the front end of a USBpix Gen3 stream. The columns only grow, so
+// they keep their capacity from one block to the next.
+struct FEI4Hits{
+  size_t n = 0;
+  std::vector<uint16_t> x;
+  std::vector<uint16_t> y;
+  std::vector<uint16_t> tot;
+  std::vector<uint32_t> lv1;
+  std::vector<uint8_t> channel;
+
+  void Reserve(size_t n_hits){
+    if(x.size() < n_hits){
+      x.resize(n_hits);
+      y.resize(n_hits);
+      tot.resize(n_hits);
+      lv1.resize(n_hits);
+      channel.resize(n_hits);
+    }
+  }
+};
+
+// Decoding kernel of the data blocks of the USBpix I4 and I4B producers:
+// 32 bit little endian FE-I4 records followed by two trigger words. The
+// masks of ATLASFEI4Interpreter and the orientation of the plane are
+// template parameters, so the record checks and the x/y swap are resolved
+// at compile time. Hits of a block are written into the preallocated
+// columns of Hits(), in the order of the records.
+template <uint dh_lv1id_msk, uint dh_bcid_msk, bool swap_xy>
+class FEI4RecordDecoder{
+public:
+  typedef ATLASFEI4Interpreter<dh_lv1id_msk, dh_bcid_msk> Interpreter;
+
+  static const uint32_t CHIP_MIN_COL = Interpreter::rd_min_col;
+  static const uint32_t CHIP_MAX_COL = Interpreter::rd_max_col;
+  static const uint32_t CHIP_MIN_ROW = Interpreter::rd_min_row;
+  static const uint32_t CHIP_MAX_ROW = Interpreter::rd_max_row;
+  static const uint32_t WIDTH = swap_xy ? CHIP_MAX_ROW - CHIP_MIN_ROW + 1 : CHIP_MAX_COL - CHIP_MIN_COL + 1;
+  static const uint32_t HEIGHT = swap_xy ? CHIP_MAX_COL - CHIP_MIN_COL + 1 : CHIP_MAX_ROW - CHIP_MIN_ROW + 1;
+
+  // Decode the records of a block, the trailing trigger words excluded.
+  // Returns the number of data headers, 16 for a complete event.
+  size_t Decode(const uint8_t *d, size_t size){
+    m_hits.n = 0;
+    m_dh = 0;
+    if(size <= 8)
+      return 0;
+    size_t n_rec = (size - 8 + 3) / 4;
+    // a data record holds at most two hits
+    m_hits.Reserve(2 * n_rec);
+    uint16_t *x = m_hits.x.data();
+    uint16_t *y = m_hits.y.data();
+    uint16_t *tot = m_hits.tot.data();
+    uint32_t *lv1 = m_hits.lv1.data();
+    size_t n = 0;
+    uint32_t lvl1 = 0;
+    for(size_t i = 0; i < n_rec; ++i){
+      uint32_t w = FEI4Little32(d + 4 * i);
+      if(m_intp.is_dh(w)){
+	++lvl1;
+	continue;
+      }
+      if(!m_intp.is_dr(w))
+	continue;
+      // is_dr guarantees the column and the first row to be on the chip
+      uint16_t col = m_intp.get_dr_col1(w) - CHIP_MIN_COL;
+      uint16_t row = m_intp.get_dr_row1(w) - CHIP_MIN_ROW;
+      // ToT codes 14 and 15 are no hit
+      uint32_t tot1 = m_intp.get_dr_tot1(w);
+      if(tot1 < 14){
+	x[n] = swap_xy ? row : col;
+	y[n] = swap_xy ? col : row;
+	tot[n] = tot1 + 1;
+	lv1[n++] = lvl1 - 1;
+      }
+      uint32_t tot2 = m_intp.get_dr_tot2(w);
+      if(tot2 < 14){
+	if(row + 1u > CHIP_MAX_ROW - CHIP_MIN_ROW){
+	  std::cout << "Invalid row: " << row + 1 + CHIP_MIN_ROW << std::endl;
+	  continue;
+	}
+	x[n] = swap_xy ? row + 1 : col;
+	y[n] = swap_xy ? col : row + 1;
+	tot[n] = tot2 + 1;
+	lv1[n++] = lvl1 - 1;
+      }
+    }
+    m_hits.n = n;
+    m_dh = lvl1;
+    return m_dh;
+  }
+
+  const FEI4Hits &Hits() const {return m_hits;}
+  size_t DataHeaders() const {return m_dh;}
+
+private:
+  Interpreter m_intp;
+  FEI4Hits m_hits;
+  size_t m_dh = 0;
+};
+
+#endif // FEI4RECORDDECODER_HH
@@ -89,75 +89,65 @@ std::vector<APIXPix> decodeFEI4DataGen2(std::vector<unsigned char> const & data)
 	return result;
 }
 
-std::vector<APIXPix> decodeFEI4Data(std::vector<unsigned char> const & data) {
-	std::vector<APIXPix> result;
+void decodeFEI4Data(const uint8_t *data, size_t size, FEI4Hits &hits) {
+	size_t n_rec = size / 4;
+	// a data record holds at most two hits
+	hits.Reserve(2 * n_rec);
+	hits.n = 0;
 	std::array<size_t,8> no_data_headers;
+	no_data_headers.fill(0);
 
-	for(size_t index = 0;  index < data.size(); index+=4) {
-        uint32_t i =( static_cast<uint32_t>(data[index+3]) << 24 ) | 
-                	( static_cast<uint32_t>(data[index+2]) << 16 ) | 
-					( static_cast<uint32_t>(data[index+1]) << 8 ) | 
-					( static_cast<uint32_t>(data[index+0]) );
+	for(size_t index = 0;  index < n_rec; ++index) {
+		uint32_t i = FEI4Little32(data + 4 * index);
 
 		uint8_t channel = selectBits(i, 24, 8);
 
 		if(channel >> 7) { //Trigger
-			
 			no_data_headers.fill(0);
-			uint32_t trigger_number = selectBits(i, 0, 31); //testme
+			continue;
+		}
+		uint8_t type = selectBits(i, 16, 8);
+		if(type == data_header) {
+			no_data_headers.at(channel)++;
+			continue;
+		}
+		if(type == address_record || type == value_record || type == service_record) {
+			continue;
+		}
+		//data record
+		unsigned tot2 = selectBits(i, 0, 4);
+		unsigned tot1 = selectBits(i, 4, 4);
+		unsigned row = selectBits(i, 8, 9) - 1;
+		unsigned column = selectBits(i, 17, 7) - 1;
+
+		if(!(column < 80 && ((tot2 == 0xF && row < 336) || (tot2 < 0xF && row < 335)))) {
+			continue; // invalid data record
+		}
+		unsigned int lv1;
+		if(channel < no_data_headers.size()) {
+			lv1 = static_cast<unsigned>(no_data_headers[channel]-1);
 		} else {
-			uint8_t type = selectBits(i, 16, 8);
-			switch(type) {
-				case data_header: {
-					//int bcid = selectBits(i, 0, 10);
-					//int lv1id = selectBits(i, 10, 5);
-					//int flag = selectBits(i, 15, 1);
-					no_data_headers.at(channel)++;
-					break;
-				}
-				case address_record: {
-					//int type = selectBits(i, 15, 1);
-					//int address = selectBits(i, 0, 15);
-					break;
-				}
-				case value_record: {
-					//int value = selectBits(i, 0, 16);
-					break;
-				}
-				case service_record: {
-					//int code = selectBits(i, 10, 6);
-					//int count = selectBits(i, 0, 10);
-					break;
-				}
-				default: { //data record
-
-					unsigned tot2 = selectBits(i, 0, 4);
-					unsigned tot1 = selectBits(i, 4, 4);
-					unsigned row = selectBits(i, 8, 9) - 1;
-					unsigned column = selectBits(i, 17, 7) - 1;
-
-					if(column < 80 && ((tot2 == 0xF && row < 336) || (tot2 < 0xF && row < 335) )) {
-						//If tot2 != 0b1111 (0xF) then the tot2 is the tot code for pixel (col, row+1)
-			unsigned int lv1;
-			try {
-				lv1 = static_cast<unsigned>(no_data_headers.at(channel)-1);
-			} catch (...) {
-				std::cout << "Exception thrown in FEI4 converter: out of range" << std::endl;
-				std::cout << "channel= " << channel << std::endl;
-				lv1 = static_cast<unsigned>(16);
-			};
-                        if(lv1 > 15) lv1 = 15;
-						if( tot2 != 0xF) result.emplace_back(column, row+1, tot2, lv1, channel);
-						result.emplace_back(column, row, tot1, lv1, channel);
-					} else { // invalid data record
-						//invalid_dr ++;
-					}
-					break;
-				}
-			}
+			std::cout << "Exception thrown in FEI4 converter: out of range" << std::endl;
+			std::cout << "channel= " << channel << std::endl;
+			lv1 = static_cast<unsigned>(16);
 		}
+		if(lv1 > 15) lv1 = 15;
+		//If tot2 != 0b1111 (0xF) then the tot2 is the tot code for pixel (col, row+1)
+		size_t n = hits.n;
+		if(tot2 != 0xF) {
+			hits.x[n] = column;
+			hits.y[n] = row + 1;
+			hits.tot[n] = tot2 + 1;
+			hits.lv1[n] = lv1;
+			hits.channel[n++] = channel;
+		}
+		hits.x[n] = column;
+		hits.y[n] = row;
+		hits.tot[n] = tot1 + 1;
+		hits.lv1[n] = lv1;
+		hits.channel[n++] = channel;
+		hits.n = n;
 	}
-	return result;
 }
 
 
@@ -48,7 +48,9 @@ Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSP
    //}
 
    //In the Gen3 producer we will only have one data block, always!
-   auto pixelVec = eudaq::decodeFEI4Data(evRaw->GetBlock(0));
+   const std::vector<uint8_t> &block = evRaw->GetBlock(0);
+   thread_local FEI4Hits hits;
+   eudaq::decodeFEI4Data(block.data(), block.size(), hits);
    int boardID = evRaw->GetTag("board", -999);
    auto triggerID = GetTriggerID(*evRaw);
    //std::cout << "TriggerID board " << boardID << " : " << triggerID << std::endl;
@@ -65,7 +67,7 @@ Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSP
    //getChannels will determine all the channels from a board, making the assumption that every channel (i.e. FrontEnd)
    //wrote date into the data block. This holds true if the FE is responding. Then for every trigger there will be
    //data headers (DHs) in the data stream
-      boardChannels.at(boardID) = eudaq::getChannels(evRaw->GetBlock(0));
+      boardChannels.at(boardID) = eudaq::getChannels(block);
       if(!boardChannels.at(boardID).empty()) boardInitialized.at(boardID) = true;
    }
 
@@ -77,14 +79,16 @@ Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSP
 	StandardPlaneMap.insert(pair);
     }
 
-    int hitDiscConf = 0;
-
-    for(auto& hitPixel: pixelVec) {
-	StandardPlaneMap[hitPixel.channel].PushPixelHelper(hitPixel.x, hitPixel.y, hitPixel.tot+1+hitDiscConf, 0, false, hitPixel.lv1);
+    //hits of the same channel and lv1 come in runs, each one is pushed as a span
+    for(size_t i = 0; i < hits.n;) {
+	size_t j = i + 1;
+	while(j < hits.n && hits.channel[j] == hits.channel[i] && hits.lv1[j] == hits.lv1[i]) j++;
+	StandardPlaneMap[hits.channel[i]].PushPixels(j - i, &hits.x[i], &hits.y[i], &hits.tot[i], nullptr, hits.lv1[i]);
+	i = j;
     }
 
     for(auto& planePair: StandardPlaneMap) {
-	d2->AddPlane(planePair.second);
+	d2->AddPlane(std::move(planePair.second));
     }  
     
   return true;
@@ -93,15 +97,16 @@ Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSP
 unsigned UsbpixGen3NameRawEvent2StdEventConverter::GetTriggerID(const eudaq::Event & ev) const {
 	//The trigger id is always the first 4 words in each event's data block
 	//we only need the first 24 bit though! (the most significant 8 will be zeroes)
-	auto evRaw = dynamic_cast<eudaq::RawEvent const &>(ev);
-        std::vector<unsigned char> data;
+	auto &evRaw = dynamic_cast<eudaq::RawEvent const &>(ev);
+	const std::vector<unsigned char> *block;
 	try {
-		data = evRaw.GetBlock(0);
+		block = &evRaw.GetBlock(0);
 	}
 	catch(std::out_of_range) {
 		std::cout << "Block with trigger ID missing for USBpix board" << std::endl;
 		return 0;
 	}
+	const std::vector<unsigned char> &data = *block;
         uint32_t i =( static_cast<uint32_t>(data[2]) << 16 ) |
                     ( static_cast<uint32_t>(data[1]) << 8 ) |
                     ( static_cast<uint32_t>(data[0]) );
@@ -0,0 +1,242 @@
+#ifndef TIMEPIX3DECODER_HH
+#define TIMEPIX3DECODER_HH
+
+#include "eudaq/CalibrationStore.hh"
+#include "eudaq/Logger.hh"
+#include "eudaq/StdEventConverter.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace eudaq {
+
+  // Decoder of the 64-bit SPIDR words of a Timepix3 packet. The heartbeat
+  // time and the T0 state are kept from one packet to the next. Words are
+  // read in place from the block; the pixel words of a packet are counted
+  // from their 3 leading bits first, so that the hit buffers are reserved
+  // once and keep their capacity. The ToT/ToA calibration is held as one
+  // flat 256x256 array per parameter and applied to all hits of a packet
+  // in a separate loop over contiguous arrays.
+  class Timepix3Decoder {
+  public:
+    static const uint32_t SIZE = 256;
+
+    // microseconds the heartbeat may jump back before a second T0 is assumed
+    void SetDeltaT0(uint64_t delta_t0){m_delta_t0 = delta_t0;}
+
+    // columns a, b, c, t of the ToT table and c, t, d of the ToA table
+    // (see the README), one row per pixel at 256 * row + col
+    void SetCalibration(const CalibrationTable &tot, const CalibrationTable &toa){
+      if(tot.Rows() != SIZE * SIZE || toa.Rows() != SIZE * SIZE || tot.Columns() < 6 || toa.Columns() < 5)
+	throw DataInvalid("Timepix3: calibration tables need 256x256 rows of at least 6 (ToT) and 5 (ToA) columns.");
+      for(auto *v : {&m_cal_a, &m_cal_b, &m_cal_c, &m_cal_t, &m_cal_toa_c, &m_cal_toa_t, &m_cal_toa_d})
+	v->resize(SIZE * SIZE);
+      for(uint32_t i = 0; i < SIZE * SIZE; i++){
+	const float *p = tot.Row(i);
+	m_cal_a[i] = p[2];
+	m_cal_b[i] = p[3];
+	m_cal_c[i] = p[4];
+	m_cal_t[i] = p[5];
+	const float *q = toa.Row(i);
+	m_cal_toa_c[i] = q[2];
+	m_cal_toa_t[i] = q[3];
+	m_cal_toa_d[i] = q[4];
+      }
+    }
+    bool Calibrated() const {return !m_cal_a.empty();}
+
+    // Decodes the n bytes of a packet, throws DataInvalid on a second T0
+    void Decode(const uint8_t *data, size_t n){
+      const size_t nword = n / sizeof(uint64_t);
+      // pixel data has header 0xA or 0xB
+      size_t npix = 0;
+      for(size_t i = 0; i < nword; i++)
+	npix += (Word(data, i) >> 61) == 0x5;
+      for(auto *v : {&m_col, &m_row, &m_tot})
+	v->clear();
+      m_time.clear();
+      m_charge.clear();
+      m_col.reserve(npix);
+      m_row.reserve(npix);
+      m_tot.reserve(npix);
+      m_time.reserve(npix);
+
+      for(size_t i = 0; i < nword; i++){
+	const uint64_t pixdata = Word(data, i);
+	const uint8_t header = pixdata >> 60;
+	// Use header 0x4 to get the long timestamps (syncTime)
+	if(header == 0x4)
+	  Heartbeat(pixdata);
+	// Sometimes there is still data left in the buffers at the start of a run. For that reason we keep skipping data until
+	// this "header" data has been cleared, when the heart beat signal starts from a low number (~few seconds max).
+	if(!m_clearedHeader || (header != 0xA && header != 0xB))
+	  continue;
+
+	// Decode the pixel information from the relevant bits
+	const uint16_t dcol = static_cast<uint16_t>((pixdata & 0x0FE0000000000000) >> 52);
+	const uint16_t spix = static_cast<uint16_t>((pixdata & 0x001F800000000000) >> 45);
+	const uint16_t pix = static_cast<uint16_t>((pixdata & 0x0000700000000000) >> 44);
+	const uint16_t col = static_cast<uint16_t>(dcol + pix / 4);
+	const uint16_t row = static_cast<uint16_t>(spix + (pix & 0x3));
+
+	// Get the rest of the data from the pixel
+	const uint32_t pdata = static_cast<uint32_t>((pixdata & 0x00000FFFFFFF0000) >> 16);
+	const uint32_t tot = (pdata & 0x00003FF0) >> 4;
+	const uint64_t spidrTime(pixdata & 0x000000000000FFFF);
+	const uint64_t ftoa(pdata & 0x0000000F);
+	const uint64_t toa((pdata & 0x0FFFC000) >> 14);
+
+	// Calculate the timestamp.
+	uint64_t time = (((spidrTime << 18) + (toa << 4) + (15 - ftoa)) << 8) + (m_syncTime & 0xFFFFFC0000000000);
+
+	// Adjusting phases for double column shift
+	time += ((static_cast<uint64_t>(col) / 2 - 1) % 16) * 256;
+
+	// The time from the pixels has a maximum value of ~26 seconds. We compare the pixel time to the "heartbeat"
+	// signal (which has an overflow of ~4 years) and check if the pixel time has wrapped back around to 0
+	while(static_cast<long long>(m_syncTime) - static_cast<long long>(time) > 0x0000020000000000) {
+	  time += 0x0000040000000000;
+	}
+
+	m_col.push_back(col);
+	m_row.push_back(row);
+	m_tot.push_back(tot);
+	// Convert final timestamp into picoseconds
+	m_time.push_back(time * 1000 / 4096 * 25);
+      }
+
+      // best guess for charge is ToT if no calibration is available
+      m_charge.resize(m_tot.size());
+      if(Calibrated())
+	Calibrate();
+      else
+	for(size_t i = 0; i < m_tot.size(); i++)
+	  m_charge[i] = static_cast<float>(m_tot[i]);
+
+      m_begin = std::numeric_limits<uint64_t>::max();
+      m_end = std::numeric_limits<uint64_t>::lowest();
+      for(uint64_t t : m_time){
+	m_begin = t < m_begin ? t : m_begin;
+	m_end = t > m_end ? t : m_end;
+      }
+    }
+
+    size_t NumHits() const {return m_col.size();}
+    const std::vector<uint16_t> &Col() const {return m_col;}
+    const std::vector<uint16_t> &Row() const {return m_row;}
+    const std::vector<double> &Charge() const {return m_charge;}
+    // picoseconds, timewalk corrected when calibrated
+    const std::vector<uint64_t> &Time() const {return m_time;}
+    // first and last pixel timestamp of the packet
+    uint64_t Begin() const {return m_begin;}
+    uint64_t End() const {return m_end;}
+
+  private:
+    static uint64_t Word(const uint8_t *data, size_t i){
+      uint64_t w;
+      std::memcpy(&w, data + i * sizeof(uint64_t), sizeof(w));
+      return w;
+    }
+
+    void Heartbeat(uint64_t pixdata){
+      // The 0x4 header tells us that it is part of the timestamp, there is a second 4-bit header that says if it is the most
+      // or least significant part of the timestamp
+      const uint8_t header2 = ((pixdata & 0x0F00000000000000) >> 56) & 0xF;
+
+      // This is a bug fix. There appear to be errant packets with garbage data - source to be tracked down.
+      // Between the data and the header the intervening bits should all be 0, check if this is the case
+      const uint8_t intermediateBits = ((pixdata & 0x00FF000000000000) >> 48) & 0xFF;
+      if(intermediateBits != 0x00)
+	return;
+
+      // 0x4 is the least significant part of the timestamp
+      if(header2 == 0x4) {
+	// The data is shifted 16 bits to the right, then 12 to the left in order to match the timestamp format (net 4 right)
+	m_syncTime = (m_syncTime & 0xFFFFF00000000000) + ((pixdata & 0x0000FFFFFFFF0000) >> 4);
+      }
+      // 0x5 is the most significant part of the timestamp
+      if(header2 == 0x5) {
+	// The data is shifted 16 bits to the right, then 44 to the left in order to match the timestamp format (net 28 left)
+	m_syncTime = (m_syncTime & 0x00000FFFFFFFFFFF) + ((pixdata & 0x00000000FFFF0000) << 28);
+
+	if(!m_clearedHeader && (m_syncTime / 4096 / 40) < 6000000) { // < 6sec
+	  EUDAQ_INFO("Timepix3: Detected T0 signal. Header cleared.");
+	  m_clearedHeader = true;
+
+	// From SPS data we know that even though pixel timestamps are not perfectly chronological, they are not more
+	// than "mixed up by -20us". At DESY, this is hardly (ever?) the case due to the lower occupancies.
+	// Hence, if the current timestamp is more than 20us earlier than the previous timestamp, we can assume that
+	// a 2nd T0 has occured. With some safety margin, set delta_t0 = 1e6 (1s, default).
+	// This implies we cannot detect a 2nd T0 within the first "delta_t0" microseconds after the initial T0.
+	} else if ((m_syncTime + m_delta_t0 * 4096 * 40) < m_syncTime_prev) { // delta_t0 on left side to avoid neg. difference between uint64_t
+	  throw DataInvalid("Timepix3: Detected second T0 signal. Time jumps back by " + std::to_string((m_syncTime_prev - m_syncTime) / 4096 / 40) + "us.");
+	}
+	EUDAQ_DEBUG("ST = " + std::to_string(m_syncTime) + " STPrev = " + std::to_string(m_syncTime_prev) + " " + std::to_string(m_syncTime < m_syncTime_prev));
+
+	m_syncTime_prev = m_syncTime;
+      }
+    }
+
+    // ToT to charge and timewalk correction (copied over from Corryvreckan
+    // EventLoaderTimepix3). The parameters of the hit pixels are gathered
+    // first, the conversion then runs over contiguous arrays.
+    void Calibrate(){
+      const size_t nhit = m_tot.size();
+      for(auto *v : {&m_a, &m_b, &m_c, &m_t, &m_toa_c, &m_toa_t, &m_toa_d})
+	v->resize(nhit);
+      for(size_t i = 0; i < nhit; i++){
+	const uint32_t pixel = SIZE * m_row[i] + m_col[i];
+	m_a[i] = m_cal_a[pixel];
+	m_b[i] = m_cal_b[pixel];
+	m_c[i] = m_cal_c[pixel];
+	m_t[i] = m_cal_t[pixel];
+	m_toa_c[i] = m_cal_toa_c[pixel];
+	m_toa_t[i] = m_cal_toa_t[pixel];
+	m_toa_d[i] = m_cal_toa_d[pixel];
+      }
+      for(size_t i = 0; i < nhit; i++){
+	const float a = m_a[i], b = m_b[i], c = m_c[i], t = m_t[i];
+	const uint32_t tot = m_tot[i];
+	const float ftot = static_cast<float>(tot);
+	/* Note 1: fvolts is the inverse to f(x) = a*x + b - c/(x-t). Note the +/- signs! */
+	const float fvolts = (std::sqrt(static_cast<double>(a * a * t * t + 2 * a * b * t + 4 * a * c - 2 * a * t * ftot +
+							   b * b - 2 * b * ftot + static_cast<float>(tot * tot))) +
+			      a * t - b + ftot) /
+	  (2 * a);
+	/* Note 2: The capacitance is actually smaller than 3 fC, more like 2.5 fC. But there is an offset when when
+	 * using testpulses. Multiplying the voltage value with 20 [e-/mV] is a good approximation but means one is
+	 * over estimating the input capacitance to compensate the missing information of the offset. */
+	m_charge[i] = fvolts * 1e-3 * 3e-15 * 6241.509 * 1e15; // capacitance is 3 fF or 18.7 e-/mV
+	const uint64_t t_shift = (m_toa_c[i] / (fvolts - m_toa_t[i]) + m_toa_d[i]) * 1000; // convert to ps
+	m_time[i] -= t_shift; // apply correction
+      }
+    }
+
+    uint64_t m_syncTime = 0;
+    uint64_t m_syncTime_prev = 0;
+    uint64_t m_delta_t0 = 1e6;
+    bool m_clearedHeader = false;
+    uint64_t m_begin = 0;
+    uint64_t m_end = 0;
+
+    std::vector<uint16_t> m_col;
+    std::vector<uint16_t> m_row;
+    std::vector<uint16_t> m_tot;
+    std::vector<uint64_t> m_time;
+    std::vector<double> m_charge;
+
+    // per pixel calibration, index 256 * row + col
+    std::vector<float> m_cal_a, m_cal_b, m_cal_c, m_cal_t;
+    std::vector<float> m_cal_toa_c, m_cal_toa_t, m_cal_toa_d;
+    // calibration of the hits of the current packet
+    std::vector<float> m_a, m_b, m_c, m_t;
+    std::vector<float> m_toa_c, m_toa_t, m_toa_d;
+  };
+
+} // namespace eudaq
+
+#endif // TIMEPIX3DECODER_HH
@@ -1,6 +1,8 @@
 #include "eudaq/StdEventConverter.hh"
 #include "eudaq/RawEvent.hh"
 #include "eudaq/Logger.hh"
+#include "eudaq/CalibrationStore.hh"
+#include "Timepix3Decoder.hh"
 
 /**
 * Timepix3 event converter, converting from raw detector data to EUDAQ StandardEvent format
@@ -12,15 +14,10 @@ namespace eudaq {
     bool Converting(eudaq::EventSPC d1, eudaq::StandardEventSP d2, eudaq::ConfigurationSPC conf) const override;
     static const uint32_t m_id_factory = eudaq::cstr2hash("Timepix3RawEvent");
   private:
-    static uint64_t m_syncTime;
-    static uint64_t m_syncTime_prev;
-    static uint64_t m_delta_t0;
-    static bool m_clearedHeader;
     static bool m_first_time;
-    static std::vector<std::vector<float>> vtot;
-    static std::vector<std::vector<float>> vtoa;
+    static Timepix3Decoder m_decoder;
 
-    void loadCalibration(std::string path, char delim, std::vector<std::vector<float>>& dat) const;
+    static CalibrationTable loadCalibration(const std::string &path, char delim);
   };
 
   class Timepix3TrigEvent2StdEventConverter: public eudaq::StdEventConverter{